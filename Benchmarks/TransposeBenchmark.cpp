@@ -0,0 +1,226 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+/*
+    Microbenchmark of the SequentialBlockFile transpose/convert path
+
+    Scales and interleaves 4096-sample blocks of float data into int16 file blocks,
+    once with the tiled writeChannels() and once with one writeChannel() call per
+    channel, at 32, 384 and 1536 channels (or at the channel counts given on the
+    command line). Blocks are handed to an in-memory BlockWriter that recycles them,
+    so no disk I/O is measured. The input data is generated from a fixed seed and
+    scaled like BinaryRecording does. Before timing, both paths must produce the
+    same bytes; the benchmark fails otherwise.
+
+    Build with -DOE_BUILD_BENCHMARKS=ON, then run:
+        transpose-benchmark [numChannels ...]
+ */
+
+#include "../Source/Processors/RecordNode/BinaryFormat/SequentialBlockFile.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    const int samplesPerBlock = 4096;
+    const int numRuns = 7;
+    const int64 channelSamplesPerRun = 1536 * samplesPerBlock * 8;
+    const float bitVolts = 0.195f;
+
+    /* Writes used to compare the two paths; they don't line up with the blocks */
+    const int verifyWriteSamples = 3000;
+    const int numVerifyWrites = 5;
+
+    /** Zeroes and recycles blocks instead of writing them, optionally copying them to a stream first */
+    class NullBlockWriter : public BlockWriter
+    {
+    public:
+        NullBlockWriter(size_t blockBytes_) : blockBytes(blockBytes_) { }
+
+        ~NullBlockWriter()
+        {
+            for (auto* block : freeBlocks)
+                free(block);
+        }
+
+        void* allocateBlock() override
+        {
+            if (freeBlocks.empty())
+                return calloc(1, blockBytes);
+
+            void* block = freeBlocks.back();
+            freeBlocks.pop_back();
+            memset(block, 0, blockBytes);
+            return block;
+        }
+
+        void writeBlock(void* block, size_t numBytes) override
+        {
+            if (capture != nullptr)
+                capture->write(block, numBytes);
+
+            bytesWritten += numBytes;
+            freeBlocks.push_back(block);
+        }
+
+        size_t bytesWritten = 0;
+        OutputStream* capture = nullptr;
+
+    private:
+        const size_t blockBytes;
+        std::vector<void*> freeBlocks;
+    };
+
+    /** Returns the median throughput in channel-samples per second */
+    template <typename WriteFunction>
+    double measure(int numChannels, WriteFunction&& write)
+    {
+        const int numBlocks = (int) jmax((int64) 2, channelSamplesPerRun / ((int64) numChannels * samplesPerBlock));
+        std::vector<double> rates;
+
+        for (int run = 0; run <= numRuns; run++)
+        {
+            auto writer = std::make_shared<NullBlockWriter>((size_t) numChannels * samplesPerBlock * sizeof(int16));
+
+            {
+                SequentialBlockFile file(numChannels, samplesPerBlock);
+
+                if (!file.openFile(writer))
+                    return 0.0;
+
+                const int64 start = Time::getHighResolutionTicks();
+
+                for (int block = 0; block < numBlocks; block++)
+                    write(file, (uint64) block * samplesPerBlock);
+
+                const double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+
+                // the first run only warms up the caches and the block pool
+                if (run > 0)
+                    rates.push_back((double) numChannels * samplesPerBlock * numBlocks / seconds);
+            }
+
+            jassert(writer->bytesWritten == (size_t) numChannels * samplesPerBlock * numBlocks * sizeof(int16));
+        }
+
+        std::sort(rates.begin(), rates.end());
+        return rates[rates.size() / 2];
+    }
+
+    /** Returns true if writeChannel() and writeChannels() produce the same file from the same data */
+    bool outputsMatch(int numChannels, const float* const* data, const float* scales)
+    {
+        MemoryBlock outputs[2];
+
+        for (int tiled = 0; tiled < 2; tiled++)
+        {
+            MemoryOutputStream stream(outputs[tiled], false);
+            auto writer = std::make_shared<NullBlockWriter>((size_t) numChannels * samplesPerBlock * sizeof(int16));
+            writer->capture = &stream;
+
+            SequentialBlockFile file(numChannels, samplesPerBlock);
+
+            if (!file.openFile(writer))
+                return false;
+
+            for (int write = 0; write < numVerifyWrites; write++)
+            {
+                const uint64 startPos = (uint64) write * verifyWriteSamples;
+
+                if (tiled)
+                {
+                    file.writeChannels(startPos, data, scales, verifyWriteSamples);
+                }
+                else
+                {
+                    for (int ch = 0; ch < numChannels; ch++)
+                        file.writeChannel(startPos, ch, data[ch], scales[ch], verifyWriteSamples);
+                }
+            }
+        }
+
+        const size_t expectedBytes = (size_t) numChannels * verifyWriteSamples * numVerifyWrites * sizeof(int16);
+
+        return outputs[0].getSize() == expectedBytes
+            && outputs[1].getSize() == expectedBytes
+            && memcmp(outputs[0].getData(), outputs[1].getData(), expectedBytes) == 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Array<int> channelCounts;
+
+    for (int i = 1; i < argc; i++)
+        if (int n = String(argv[i]).getIntValue(); n > 0)
+            channelCounts.add(n);
+
+    if (channelCounts.isEmpty())
+        channelCounts.addArray({ 32, 384, 1536 });
+
+    std::cout << "Samples per block: " << samplesPerBlock << ", median of " << numRuns << " runs" << std::endl;
+    std::cout << String("channels").paddedLeft(' ', 10)
+              << String("per-channel (MS/s)").paddedLeft(' ', 22)
+              << String("tiled (MS/s)").paddedLeft(' ', 16)
+              << String("speedup").paddedLeft(' ', 10) << std::endl;
+
+    for (int numChannels : channelCounts)
+    {
+        Random random(numChannels);
+        HeapBlock<float> samples((size_t) numChannels * samplesPerBlock);
+        std::vector<const float*> data;
+        std::vector<float> scales(numChannels, 1.0f / (float(0x7fff) * bitVolts));
+
+        for (int i = 0; i < numChannels * samplesPerBlock; i++)
+            samples[i] = (random.nextFloat() * 2.0f - 1.0f) * 5000.0f;
+
+        for (int ch = 0; ch < numChannels; ch++)
+            data.push_back(samples + ch * samplesPerBlock);
+
+        if (!outputsMatch(numChannels, data.data(), scales.data()))
+        {
+            std::cout << "ERROR: writeChannel() and writeChannels() wrote different data for "
+                      << numChannels << " channels" << std::endl;
+            return 1;
+        }
+
+        const double perChannel = measure(numChannels, [&](SequentialBlockFile& file, uint64 startPos)
+        {
+            for (int ch = 0; ch < numChannels; ch++)
+                file.writeChannel(startPos, ch, data[ch], scales[ch], samplesPerBlock);
+        });
+
+        const double tiled = measure(numChannels, [&](SequentialBlockFile& file, uint64 startPos)
+        {
+            file.writeChannels(startPos, data.data(), scales.data(), samplesPerBlock);
+        });
+
+        std::cout << String(numChannels).paddedLeft(' ', 10)
+                  << String(perChannel / 1e6, 1).paddedLeft(' ', 22)
+                  << String(tiled / 1e6, 1).paddedLeft(' ', 16)
+                  << (String(perChannel > 0.0 ? tiled / perChannel : 0.0, 2) + "x").paddedLeft(' ', 10) << std::endl;
+    }
+
+    return 0;
+}
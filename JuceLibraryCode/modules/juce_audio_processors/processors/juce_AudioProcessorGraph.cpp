@@ -27,6 +27,8 @@
 
 #include "../Source/Utils/Utils.h"
 
+#include "../Source/Utils/RealtimeWorkerPool.h"
+
 namespace juce
 {
 
@@ -39,7 +41,7 @@ static void updateOnMessageThread (AsyncUpdater& updater)
 }
 
 template <typename FloatType>
-struct GraphRenderSequence
+struct GraphRenderSequence  : private RealtimeWorkerPool::Job
 {
     GraphRenderSequence() {}
 
@@ -85,8 +87,20 @@ struct GraphRenderSequence
         {
             const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples };
 
-            for (auto* op : renderOps)
-                op->perform (context);
+            if (workerPool != nullptr)
+            {
+                for (auto* task : parallelTasks)
+                    task->pendingDependencies.store (task->numDependencies, std::memory_order_relaxed);
+
+                currentContext = &context;
+                workerPool->run (*this, parallelTasks.size());
+                currentContext = nullptr;
+            }
+            else
+            {
+                for (auto* op : renderOps)
+                    op->perform (context);
+            }
         }
 
         for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -99,48 +113,192 @@ struct GraphRenderSequence
 
     void addClearChannelOp (int index)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); });
+        auto* op = createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); });
+        op->buffersWritten.add (audioBufferKey (index));
     }
 
     void addCopyChannelOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::copy (c.audioBuffers[dstIndex],
-                                                                           c.audioBuffers[srcIndex],
-                                                                           c.numSamples); });
+        auto* op = createOp ([=] (const Context& c)    { FloatVectorOperations::copy (c.audioBuffers[dstIndex],
+                                                                                      c.audioBuffers[srcIndex],
+                                                                                      c.numSamples); });
+        op->buffersRead.add (audioBufferKey (srcIndex));
+        op->buffersWritten.add (audioBufferKey (dstIndex));
     }
 
     void addAddChannelOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::add (c.audioBuffers[dstIndex],
-                                                                          c.audioBuffers[srcIndex],
-                                                                          c.numSamples); });
+        auto* op = createOp ([=] (const Context& c)    { FloatVectorOperations::add (c.audioBuffers[dstIndex],
+                                                                                     c.audioBuffers[srcIndex],
+                                                                                     c.numSamples); });
+        op->buffersRead.add (audioBufferKey (srcIndex));
+        op->buffersWritten.add (audioBufferKey (dstIndex));
     }
 
     void addClearMidiBufferOp (int index)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); });
+        auto* op = createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); });
+        op->buffersWritten.add (midiBufferKey (index));
     }
 
     void addCopyMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
+        auto* op = createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
+        op->buffersRead.add (midiBufferKey (srcIndex));
+        op->buffersWritten.add (midiBufferKey (dstIndex));
     }
 
     void addAddMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
-                                                                                 0, c.numSamples, 0); });
+        auto* op = createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
+                                                                                            0, c.numSamples, 0); });
+        op->buffersRead.add (midiBufferKey (srcIndex));
+        op->buffersWritten.add (midiBufferKey (dstIndex));
     }
 
     void addDelayChannelOp (int chan, int delaySize)
     {
-        renderOps.add (new DelayChannelOp (chan, delaySize));
+        auto* op = renderOps.add (new DelayChannelOp (chan, delaySize));
+        op->buffersWritten.add (audioBufferKey (chan));
     }
 
     void addProcessOp (const AudioProcessorGraph::Node::Ptr& node,
                        const Array<int>& audioChannelsUsed, int totalNumChans, int midiBuffer)
     {
-        renderOps.add (new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer));
+        auto* op = new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer);
+
+        // processors may write to any of their channels, so every buffer they get counts as written
+        for (auto index : op->audioChannelsToUse)
+            op->buffersWritten.addIfNotAlreadyThere (audioBufferKey (index));
+
+        op->buffersWritten.add (midiBufferKey (midiBuffer));
+
+        // the graph's I/O nodes read and write the shared input and output buffers
+        op->isBarrier = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()) != nullptr;
+
+        renderOps.add (op);
+    }
+
+    /** Groups the rendering ops into tasks that can run concurrently, and starts a worker pool
+        to run them if the graph has independent branches. Two ops are ordered if one writes a
+        buffer that the other reads or writes, so branches are always joined before the op that
+        merges their outputs, and buffers reused by the builder are never shared between threads.
+
+        Tasks are numbered so that a task's dependencies always have lower indices, which lets
+        the pool claim them in order without deadlocking.
+
+        Custom method added for Open Ephys GUI.
+     */
+    void buildParallelSchedule()
+    {
+        struct BufferState
+        {
+            int lastWriter = -1;
+            Array<int> readers;
+        };
+
+        std::map<int, BufferState> bufferStates;
+        OwnedArray<ParallelTask> tasks;
+        int lastBarrier = -1;
+
+        for (auto* op : renderOps)
+        {
+            Array<int> dependencies;
+
+            if (op->isBarrier)
+            {
+                for (int i = 0; i < tasks.size(); ++i)
+                    if (tasks[i]->successors.isEmpty())
+                        dependencies.add (i);
+            }
+
+            for (auto key : op->buffersRead)
+            {
+                auto& state = bufferStates[key];
+
+                if (state.lastWriter >= 0)
+                    dependencies.addIfNotAlreadyThere (state.lastWriter);
+            }
+
+            for (auto key : op->buffersWritten)
+            {
+                auto& state = bufferStates[key];
+
+                if (state.lastWriter >= 0)
+                    dependencies.addIfNotAlreadyThere (state.lastWriter);
+
+                for (auto reader : state.readers)
+                    dependencies.addIfNotAlreadyThere (reader);
+            }
+
+            if (lastBarrier >= 0)
+                dependencies.addIfNotAlreadyThere (lastBarrier);
+
+            int taskIndex;
+
+            // extend a chain of dependent ops in place, as long as nothing else is waiting for it yet
+            if (! op->isBarrier && dependencies.size() == 1 && tasks[dependencies[0]]->successors.isEmpty())
+            {
+                taskIndex = dependencies[0];
+            }
+            else
+            {
+                taskIndex = tasks.size();
+                tasks.add (new ParallelTask());
+
+                for (auto dependency : dependencies)
+                    tasks[dependency]->successors.add (taskIndex);
+
+                if (op->isBarrier)
+                    lastBarrier = taskIndex;
+            }
+
+            tasks[taskIndex]->ops.add (op);
+
+            for (auto key : op->buffersRead)
+                bufferStates[key].readers.addIfNotAlreadyThere (taskIndex);
+
+            for (auto key : op->buffersWritten)
+            {
+                auto& state = bufferStates[key];
+                state.lastWriter = taskIndex;
+                state.readers.clearQuick();
+            }
+        }
+
+        // the widest level of the task graph is the most work that can ever run at once
+        Array<int> depth;
+        std::map<int, int> tasksAtDepth;
+        int maxWidth = 0;
+
+        for (int i = 0; i < tasks.size(); ++i)
+            depth.add (0);
+
+        for (int i = 0; i < tasks.size(); ++i)
+        {
+            for (auto successor : tasks[i]->successors)
+                depth.set (successor, jmax (depth[successor], depth[i] + 1));
+
+            maxWidth = jmax (maxWidth, ++tasksAtDepth[depth[i]]);
+        }
+
+        workerPool.reset();
+        parallelTasks.clear();
+
+        // the thread calling perform() takes part, so it doesn't need a worker of its own
+        const int numWorkers = jmin (maxWidth, SystemStats::getNumCpus()) - 1;
+
+        if (numWorkers < 1 || tasks.size() >= 0x10000)
+            return;
+
+        for (auto* task : tasks)
+            for (auto successor : task->successors)
+                tasks[successor]->numDependencies++;
+
+        LOGD("Rendering ", renderOps.size(), " ops as ", tasks.size(), " tasks on ", numWorkers + 1, " threads");
+
+        parallelTasks.swapWith (tasks);
+        workerPool = std::make_unique<RealtimeWorkerPool> ("Graph Worker", numWorkers);
     }
 
     void prepareBuffers (int blockSize)
@@ -194,14 +352,54 @@ private:
         virtual ~RenderingOp() {}
         virtual void perform (const Context&) = 0;
 
+        /** Buffers accessed by this op (see audioBufferKey and midiBufferKey), for buildParallelSchedule() */
+        Array<int> buffersRead, buffersWritten;
+
+        /** True if this op must not overlap with any other op */
+        bool isBarrier = false;
+
         JUCE_LEAK_DETECTOR (RenderingOp)
     };
 
     OwnedArray<RenderingOp> renderOps;
 
+    //==============================================================================
+    /** A group of ops that run in order on one worker thread */
+    struct ParallelTask
+    {
+        Array<RenderingOp*> ops;
+        Array<int> successors;
+        int numDependencies = 0;
+
+        /** Reset to numDependencies before every block, and counted down as they finish */
+        std::atomic<int> pendingDependencies { 0 };
+    };
+
+    static int audioBufferKey (int index) noexcept    { return index * 2; }
+    static int midiBufferKey (int index) noexcept     { return index * 2 + 1; }
+
+    void runTask (int index) override
+    {
+        auto* task = parallelTasks.getUnchecked (index);
+
+        // tasks are claimed in order, so every dependency has already been picked up by a running thread
+        while (task->pendingDependencies.load (std::memory_order_acquire) > 0)
+            Thread::yield();
+
+        for (auto* op : task->ops)
+            op->perform (*currentContext);
+
+        for (auto successor : task->successors)
+            parallelTasks.getUnchecked (successor)->pendingDependencies.fetch_sub (1, std::memory_order_acq_rel);
+    }
+
+    OwnedArray<ParallelTask> parallelTasks;
+    std::unique_ptr<RealtimeWorkerPool> workerPool;
+    const Context* currentContext = nullptr;
+
     //==============================================================================
     template <typename LambdaType>
-    void createOp (LambdaType&& fn)
+    RenderingOp* createOp (LambdaType&& fn)
     {
         struct LambdaOp  : public RenderingOp
         {
@@ -211,7 +409,7 @@ private:
             LambdaType function;
         };
 
-        renderOps.add (new LambdaOp (std::move (fn)));
+        return renderOps.add (new LambdaOp (std::move (fn)));
     }
 
     //==============================================================================
@@ -1460,6 +1658,9 @@ void AudioProcessorGraph::buildRenderingSequence()
     newSequenceF->prepareBuffers(currentBlockSize);
     //newSequenceD->prepareBuffers (currentBlockSize);
 
+    if (parallelRendering)
+        newSequenceF->buildParallelSchedule();
+
     if (anyNodesNeedPreparing())
     {
         renderSequenceFloat.reset();
@@ -1476,6 +1677,17 @@ void AudioProcessorGraph::buildRenderingSequence()
 
 }
 
+void AudioProcessorGraph::setParallelRendering (bool shouldRenderInParallel)
+{
+    if (parallelRendering == shouldRenderInParallel)
+        return;
+
+    parallelRendering = shouldRenderInParallel;
+
+    if (isPrepared)
+        updateOnMessageThread (*this);
+}
+
 void AudioProcessorGraph::handleAsyncUpdate()
 {
     //isPrepared = 1;
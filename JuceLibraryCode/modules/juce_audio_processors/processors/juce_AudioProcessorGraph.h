@@ -381,6 +381,14 @@ public:
     const String getName() const override;
     void prepareToPlay (double, int) override;
     void buildRenderingSequence(); // switch to public method for Open Ephys GUI
+
+    /** Lets independent branches of the graph run on worker threads. Off by default.
+        If the graph is prepared, the rendering sequence is rebuilt on the message thread.
+        Added for Open Ephys GUI. */
+    void setParallelRendering (bool shouldRenderInParallel);
+
+    /** Returns true if independent branches may run on worker threads. Added for Open Ephys GUI. */
+    bool isParallelRenderingEnabled() const noexcept                     { return parallelRendering; }
     void releaseResources() override;
     void processBlock (AudioBuffer<float>&,  MidiBuffer&) override;
     void processBlock (AudioBuffer<double>&, MidiBuffer&) override;
@@ -437,6 +445,8 @@ private:
 
     std::atomic<bool> isPrepared { false };
 
+    bool parallelRendering = false;
+
     void topologyChanged();
     void unprepare();
     void handleAsyncUpdate() override;
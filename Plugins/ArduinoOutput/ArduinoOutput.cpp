@@ -138,15 +138,15 @@ void ArduinoOutput::parameterValueChanged(Parameter* parameter)
     }
 }
 
-void ArduinoOutput::handleTTLEvent(TTLEventPtr event)
+void ArduinoOutput::handleTTLEventView(const TTLEventView& event)
 {
 
-    const int eventBit = event->getLine() + 1;
-    DataStream* stream = getDataStream(event->getStreamId());
+    const int eventBit = event.getLine() + 1;
+    DataStream* stream = getDataStream(event.getStreamId());
 
     if (eventBit == int((*stream)["gate_line"]))
     {
-        if (event->getState())
+        if (event.getState())
             gateIsOpen = true;
         else
             gateIsOpen = false;
@@ -157,7 +157,7 @@ void ArduinoOutput::handleTTLEvent(TTLEventPtr event)
         if (eventBit == int((*stream)["input_line"]))
         {
 
-            if (event->getState())
+            if (event.getState())
             {
                 arduino.sendDigital(
                     getParameter("output_pin")->getValue(),
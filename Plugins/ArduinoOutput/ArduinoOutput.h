@@ -54,7 +54,7 @@ public:
     void parameterValueChanged(Parameter* parameter) override;
 
     /** Convenient interface for responding to incoming events. */
-    void handleTTLEvent (TTLEventPtr event) override;
+    void handleTTLEventView (const TTLEventView& event) override;
 
     /** Called when settings need to be updated. */
     void updateSettings() override;
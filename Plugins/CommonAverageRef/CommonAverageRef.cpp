@@ -50,6 +50,8 @@ CommonAverageRef::CommonAverageRef()
                       0.0f,
                       100.0f,
                       1.0f);
+
+    setParallelStreamProcessing(true);
 }
 
 
@@ -73,63 +75,52 @@ void CommonAverageRef::updateSettings()
 
 void CommonAverageRef::process (AudioBuffer<float>& buffer)
 {
+    processStreamsInParallel(buffer);
+}
+
+void CommonAverageRef::processStream (uint16 streamId, AudioBuffer<float>& buffer)
+{
+    DataStream* stream = getDataStream(streamId);
 
-    for (auto stream : getDataStreams())
+    CARSettings* settings_ = settings[streamId];
+
+    const int numSamples = getNumSamplesInBlock(streamId);
+    const int numReferenceChannels = (*stream)["Reference"].getArray()->size();
+    const int numAffectedChannels = (*stream)["Affected"].getArray()->size();
+
+    // There is no need to do any processing if either number of reference or affected channels is zero.
+    if (!numReferenceChannels
+        || !numAffectedChannels)
     {
+        return;
+    }
+
+    settings_->m_avgBuffer.clear();
 
-        if ((*stream)["enable_stream"])
-        {
-            CARSettings* settings_ = settings[stream->getStreamId()];
-
-            const int numSamples = getNumSamplesInBlock(stream->getStreamId());
-            const int numReferenceChannels = (*stream)["Reference"].getArray()->size();
-            const int numAffectedChannels = (*stream)["Affected"].getArray()->size();
-
-            // There is no need to do any processing if either number of reference or affected channels is zero.
-            if (!numReferenceChannels
-                || !numAffectedChannels)
-            {
-                return;
-            }
-
-            settings_->m_avgBuffer.clear();
-
-            for (int i = 0; i < numReferenceChannels; ++i)
-            {
-                int localIndex = (*stream)["Reference"][i];
-                int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
-
-                settings_->m_avgBuffer.addFrom(0,       // destChannel
-                    0,                                  // destStartSample
-                    buffer,                             // source
-                    globalIndex,                        // sourceChannel
-                    0,                                  // sourceStartSample
-                    numSamples,                         // numSamples
-                    1.0f);                              // gain to apply
-            }
-
-            settings_->m_avgBuffer.applyGain(1.0f / float(numReferenceChannels));
-
-            const float gain = -1.0f * float((*stream)["gain_level"]) / 100.f;
-
-            for (int i = 0; i < numAffectedChannels; ++i)
-            {
-                int localIndex = (*stream)["Affected"][i];
-                int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
-
-                buffer.addFrom(globalIndex,                // destChannel
-                    0,                                     // destStartSample
-                    settings_->m_avgBuffer,                // source
-                    0,                                     // sourceChannel
-                    0,                                     // sourceStartSample
-                    numSamples,                            // numSamples
-                    gain);                                 // gain to apply
-            }
-        }
-
-        
+    for (int i = 0; i < numReferenceChannels; ++i)
+    {
+        int localIndex = (*stream)["Reference"][i];
+        int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
+
+        // raw pointers, since the AudioBuffer methods update its shared isClear flag
+        FloatVectorOperations::add(settings_->m_avgBuffer.getWritePointer(0),
+            getStreamWritePointer(globalIndex),
+            numSamples);
     }
 
-   
+    settings_->m_avgBuffer.applyGain(1.0f / float(numReferenceChannels));
+
+    const float gain = -1.0f * float((*stream)["gain_level"]) / 100.f;
+
+    for (int i = 0; i < numAffectedChannels; ++i)
+    {
+        int localIndex = (*stream)["Affected"][i];
+        int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
+
+        FloatVectorOperations::addWithMultiply(getStreamWritePointer(globalIndex),
+            settings_->m_avgBuffer.getReadPointer(0),
+            gain,
+            numSamples);
+    }
 }
 
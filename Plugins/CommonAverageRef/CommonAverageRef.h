@@ -65,6 +65,9 @@ public:
     /** Called every time a new data buffer is available. */
     void process (AudioBuffer<float>& buffer) override;
 
+    /** Subtracts the reference average from the affected channels of one data stream. */
+    void processStream (uint16 streamId, AudioBuffer<float>& buffer) override;
+
     /** Called when upstream settings are changed.*/
     void updateSettings() override;
 
@@ -73,6 +73,7 @@ FilterNode::FilterNode()
     addFloatParameter(Parameter::STREAM_SCOPE, "low_cut", "Filter low cut", 300, 0.1, 15000, false);
     addMaskChannelsParameter(Parameter::STREAM_SCOPE, "Channels", "Channels to filter for this stream");
 
+    setParallelStreamProcessing(true);
 }
 
 AudioProcessorEditor* FilterNode::createEditor()
@@ -195,27 +196,25 @@ void FilterNode::parameterValueChanged(Parameter* param)
 
 void FilterNode::process (AudioBuffer<float>& buffer)
 {
+    processStreamsInParallel(buffer);
+}
 
-    for (auto stream : getDataStreams())
-    {
+void FilterNode::processStream (uint16 streamId, AudioBuffer<float>& buffer)
+{
+    DataStream* stream = getDataStream(streamId);
 
-        if ((*stream)["enable_stream"])
-        {
-            BandpassFilterSettings* streamSettings = settings[stream->getStreamId()];
-            
-            const uint16 streamId = stream->getStreamId();
-            const uint32 numSamples = getNumSamplesInBlock(streamId);
+    BandpassFilterSettings* streamSettings = settings[streamId];
+
+    const uint32 numSamples = getNumSamplesInBlock(streamId);
 
-            for (auto localChannelIndex : *((*stream)["Channels"].getArray()))
-            {
-                int globalChannelIndex = getGlobalChannelIndex(stream->getStreamId(), (int) localChannelIndex);
+    for (auto localChannelIndex : *((*stream)["Channels"].getArray()))
+    {
+        int globalChannelIndex = getGlobalChannelIndex(streamId, (int) localChannelIndex);
 
-                float* ptr = buffer.getWritePointer(globalChannelIndex);
+        float* ptr = getStreamWritePointer(globalChannelIndex);
 
-                streamSettings->filters[localChannelIndex]->process(numSamples, &ptr);
+        streamSettings->filters[localChannelIndex]->process(numSamples, &ptr);
 
-            }
-        }
     }
 }
 
@@ -78,6 +78,9 @@ public:
     /** Filters incoming channels according to current parameters */
     void process(AudioBuffer<float>& buffer) override;
 
+    /** Filters the selected channels of one data stream */
+    void processStream(uint16 streamId, AudioBuffer<float>& buffer) override;
+
     /** Called whenever a parameter's value is changed (called by GenericProcessor::setParameter())*/
     void parameterValueChanged(Parameter* param) override;
 
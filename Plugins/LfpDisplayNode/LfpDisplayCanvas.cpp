@@ -1112,6 +1112,8 @@ void LfpDisplaySplitter::pause(bool shouldPause)
 
 void LfpDisplaySplitter::updateScreenBuffer()
 {
+    TraceSpan span("LfpDisplaySplitter::updateScreenBuffer");
+
     if (isVisible() && displayBuffer != nullptr && !isUpdating)
     {
 
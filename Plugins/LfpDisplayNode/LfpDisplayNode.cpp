@@ -229,16 +229,16 @@ void LfpDisplayNode::stopRecording()
     }
 }
 
-void LfpDisplayNode::handleTTLEvent(TTLEventPtr event)
+void LfpDisplayNode::handleTTLEventView(const TTLEventView& event)
 {
 
-    const int eventId = event->getState() ? 1 : 0;
-    const int eventChannel = event->getLine();
-    const uint16 eventStreamId = event->getChannelInfo()->getStreamId();
-    const int eventSourceNodeId = event->getChannelInfo()->getSourceNodeId();
-    const int eventTime = event->getSampleNumber() - getFirstSampleNumberForBlock(eventStreamId);
+    const int eventId = event.getState() ? 1 : 0;
+    const int eventChannel = event.getLine();
+    const uint16 eventStreamId = event.getChannelInfo()->getStreamId();
+    const int eventSourceNodeId = event.getChannelInfo()->getSourceNodeId();
+    const int eventTime = event.getSampleNumber() - getFirstSampleNumberForBlock(eventStreamId);
 
-    //LOGD("LFP Viewer received: ", eventSourceNodeId, " ", eventId, " ", event->getSampleNumber(), " ", getFirstSampleNumberForBlock(eventStreamId));
+    //LOGD("LFP Viewer received: ", eventSourceNodeId, " ", eventId, " ", event.getSampleNumber(), " ", getFirstSampleNumberForBlock(eventStreamId));
 
     if (eventId == 1)
     {
@@ -268,8 +268,8 @@ void LfpDisplayNode::handleTTLEvent(TTLEventPtr event)
     {
         if(display->selectedStreamId == eventStreamId)
         {
-            if (event->getWord() != 0)
-                display->options->setTTLWord(String(event->getWord()));
+            if (event.getWord() != 0)
+                display->options->setTTLWord(String(event.getWord()));
         }
     }
 
@@ -314,13 +314,23 @@ void LfpDisplayNode::process (AudioBuffer<float>& buffer)
     checkForEvents();
     finalizeEventChannels();
 
+    // channels are grouped by stream, so only look up the block info and display buffer when the stream changes
+    DisplayBuffer* displayBuffer = nullptr;
+    uint16 currentStreamId = 0;
+    uint32 nSamples = 0;
+
     for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
     {
         const uint16 streamId = continuousChannels[chan]->getStreamId();
 
-        const uint32 nSamples = getNumSamplesInBlock(streamId);
+        if (displayBuffer == nullptr || streamId != currentStreamId)
+        {
+            currentStreamId = streamId;
+            nSamples = getBlockInfo(streamId).numSamples;
+            displayBuffer = displayBufferMap[streamId];
+        }
 
-        displayBufferMap[streamId]->addData(buffer, chan, nSamples);
+        displayBuffer->addData(buffer, chan, nSamples);
     }
 }
 
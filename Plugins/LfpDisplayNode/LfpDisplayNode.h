@@ -83,7 +83,7 @@ public:
     void stopRecording()  override;
 
     /** Used for TTL event overlay*/
-    void handleTTLEvent (TTLEventPtr event) override;
+    void handleTTLEventView (const TTLEventView& event) override;
 
     /** Returns an array of pointers to the availble displayBuffers*/
     Array<DisplayBuffer*> getDisplayBuffers();
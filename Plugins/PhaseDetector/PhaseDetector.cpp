@@ -159,16 +159,16 @@ void PhaseDetector::updateSettings()
 
 
 
-void PhaseDetector::handleTTLEvent (TTLEventPtr event)
+void PhaseDetector::handleTTLEventView (const TTLEventView& event)
 {
 
-    const uint16 eventStream = event->getStreamId();
+    const uint16 eventStream = event.getStreamId();
 	
     if (settings[eventStream]->gateLine > -1)
     {
      
-        if (settings[eventStream]->gateLine == event->getLine())
-            settings[eventStream]->isActive = event->getState();
+        if (settings[eventStream]->gateLine == event.getLine())
+            settings[eventStream]->isActive = event.getState();
         
     }
 
@@ -188,8 +188,9 @@ void PhaseDetector::process (AudioBuffer<float>& buffer)
             PhaseDetectorSettings* module = settings[stream->getStreamId()];
             
             const uint16 streamId = stream->getStreamId();
-            const int64 firstSampleInBlock = getFirstSampleNumberForBlock(streamId);
-            const uint32 numSamplesInBlock = getNumSamplesInBlock(streamId);
+            const BlockInfo& block = getBlockInfo(streamId);
+            const int64 firstSampleInBlock = block.firstSampleNumber;
+            const uint32 numSamplesInBlock = block.numSamples;
 
             // check to see if it's active and has a channel
             if (module->isActive && module->outputLine >= 0
@@ -104,7 +104,7 @@ public:
 
 private:
     /** Called whenever a new TTL event arrives*/
-    void handleTTLEvent (TTLEventPtr event) override;
+    void handleTTLEventView (const TTLEventView& event) override;
 
     StreamSettings<PhaseDetectorSettings> settings;
 
@@ -61,16 +61,16 @@ void RecordControl::process (AudioSampleBuffer& buffer)
 }
 
 
-void RecordControl::handleTTLEvent (TTLEventPtr event)
+void RecordControl::handleTTLEventView (const TTLEventView& event)
 {
 
-    DataStream* stream = getDataStream(event->getStreamId());
+    DataStream* stream = getDataStream(event.getStreamId());
 
-	if (event->getLine() == ( int((*stream)["trigger_line"]) - 1))
+	if (event.getLine() == ( int((*stream)["trigger_line"]) - 1))
 	{
 		if (int(getParameter("trigger_type")->getValue()) == 0) // edge set
 		{
-			if (event->getState() == bool(getParameter("edge")->getValue()))
+			if (event.getState() == bool(getParameter("edge")->getValue()))
 			{
 				CoreServices::setRecordingStatus(false);
 			}
@@ -81,7 +81,7 @@ void RecordControl::handleTTLEvent (TTLEventPtr event)
 		}
 		else // edge toggle
 		{
-            if (event->getState() != bool(getParameter("edge")->getValue()))
+            if (event.getState() != bool(getParameter("edge")->getValue()))
             {
                 CoreServices::setRecordingStatus(!CoreServices::getRecordingStatus());
             }
@@ -49,7 +49,7 @@ public:
     void process (AudioBuffer<float>& buffer) override;
 
     /** Respond to incoming events */
-    void handleTTLEvent (TTLEventPtr event) override;
+    void handleTTLEventView (const TTLEventView& event) override;
 
 private:
 
@@ -0,0 +1,52 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __SHAREDMEMORYEDITOR_H_51D0C3E8__
+#define __SHAREDMEMORYEDITOR_H_51D0C3E8__
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the Shared Memory Source.
+
+  @see SharedMemoryThread
+
+*/
+class SharedMemoryEditor : public GenericEditor
+{
+public:
+
+    /** Constructor */
+    SharedMemoryEditor(GenericProcessor* parentNode);
+
+    /** Destructor */
+    virtual ~SharedMemoryEditor() { }
+
+private:
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedMemoryEditor);
+
+};
+
+#endif  // __SHAREDMEMORYEDITOR_H_51D0C3E8__
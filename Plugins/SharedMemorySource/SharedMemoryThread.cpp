@@ -0,0 +1,394 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "SharedMemoryThread.h"
+#include "SharedMemoryEditor.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+/* Largest number of samples copied from the ring in one go */
+#define MAX_SAMPLES_PER_READ 4096
+
+/* How often the ring is checked for new samples while it's empty */
+#define POLL_INTERVAL_US 250
+
+bool SharedMemoryThread::Layout::operator== (const Layout& other) const
+{
+    return numChannels == other.numChannels
+        && capacity == other.capacity
+        && sampleRate == other.sampleRate
+        && bitVolts == other.bitVolts
+        && ttlBits == other.ttlBits
+        && streamName == other.streamName;
+}
+
+SharedMemoryThread::SharedMemoryThread(SourceNode* sn)
+    : DataThread(sn),
+      segmentName("/oe_shm"),
+      mapping(nullptr),
+      mappingSize(0),
+      mappedInode(0),
+      header(nullptr),
+      ringData(nullptr),
+      ringTtl(nullptr),
+      layoutChanged(false),
+      readIndex(0),
+      samplesLost(0),
+      droppedAtStart(0)
+{
+    sn->addStringParameter(Parameter::GLOBAL_SCOPE, "segment", "Name of the shared-memory ring", segmentName, true);
+}
+
+SharedMemoryThread::~SharedMemoryThread()
+{
+    if (header != nullptr)
+        __atomic_store_n(&header->consumer_attached, 0, __ATOMIC_RELEASE);
+
+    unmap();
+}
+
+std::unique_ptr<GenericEditor> SharedMemoryThread::createEditor(SourceNode* sn)
+{
+    return std::make_unique<SharedMemoryEditor>(sn);
+}
+
+void SharedMemoryThread::parameterValueChanged(Parameter* param)
+{
+    if (param->getName().equalsIgnoreCase("segment"))
+    {
+        segmentName = param->getValue().toString().trim();
+
+        if (! segmentName.startsWith("/"))
+            segmentName = "/" + segmentName;
+
+        unmap();
+
+        if (sn->getEditor() != nullptr)
+            sn->requestSignalChainUpdate();
+    }
+}
+
+bool SharedMemoryThread::map()
+{
+    int fd = shm_open(segmentName.toRawUTF8(), O_RDWR, 0);
+
+    if (fd < 0)
+    {
+        unmap();
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) OE_SHM_HEADER_SIZE)
+    {
+        close(fd);
+        unmap();
+        return false;
+    }
+
+    if (mapping != nullptr && (uint64) info.st_ino == mappedInode)
+    {
+        close(fd);
+        return true;
+    }
+
+    const size_t size = (size_t) info.st_size;
+    void* newMapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (newMapping == MAP_FAILED)
+    {
+        unmap();
+        return false;
+    }
+
+    oe_shm_header* newHeader = (oe_shm_header*) newMapping;
+
+    const uint64 numChannels = newHeader->num_channels;
+    const uint64 capacity = newHeader->capacity;
+
+    // the producer writes the magic number last, so a ring that is still being created is skipped
+    bool valid = __atomic_load_n(&newHeader->magic, __ATOMIC_ACQUIRE) == OE_SHM_MAGIC
+        && newHeader->version == OE_SHM_VERSION
+        && numChannels > 0
+        && capacity >= 2
+        && newHeader->sample_rate > 0.0
+        && newHeader->ttl_bits <= 64
+        && newHeader->data_offset % sizeof(float) == 0
+        && newHeader->ttl_offset % sizeof(uint64) == 0
+        && newHeader->data_offset + numChannels * capacity * sizeof(float) <= size
+        && newHeader->ttl_offset + capacity * sizeof(uint64) <= size;
+
+    if (! valid)
+    {
+        munmap(newMapping, size);
+        unmap();
+        return false;
+    }
+
+    unmap();
+
+    mapping = newMapping;
+    mappingSize = size;
+    mappedInode = (uint64) info.st_ino;
+
+    header = newHeader;
+    ringData = (const float*) ((const char*) mapping + header->data_offset);
+    ringTtl = (const uint64*) ((const char*) mapping + header->ttl_offset);
+
+    layout.numChannels = (int) numChannels;
+    layout.capacity = (int) capacity;
+    layout.sampleRate = header->sample_rate;
+    layout.bitVolts = header->bit_volts;
+    layout.ttlBits = (int) header->ttl_bits;
+    layout.streamName = String::fromUTF8(header->stream_name, (int) strnlen(header->stream_name, OE_SHM_NAME_LENGTH));
+
+    if (configuredLayout.numChannels > 0 && ! (layout == configuredLayout))
+        layoutChanged = true;
+
+    LOGC("Shared Memory Source: mapped ", segmentName, " (", layout.numChannels, " channels at ",
+         layout.sampleRate, " Hz, ", layout.capacity, " samples)");
+
+    return true;
+}
+
+void SharedMemoryThread::unmap()
+{
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+    mappingSize = 0;
+    mappedInode = 0;
+
+    header = nullptr;
+    ringData = nullptr;
+    ringTtl = nullptr;
+
+    layout = Layout();
+}
+
+bool SharedMemoryThread::foundInputSource()
+{
+    if (isThreadRunning())
+        return header != nullptr;
+
+    if (! map())
+        return false;
+
+    // report the old stream as lost once, so the SourceNode updates the signal chain for the new one
+    if (layoutChanged)
+    {
+        layoutChanged = false;
+        return false;
+    }
+
+    return true;
+}
+
+void SharedMemoryThread::updateSettings(OwnedArray<ContinuousChannel>* continuousChannels,
+    OwnedArray<EventChannel>* eventChannels,
+    OwnedArray<SpikeChannel>* spikeChannels,
+    OwnedArray<DataStream>* sourceStreams,
+    OwnedArray<DeviceInfo>* devices,
+    OwnedArray<ConfigurationObject>* configurationObjects)
+{
+    continuousChannels->clear();
+    eventChannels->clear();
+    spikeChannels->clear();
+    sourceStreams->clear();
+    devices->clear();
+    configurationObjects->clear();
+
+    configuredLayout = map() ? layout : Layout();
+    layoutChanged = false;
+
+    if (configuredLayout.numChannels == 0)
+        return;
+
+    DataStream::Settings streamSettings
+    {
+        configuredLayout.streamName.isEmpty() ? "shm" : configuredLayout.streamName,
+        "Data read from the shared-memory ring " + segmentName,
+        "shm.stream",
+        (float) configuredLayout.sampleRate
+    };
+
+    sourceStreams->add(new DataStream(streamSettings));
+    DataStream* stream = sourceStreams->getLast();
+
+    for (int ch = 0; ch < configuredLayout.numChannels; ch++)
+    {
+        ContinuousChannel::Settings channelSettings
+        {
+            ContinuousChannel::Type::ELECTRODE,
+            "CH" + String(ch + 1),
+            "Shared-memory channel",
+            "shm.continuous",
+            configuredLayout.bitVolts,
+            stream
+        };
+
+        continuousChannels->add(new ContinuousChannel(channelSettings));
+    }
+
+    EventChannel::Settings eventSettings
+    {
+        EventChannel::Type::TTL,
+        "Shared-memory TTL",
+        "TTL words written by the producer",
+        "shm.events",
+        stream,
+        jmax(1, configuredLayout.ttlBits)
+    };
+
+    eventChannels->add(new EventChannel(eventSettings));
+}
+
+void SharedMemoryThread::resizeBuffers()
+{
+    sourceBuffers.clear();
+
+    // room for half a second of data
+    if (configuredLayout.numChannels > 0)
+        sourceBuffers.add(new DataBuffer(configuredLayout.numChannels,
+                                         jmax(10000, int(configuredLayout.sampleRate / 2))));
+}
+
+bool SharedMemoryThread::startAcquisition()
+{
+    if (! map() || ! (layout == configuredLayout) || sourceBuffers.size() == 0)
+    {
+        LOGE("Shared Memory Source: ", segmentName, " has changed since the signal chain was updated.");
+        return false;
+    }
+
+    sourceBuffers[0]->clear();
+
+    // start from the current write position; the producer won't overwrite unread samples from now on
+    readIndex = __atomic_load_n(&header->write_index, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&header->read_index, readIndex, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->consumer_attached, 1, __ATOMIC_RELEASE);
+
+    samplesLost = 0;
+    droppedAtStart = __atomic_load_n(&header->dropped_samples, __ATOMIC_RELAXED);
+
+    startThread();
+
+    return true;
+}
+
+bool SharedMemoryThread::stopAcquisition()
+{
+    if (isThreadRunning())
+        signalThreadShouldExit();
+
+    waitForThreadToExit(500);
+
+    if (header != nullptr)
+    {
+        __atomic_store_n(&header->consumer_attached, 0, __ATOMIC_RELEASE);
+
+        const uint64 dropped = __atomic_load_n(&header->dropped_samples, __ATOMIC_RELAXED) - droppedAtStart;
+
+        if (dropped > 0 || samplesLost > 0)
+            LOGC("Shared Memory Source: producer dropped ", dropped, " samples; ", samplesLost, " samples were overwritten before being read");
+    }
+
+    return true;
+}
+
+bool SharedMemoryThread::updateBuffer()
+{
+    const uint64 written = __atomic_load_n(&header->write_index, __ATOMIC_ACQUIRE);
+    const uint64 capacity = (uint64) configuredLayout.capacity;
+
+    uint64 available = written - readIndex;
+
+    if (available == 0)
+    {
+        // the producer is another process, so there's nothing to wait on
+        std::this_thread::sleep_for(std::chrono::microseconds(POLL_INTERVAL_US));
+        return true;
+    }
+
+    if (available > capacity)
+    {
+        // only happens with a producer that doesn't respect read_index
+        samplesLost += available - capacity;
+        readIndex = written - capacity;
+        available = capacity;
+    }
+
+    DataBuffer* buffer = sourceBuffers[0];
+    DataBuffer::WriteReservation reservation;
+
+    const int reserved = buffer->reserveWrite((int) jmin(available, (uint64) MAX_SAMPLES_PER_READ), reservation);
+
+    if (reserved == 0)
+    {
+        waitForSpace(1, 10);
+        return true;
+    }
+
+    uint64 position = readIndex;
+
+    for (int segment = 0; segment < 2; segment++)
+    {
+        const int numSamples = reservation.numSamples[segment];
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            // the ring can wrap within one DataBuffer segment too
+            const int slot = int(position % capacity);
+            const int count = jmin(numSamples - done, int(capacity) - slot);
+
+            for (int ch = 0; ch < configuredLayout.numChannels; ch++)
+                memcpy(reservation.getChannelPointer(ch, segment) + done,
+                       ringData + (size_t) ch * capacity + slot,
+                       count * sizeof(float));
+
+            memcpy(reservation.getEventCodePointer(segment) + done, ringTtl + slot, count * sizeof(uint64));
+
+            done += count;
+            position += count;
+        }
+    }
+
+    buffer->commitWrite(reserved, (int64) readIndex, double(readIndex) / configuredLayout.sampleRate);
+
+    readIndex += reserved;
+
+    __atomic_store_n(&header->read_index, readIndex, __ATOMIC_RELEASE);
+
+    return true;
+}
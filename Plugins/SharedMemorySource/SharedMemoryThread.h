@@ -0,0 +1,132 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __SHAREDMEMORYTHREAD_H_9A4E27C1__
+#define __SHAREDMEMORYTHREAD_H_9A4E27C1__
+
+#include <DataThreadHeaders.h>
+
+#include "producer/oe_shm_ring.h"
+
+/**
+    Reads a data stream from a POSIX shared-memory ring filled by another process.
+
+    The ring's layout is described in producer/oe_shm_ring.h, and the producer
+    library in producer/oe_shm_producer.h writes to it. The ring is found by name
+    (the "segment" parameter); its header gives the channel count, sample rate,
+    bit volts and number of TTL lines, so the stream is configured automatically
+    when the producer starts.
+
+    Samples are copied straight from the ring into the DataBuffer's reserved space,
+    without any intermediate buffer.
+
+    @see DataThread, SourceNode
+*/
+class SharedMemoryThread : public DataThread
+{
+public:
+
+    /** Constructor */
+    SharedMemoryThread(SourceNode* sn);
+
+    /** Destructor */
+    ~SharedMemoryThread();
+
+    /** Copies the newly published samples from the ring */
+    bool updateBuffer() override;
+
+    /** Returns true if the ring exists and has a valid header */
+    bool foundInputSource() override;
+
+    /** Attaches to the ring and starts reading from its current write position */
+    bool startAcquisition() override;
+
+    /** Stops reading and detaches from the ring */
+    bool stopAcquisition() override;
+
+    /** Creates one stream matching the ring's header */
+    void updateSettings(OwnedArray<ContinuousChannel>* continuousChannels,
+        OwnedArray<EventChannel>* eventChannels,
+        OwnedArray<SpikeChannel>* spikeChannels,
+        OwnedArray<DataStream>* sourceStreams,
+        OwnedArray<DeviceInfo>* devices,
+        OwnedArray<ConfigurationObject>* configurationObjects) override;
+
+    /** Creates the DataBuffer for the stream */
+    void resizeBuffers() override;
+
+    /** Maps a different ring when the segment name changes */
+    void parameterValueChanged(Parameter* param) override;
+
+    /** Creates the editor */
+    std::unique_ptr<GenericEditor> createEditor(SourceNode* sn) override;
+
+private:
+
+    /** Layout read from a ring header */
+    struct Layout
+    {
+        int numChannels = 0;
+        int capacity = 0;
+        double sampleRate = 0.0;
+        float bitVolts = 1.0f;
+        int ttlBits = 0;
+        String streamName;
+
+        bool operator== (const Layout& other) const;
+    };
+
+    /** Maps the ring named by the segment parameter, unless it's already mapped.
+        Returns false if it doesn't exist or its header is invalid. */
+    bool map();
+
+    /** Unmaps the ring */
+    void unmap();
+
+    String segmentName;
+
+    void* mapping;
+    size_t mappingSize;
+    uint64 mappedInode;
+
+    oe_shm_header* header;
+    const float* ringData;
+    const uint64* ringTtl;
+
+    /** Layout of the mapped ring */
+    Layout layout;
+
+    /** Layout the streams were last configured with */
+    Layout configuredLayout;
+
+    /** Set when a ring with a different layout replaces the configured one */
+    bool layoutChanged;
+
+    uint64 readIndex;
+    uint64 samplesLost;
+    uint64 droppedAtStart;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedMemoryThread);
+};
+
+#endif  // __SHAREDMEMORYTHREAD_H_9A4E27C1__
@@ -0,0 +1,247 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "oe_shm_producer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct oe_shm_producer
+{
+    char name[256];
+    void* mapping;
+    size_t size;
+
+    oe_shm_header* header;
+    float* data;
+    uint64_t* ttl;
+
+    uint64_t write_index;
+    uint64_t ttl_mask;
+};
+
+oe_shm_producer* oe_shm_create (const char* name,
+                                uint32_t num_channels,
+                                uint32_t capacity,
+                                double sample_rate,
+                                float bit_volts,
+                                uint32_t ttl_bits,
+                                const char* stream_name)
+{
+    if (name == NULL || name[0] != '/' || strlen (name) >= sizeof (((oe_shm_producer*) 0)->name)
+        || num_channels == 0 || capacity < 2 || sample_rate <= 0.0 || ttl_bits > 64)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    oe_shm_producer* producer = (oe_shm_producer*) calloc (1, sizeof (oe_shm_producer));
+
+    if (producer == NULL)
+        return NULL;
+
+    strcpy (producer->name, name);
+    producer->size = (size_t) oe_shm_segment_size (num_channels, capacity);
+
+    /* start from a fresh object, so a GUI still mapping an old one sees it disappear */
+    shm_unlink (name);
+
+    int fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0660);
+
+    if (fd < 0)
+    {
+        free (producer);
+        return NULL;
+    }
+
+    if (ftruncate (fd, (off_t) producer->size) != 0)
+    {
+        int error = errno;
+        close (fd);
+        shm_unlink (name);
+        free (producer);
+        errno = error;
+        return NULL;
+    }
+
+    producer->mapping = mmap (NULL, producer->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+
+    if (producer->mapping == MAP_FAILED)
+    {
+        int error = errno;
+        shm_unlink (name);
+        free (producer);
+        errno = error;
+        return NULL;
+    }
+
+    oe_shm_header* header = (oe_shm_header*) producer->mapping;
+
+    /* ftruncate zero-fills, so only the layout needs writing */
+    header->version = OE_SHM_VERSION;
+    header->num_channels = num_channels;
+    header->capacity = capacity;
+    header->sample_rate = sample_rate;
+    header->bit_volts = bit_volts;
+    header->ttl_bits = ttl_bits;
+    header->data_offset = oe_shm_align (OE_SHM_HEADER_SIZE);
+    header->ttl_offset = oe_shm_align (header->data_offset + (uint64_t) num_channels * capacity * sizeof (float));
+
+    if (stream_name != NULL)
+        strncpy (header->stream_name, stream_name, OE_SHM_NAME_LENGTH - 1);
+
+    producer->header = header;
+    producer->data = (float*) ((char*) producer->mapping + header->data_offset);
+    producer->ttl = (uint64_t*) ((char*) producer->mapping + header->ttl_offset);
+    producer->ttl_mask = ttl_bits == 64 ? ~(uint64_t) 0 : (((uint64_t) 1 << ttl_bits) - 1);
+
+    /* the GUI ignores the segment until the magic number is there */
+    __atomic_store_n (&header->magic, OE_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return producer;
+}
+
+void oe_shm_destroy (oe_shm_producer* producer)
+{
+    if (producer == NULL)
+        return;
+
+    munmap (producer->mapping, producer->size);
+    shm_unlink (producer->name);
+    free (producer);
+}
+
+const oe_shm_header* oe_shm_get_header (const oe_shm_producer* producer)
+{
+    return producer->header;
+}
+
+uint32_t oe_shm_writable (const oe_shm_producer* producer)
+{
+    const oe_shm_header* header = producer->header;
+
+    if (__atomic_load_n (&header->consumer_attached, __ATOMIC_ACQUIRE) == 0)
+        return header->capacity;
+
+    uint64_t unread = producer->write_index - __atomic_load_n (&header->read_index, __ATOMIC_ACQUIRE);
+
+    return unread >= header->capacity ? 0 : (uint32_t) (header->capacity - unread);
+}
+
+/* Limits a write to the free space, counting the samples that don't fit */
+static uint32_t oe_shm_begin_write (oe_shm_producer* producer, uint32_t num_samples)
+{
+    uint32_t writable = oe_shm_writable (producer);
+
+    if (num_samples <= writable)
+        return num_samples;
+
+    __atomic_fetch_add (&producer->header->dropped_samples, num_samples - writable, __ATOMIC_RELAXED);
+
+    return writable;
+}
+
+/* Writes the TTL words of count samples and publishes them */
+static void oe_shm_end_write (oe_shm_producer* producer, const uint64_t* ttl, uint32_t count)
+{
+    const uint32_t capacity = producer->header->capacity;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t slot = (uint32_t) ((producer->write_index + i) % capacity);
+        producer->ttl[slot] = ttl == NULL ? 0 : (ttl[i] & producer->ttl_mask);
+    }
+
+    producer->write_index += count;
+
+    __atomic_store_n (&producer->header->write_index, producer->write_index, __ATOMIC_RELEASE);
+}
+
+uint32_t oe_shm_write (oe_shm_producer* producer,
+                       const float* data,
+                       size_t stride,
+                       const uint64_t* ttl,
+                       uint32_t num_samples)
+{
+    const uint32_t count = oe_shm_begin_write (producer, num_samples);
+    const uint32_t capacity = producer->header->capacity;
+    const uint32_t num_channels = producer->header->num_channels;
+
+    uint32_t done = 0;
+
+    while (done < count)
+    {
+        uint32_t slot = (uint32_t) ((producer->write_index + done) % capacity);
+        uint32_t chunk = count - done < capacity - slot ? count - done : capacity - slot;
+
+        for (uint32_t c = 0; c < num_channels; c++)
+            memcpy (producer->data + (size_t) c * capacity + slot, data + c * stride + done, chunk * sizeof (float));
+
+        done += chunk;
+    }
+
+    oe_shm_end_write (producer, ttl, count);
+
+    return count;
+}
+
+uint32_t oe_shm_write_interleaved (oe_shm_producer* producer,
+                                   const float* data,
+                                   const uint64_t* ttl,
+                                   uint32_t num_samples)
+{
+    const uint32_t count = oe_shm_begin_write (producer, num_samples);
+    const uint32_t capacity = producer->header->capacity;
+    const uint32_t num_channels = producer->header->num_channels;
+
+    uint32_t done = 0;
+
+    while (done < count)
+    {
+        uint32_t slot = (uint32_t) ((producer->write_index + done) % capacity);
+        uint32_t chunk = count - done < capacity - slot ? count - done : capacity - slot;
+
+        for (uint32_t c = 0; c < num_channels; c++)
+        {
+            float* dest = producer->data + (size_t) c * capacity + slot;
+            const float* src = data + (size_t) done * num_channels + c;
+
+            for (uint32_t i = 0; i < chunk; i++)
+                dest[i] = src[(size_t) i * num_channels];
+        }
+
+        done += chunk;
+    }
+
+    oe_shm_end_write (producer, ttl, count);
+
+    return count;
+}
@@ -0,0 +1,98 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef OE_SHM_PRODUCER_H_INCLUDED
+#define OE_SHM_PRODUCER_H_INCLUDED
+
+/*
+    Small C library for writing data into a ring read by the Shared Memory Source
+    plugin. See oe_shm_ring.h for the layout.
+
+    Typical use:
+
+        oe_shm_producer* p = oe_shm_create ("/my_rig", 384, 30000 * 2, 30000.0, 0.195f, 8, "my_rig");
+
+        for (;;)
+        {
+            ... acquire num_samples frames ...
+            oe_shm_write_interleaved (p, frames, ttl_words, num_samples);
+        }
+
+        oe_shm_destroy (p);
+
+    A producer handle must only be used from one thread.
+*/
+
+#include "oe_shm_ring.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct oe_shm_producer oe_shm_producer;
+
+/* Creates (or replaces) the shared-memory object called name, which must start with
+   a slash. bit_volts is stored for the GUI; the samples themselves are written as
+   floats. Returns NULL on failure (errno is set). */
+oe_shm_producer* oe_shm_create (const char* name,
+                                uint32_t num_channels,
+                                uint32_t capacity,
+                                double sample_rate,
+                                float bit_volts,
+                                uint32_t ttl_bits,
+                                const char* stream_name);
+
+/* Unmaps and removes the shared-memory object */
+void oe_shm_destroy (oe_shm_producer* producer);
+
+/* Returns the ring header, e.g. to read dropped_samples */
+const oe_shm_header* oe_shm_get_header (const oe_shm_producer* producer);
+
+/* Returns the number of samples per channel that can be written without
+   overwriting data the GUI hasn't read yet */
+uint32_t oe_shm_writable (const oe_shm_producer* producer);
+
+/* Writes planar data: channel c, sample i at data[c * stride + i]. ttl may be NULL
+   (all lines low). Returns the number of samples written; the rest are dropped
+   and counted in the header. */
+uint32_t oe_shm_write (oe_shm_producer* producer,
+                       const float* data,
+                       size_t stride,
+                       const uint64_t* ttl,
+                       uint32_t num_samples);
+
+/* Writes interleaved frames: sample i, channel c at data[i * num_channels + c].
+   Otherwise the same as oe_shm_write(). */
+uint32_t oe_shm_write_interleaved (oe_shm_producer* producer,
+                                   const float* data,
+                                   const uint64_t* ttl,
+                                   uint32_t num_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* OE_SHM_PRODUCER_H_INCLUDED */
@@ -0,0 +1,120 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef OE_SHM_RING_H_INCLUDED
+#define OE_SHM_RING_H_INCLUDED
+
+/*
+    Layout of the shared-memory ring read by the Shared Memory Source plugin.
+
+    The ring is a POSIX shared-memory object (shm_open) holding a single data stream.
+    The producer creates it; the GUI maps it read/write (it only writes the consumer
+    fields). All fields are in native byte order.
+
+      offset 0            oe_shm_header (256 bytes)
+      data_offset         float32 samples, planar: channel c, slot s at
+                          data[c * capacity + s]
+      ttl_offset          uint64 TTL word for each slot: ttl[s]
+
+    Sample k (counted from 0 since the ring was created) lives in slot k % capacity.
+    The producer fills the samples and TTL words of new slots, then publishes them by
+    storing the new write_index with release semantics. The consumer loads write_index
+    with acquire semantics, copies slots [read_index, write_index) and then stores
+    read_index with release semantics.
+
+    While consumer_attached is non-zero, the producer never overwrites unread slots:
+    samples that don't fit are discarded and counted in dropped_samples. Otherwise the
+    producer overwrites the oldest slots freely. The consumer sets read_index to the
+    current write_index before setting consumer_attached, and clears consumer_attached
+    when it stops reading.
+
+    Indices are accessed with the GCC / Clang __atomic builtins, which work on plain
+    integers from both C and C++.
+*/
+
+#include <stdint.h>
+
+#define OE_SHM_MAGIC        0x4F455348u  /* "OESH" */
+#define OE_SHM_VERSION      1u
+#define OE_SHM_HEADER_SIZE  256u
+#define OE_SHM_ALIGNMENT    64u
+#define OE_SHM_NAME_LENGTH  64u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct oe_shm_header
+{
+    /* Layout, written once by the producer before the magic number */
+    uint32_t magic;                     /* OE_SHM_MAGIC, written last */
+    uint32_t version;                   /* OE_SHM_VERSION */
+    uint32_t num_channels;              /* continuous channels in the stream */
+    uint32_t capacity;                  /* slots per channel */
+    double sample_rate;                 /* Hz */
+    float bit_volts;                    /* microvolts per unit of the float samples (usually 1.0) */
+    uint32_t ttl_bits;                  /* number of TTL lines used in each TTL word (0 to 64) */
+    uint64_t data_offset;               /* byte offset of the sample region */
+    uint64_t ttl_offset;                /* byte offset of the TTL region */
+    char stream_name[OE_SHM_NAME_LENGTH]; /* NUL-terminated, shown in the GUI */
+    uint8_t reserved0[16];
+
+    /* Written by the producer (own cache line) */
+    uint64_t write_index;               /* samples published per channel */
+    uint64_t dropped_samples;           /* samples discarded while the consumer was behind */
+    uint8_t reserved1[48];
+
+    /* Written by the consumer (own cache line) */
+    uint64_t read_index;                /* samples consumed per channel */
+    uint32_t consumer_attached;         /* non-zero while the GUI is acquiring from the ring */
+    uint32_t reserved2;
+    uint8_t reserved3[48];
+
+} oe_shm_header;
+
+#ifdef __cplusplus
+static_assert (sizeof (oe_shm_header) == OE_SHM_HEADER_SIZE, "unexpected oe_shm_header size");
+#else
+_Static_assert (sizeof (oe_shm_header) == OE_SHM_HEADER_SIZE, "unexpected oe_shm_header size");
+#endif
+
+/* Rounds a byte offset up to OE_SHM_ALIGNMENT */
+static inline uint64_t oe_shm_align (uint64_t offset)
+{
+    return (offset + OE_SHM_ALIGNMENT - 1) & ~(uint64_t) (OE_SHM_ALIGNMENT - 1);
+}
+
+/* Returns the size of a segment holding the given number of channels and slots */
+static inline uint64_t oe_shm_segment_size (uint32_t num_channels, uint32_t capacity)
+{
+    uint64_t data = oe_shm_align (OE_SHM_HEADER_SIZE);
+    uint64_t ttl = oe_shm_align (data + (uint64_t) num_channels * capacity * sizeof (float));
+
+    return ttl + (uint64_t) capacity * sizeof (uint64_t);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* OE_SHM_RING_H_INCLUDED */
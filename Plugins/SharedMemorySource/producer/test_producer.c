@@ -0,0 +1,166 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+/*
+    Test producer for the Shared Memory Source plugin.
+
+    Writes sine waves (a different frequency on each channel) and TTL square waves
+    into a ring at the requested sample rate, and prints the achieved rate and the
+    number of dropped samples every second.
+
+    Usage: oe_shm_test_producer [name] [channels] [sample_rate] [block_size] [--fast]
+
+    With --fast, blocks are written as fast as the GUI reads them, to measure the
+    hand-off bandwidth.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "oe_shm_producer.h"
+
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static volatile sig_atomic_t running = 1;
+
+static void stop (int signal)
+{
+    (void) signal;
+    running = 0;
+}
+
+static double seconds_since (const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (double) (now.tv_sec - start->tv_sec) + 1e-9 * (double) (now.tv_nsec - start->tv_nsec);
+}
+
+int main (int argc, char** argv)
+{
+    const char* name = argc > 1 ? argv[1] : "/oe_shm_test";
+    uint32_t num_channels = argc > 2 ? (uint32_t) atoi (argv[2]) : 64;
+    double sample_rate = argc > 3 ? atof (argv[3]) : 30000.0;
+    uint32_t block_size = argc > 4 ? (uint32_t) atoi (argv[4]) : 300;
+    int fast = argc > 5 && strcmp (argv[5], "--fast") == 0;
+
+    if (num_channels == 0 || sample_rate <= 0.0 || block_size == 0)
+    {
+        fprintf (stderr, "usage: %s [name] [channels] [sample_rate] [block_size] [--fast]\n", argv[0]);
+        return 1;
+    }
+
+    /* one second of data */
+    uint32_t capacity = (uint32_t) sample_rate > block_size * 4 ? (uint32_t) sample_rate : block_size * 4;
+
+    oe_shm_producer* producer = oe_shm_create (name, num_channels, capacity, sample_rate, 1.0f, 8, "test_producer");
+
+    if (producer == NULL)
+    {
+        perror ("oe_shm_create");
+        return 1;
+    }
+
+    signal (SIGINT, stop);
+    signal (SIGTERM, stop);
+
+    float* block = (float*) malloc ((size_t) num_channels * block_size * sizeof (float));
+    uint64_t* ttl = (uint64_t*) malloc (block_size * sizeof (uint64_t));
+
+    printf ("Writing %u channels at %.0f Hz to %s (Ctrl+C to stop)\n", num_channels, sample_rate, name);
+
+    struct timespec start, report;
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    report = start;
+
+    uint64_t sample = 0;
+    uint64_t reported = 0;
+    const double two_pi = 6.283185307179586;
+
+    while (running)
+    {
+        if (fast)
+        {
+            if (oe_shm_writable (producer) < block_size)
+                continue;
+        }
+        else
+        {
+            /* sleep until the block is due */
+            double due = (double) (sample + block_size) / sample_rate - seconds_since (&start);
+
+            if (due > 0)
+            {
+                struct timespec delay = { (time_t) due, (long) ((due - (double) (time_t) due) * 1e9) };
+                nanosleep (&delay, NULL);
+            }
+        }
+
+        for (uint32_t c = 0; c < num_channels; c++)
+        {
+            double frequency = 1.0 + (double) (c % 32);
+
+            for (uint32_t i = 0; i < block_size; i++)
+                block[c * block_size + i] = (float) (100.0 * sin (two_pi * frequency * (double) (sample + i) / sample_rate));
+        }
+
+        /* line k toggles every 2^k * 100 ms */
+        for (uint32_t i = 0; i < block_size; i++)
+        {
+            uint64_t tenths = (uint64_t) ((double) (sample + i) * 10.0 / sample_rate);
+            uint64_t word = 0;
+
+            for (int line = 0; line < 8; line++)
+                word |= ((tenths >> line) & 1) << line;
+
+            ttl[i] = word;
+        }
+
+        oe_shm_write (producer, block, block_size, ttl, block_size);
+        sample += block_size;
+
+        if (seconds_since (&report) >= 1.0)
+        {
+            double elapsed = seconds_since (&report);
+
+            printf ("%.0f samples/s (%.1f MB/s), %llu dropped\n",
+                    (double) (sample - reported) / elapsed,
+                    (double) (sample - reported) * num_channels * sizeof (float) / elapsed / 1e6,
+                    (unsigned long long) oe_shm_get_header (producer)->dropped_samples);
+
+            clock_gettime (CLOCK_MONOTONIC, &report);
+            reported = sample;
+        }
+    }
+
+    free (block);
+    free (ttl);
+    oe_shm_destroy (producer);
+
+    return 0;
+}
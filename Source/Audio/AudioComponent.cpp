@@ -23,6 +23,7 @@
 
 
 #include "AudioComponent.h"
+#include "InternalClock.h"
 #include "../AccessClass.h"
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
 #include <stdio.h>
@@ -32,6 +33,10 @@
 
 AudioComponent::AudioComponent() : isPlaying(false)
 {
+    // the internal clock goes after the audio card types, so it's only the default when there's no audio card
+    deviceManager.getAvailableDeviceTypes();
+    deviceManager.addAudioDeviceType(std::make_unique<InternalClockDeviceType>());
+
     bool initialized = false;
     while (!initialized)
     {
@@ -43,6 +48,16 @@ AudioComponent::AudioComponent() : isPlaying(false)
             String(), // preferred device
             0); // preferred device setup options
 
+        if (error.isNotEmpty() || deviceManager.getCurrentAudioDevice() == nullptr)
+        {
+            LOGC("Audio device unavailable (", error, "), using the internal clock");
+
+            deviceManager.setCurrentAudioDeviceType(INTERNAL_CLOCK_NAME, true);
+
+            if (deviceManager.getCurrentAudioDevice() != nullptr)
+                error = String();
+        }
+
         if (error == String())
         {
             initialized = true;
@@ -139,6 +154,70 @@ int AudioComponent::getBufferSizeMs()
     return int(float(setup.bufferSize)/setup.sampleRate*1000);
 }
 
+double AudioComponent::getSampleRate()
+{
+    AudioDeviceManager::AudioDeviceSetup setup;
+    deviceManager.getAudioDeviceSetup(setup);
+
+    return setup.sampleRate;
+}
+
+String AudioComponent::getDeviceType()
+{
+    return deviceManager.getCurrentAudioDeviceType();
+}
+
+bool AudioComponent::isUsingInternalClock()
+{
+    return getDeviceType() == INTERNAL_CLOCK_NAME;
+}
+
+String AudioComponent::setDevice(const String& deviceType, double sampleRate, int bufferSize, double bufferDurationUs)
+{
+    if (isPlaying)
+        return "Cannot change the audio device while acquisition is active";
+
+    if (deviceType.isNotEmpty() && deviceType != getDeviceType())
+    {
+        bool found = false;
+
+        for (auto* type : deviceManager.getAvailableDeviceTypes())
+            found = found || type->getTypeName() == deviceType;
+
+        if (!found)
+            return "Unknown device type: " + deviceType;
+
+        deviceManager.setCurrentAudioDeviceType(deviceType, true);
+
+        if (deviceManager.getCurrentAudioDevice() == nullptr)
+            return "No " + deviceType + " device available";
+    }
+
+    AudioDeviceManager::AudioDeviceSetup setup;
+    deviceManager.getAudioDeviceSetup(setup);
+
+    if (sampleRate > 0)
+        setup.sampleRate = sampleRate;
+
+    if (bufferSize <= 0 && bufferDurationUs > 0)
+        bufferSize = jmax(1, roundToInt(bufferDurationUs * setup.sampleRate / 1.0e6));
+
+    if (bufferSize > 0)
+        setup.bufferSize = bufferSize;
+
+    String error = deviceManager.setAudioDeviceSetup(setup, true);
+
+    if (error.isEmpty())
+    {
+        LOGC("Audio device: ", getDeviceType(), ", ", getSampleRate(), " Hz, ", getBufferSize(), " samples per block");
+
+        if (ProcessorGraph* graph = AccessClass::getProcessorGraph())
+            graph->updateBufferSize();
+    }
+
+    return error;
+}
+
 void AudioComponent::connectToProcessorGraph(AudioProcessorGraph* processorGraph)
 {
 
@@ -31,7 +31,8 @@
   Interfaces with system audio hardware.
 
   Uses the audio card to generate the callbacks to run the ProcessorGraph
-  during data acquisition.
+  during data acquisition. On machines without an audio card (or when selected),
+  the InternalClockDevice drives the callbacks instead.
 
   Sends output to the audio card for audio monitoring.
 
@@ -87,6 +88,26 @@ public:
     /** Returns the buffer size (in ms) currently being used.*/
     int getBufferSizeMs();
 
+    /** Returns the sample rate of the device driving the callbacks.*/
+    double getSampleRate();
+
+    /** Returns the name of the current device type (e.g. "ALSA", or "Internal Clock").*/
+    String getDeviceType();
+
+    /** Returns true if the callbacks are driven by the internal clock rather than an audio device.*/
+    bool isUsingInternalClock();
+
+    /** Changes the device that drives the callbacks, while acquisition is stopped.
+
+        @param deviceType The device type to switch to (e.g. "Internal Clock"), or empty to keep the current one
+        @param sampleRate The new sample rate, or 0 to keep the current one
+        @param bufferSize The new block size in samples, or 0 to keep the current one
+        @param bufferDurationUs The new block size in microseconds, used if bufferSize is 0
+
+        @return An error message, or an empty string if the device was set up successfully
+    */
+    String setDevice(const String& deviceType, double sampleRate, int bufferSize, double bufferDurationUs = 0);
+
     /** Saves all audio settings that can be loaded to an XML element */
     void saveStateToXml(XmlElement* parent);
 
@@ -0,0 +1,297 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "InternalClock.h"
+#include "../Utils/Utils.h"
+
+#include <chrono>
+#include <thread>
+
+#define INTERNAL_CLOCK_OUTPUT_CHANNELS 2
+#define INTERNAL_CLOCK_DEFAULT_SAMPLE_RATE 44100.0
+#define INTERNAL_CLOCK_DEFAULT_BUFFER_SIZE 1024
+#define INTERNAL_CLOCK_MAX_BUFFER_SIZE 65536
+
+/** Number of blocks the clock can fall behind before its schedule is restarted */
+#define INTERNAL_CLOCK_MAX_LATE_BLOCKS 8
+
+/** Waits longer than this are done on the thread's event, so stop() can interrupt them */
+#define INTERNAL_CLOCK_COARSE_WAIT_MS 2
+
+InternalClockDevice::InternalClockDevice()
+    : AudioIODevice (INTERNAL_CLOCK_NAME, INTERNAL_CLOCK_NAME),
+      Thread ("Internal Clock"),
+      callback (nullptr),
+      sampleRate (INTERNAL_CLOCK_DEFAULT_SAMPLE_RATE),
+      bufferSize (INTERNAL_CLOCK_DEFAULT_BUFFER_SIZE),
+      deviceIsOpen (false),
+      deviceIsPlaying (false),
+      lateBlocks (0),
+      maxLatenessUs (0)
+{
+}
+
+InternalClockDevice::~InternalClockDevice()
+{
+    close();
+}
+
+StringArray InternalClockDevice::getOutputChannelNames()
+{
+    StringArray names;
+
+    for (int i = 0; i < INTERNAL_CLOCK_OUTPUT_CHANNELS; i++)
+        names.add ("Output " + String (i + 1));
+
+    return names;
+}
+
+StringArray InternalClockDevice::getInputChannelNames()
+{
+    return StringArray();
+}
+
+Array<double> InternalClockDevice::getAvailableSampleRates()
+{
+    return { 30000.0, 44100.0, 48000.0, 96000.0 };
+}
+
+Array<int> InternalClockDevice::getAvailableBufferSizes()
+{
+    return { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+}
+
+int InternalClockDevice::getDefaultBufferSize()
+{
+    return INTERNAL_CLOCK_DEFAULT_BUFFER_SIZE;
+}
+
+String InternalClockDevice::open (const BigInteger& inputChannels,
+                                  const BigInteger& outputChannels,
+                                  double sampleRate_,
+                                  int bufferSizeSamples)
+{
+    close();
+
+    sampleRate = sampleRate_ > 0 ? sampleRate_ : INTERNAL_CLOCK_DEFAULT_SAMPLE_RATE;
+    bufferSize = bufferSizeSamples > 0 ? jmin (bufferSizeSamples, INTERNAL_CLOCK_MAX_BUFFER_SIZE)
+                                       : INTERNAL_CLOCK_DEFAULT_BUFFER_SIZE;
+
+    activeOutputChannels = outputChannels;
+    activeOutputChannels.setRange (INTERNAL_CLOCK_OUTPUT_CHANNELS,
+                                   jmax (0, activeOutputChannels.getHighestBit() + 1 - INTERNAL_CLOCK_OUTPUT_CHANNELS),
+                                   false);
+
+    outputBuffer.setSize (activeOutputChannels.countNumberOfSetBits(), bufferSize);
+
+    deviceIsOpen = true;
+
+    return String();
+}
+
+void InternalClockDevice::close()
+{
+    stop();
+
+    deviceIsOpen = false;
+}
+
+bool InternalClockDevice::isOpen()
+{
+    return deviceIsOpen;
+}
+
+void InternalClockDevice::start (AudioIODeviceCallback* newCallback)
+{
+    if (!deviceIsOpen || newCallback == nullptr)
+        return;
+
+    stop();
+
+    newCallback->audioDeviceAboutToStart (this);
+    callback = newCallback;
+
+    lateBlocks = 0;
+    maxLatenessUs = 0;
+
+    LOGC("Internal clock: starting at ", sampleRate, " Hz, ", bufferSize, " samples per block (",
+         roundToInt (bufferSize * 1.0e6 / sampleRate), " us)");
+
+    deviceIsPlaying = true;
+
+    // priority 10 uses a real-time scheduling policy where the OS allows it
+    startThread (10);
+}
+
+void InternalClockDevice::stop()
+{
+    if (!deviceIsPlaying)
+        return;
+
+    signalThreadShouldExit();
+    notify();
+    stopThread (2000);
+
+    deviceIsPlaying = false;
+
+    if (lateBlocks > 0)
+        LOGC("Internal clock: ", lateBlocks, " late blocks, at most ", maxLatenessUs, " us late");
+
+    AudioIODeviceCallback* lastCallback = callback;
+    callback = nullptr;
+
+    lastCallback->audioDeviceStopped();
+}
+
+bool InternalClockDevice::isPlaying()
+{
+    return deviceIsPlaying;
+}
+
+String InternalClockDevice::getLastError()
+{
+    return String();
+}
+
+int InternalClockDevice::getCurrentBufferSizeSamples()
+{
+    return bufferSize;
+}
+
+double InternalClockDevice::getCurrentSampleRate()
+{
+    return sampleRate;
+}
+
+int InternalClockDevice::getCurrentBitDepth()
+{
+    return 32;
+}
+
+BigInteger InternalClockDevice::getActiveOutputChannels() const
+{
+    return activeOutputChannels;
+}
+
+BigInteger InternalClockDevice::getActiveInputChannels() const
+{
+    return BigInteger();
+}
+
+int InternalClockDevice::getOutputLatencyInSamples()
+{
+    return 0;
+}
+
+int InternalClockDevice::getInputLatencyInSamples()
+{
+    return 0;
+}
+
+void InternalClockDevice::run()
+{
+    using Clock = std::chrono::steady_clock;
+
+    const double blockNs = bufferSize * 1.0e9 / sampleRate;
+
+    Clock::time_point start = Clock::now();
+    int64 block = 0;
+
+    while (!threadShouldExit())
+    {
+        // deadlines are counted from the start, so rounding errors don't accumulate
+        const Clock::time_point deadline = start + std::chrono::nanoseconds ((int64) ((block + 1) * blockNs));
+
+        Clock::duration remaining = deadline - Clock::now();
+
+        if (remaining > std::chrono::milliseconds (INTERNAL_CLOCK_COARSE_WAIT_MS))
+        {
+            wait ((int) std::chrono::duration_cast<std::chrono::milliseconds> (remaining).count() - 1);
+
+            if (threadShouldExit())
+                break;
+        }
+
+        std::this_thread::sleep_until (deadline);
+
+        outputBuffer.clear();
+
+        callback->audioDeviceIOCallback (nullptr,
+                                         0,
+                                         outputBuffer.getArrayOfWritePointers(),
+                                         outputBuffer.getNumChannels(),
+                                         bufferSize);
+
+        block++;
+
+        const int64 latenessUs = std::chrono::duration_cast<std::chrono::microseconds> (Clock::now() - deadline).count();
+
+        if (latenessUs * 1000 > blockNs)
+        {
+            lateBlocks++;
+            maxLatenessUs = jmax (maxLatenessUs, latenessUs);
+
+            if (latenessUs * 1000 > INTERNAL_CLOCK_MAX_LATE_BLOCKS * blockNs)
+            {
+                // too far behind to catch up; start a new schedule from now
+                start = Clock::now();
+                block = 0;
+            }
+        }
+    }
+}
+
+InternalClockDeviceType::InternalClockDeviceType()
+    : AudioIODeviceType (INTERNAL_CLOCK_NAME)
+{
+}
+
+StringArray InternalClockDeviceType::getDeviceNames (bool wantInputNames) const
+{
+    if (wantInputNames)
+        return StringArray();
+
+    return StringArray (INTERNAL_CLOCK_NAME);
+}
+
+int InternalClockDeviceType::getDefaultDeviceIndex (bool forInput) const
+{
+    return forInput ? -1 : 0;
+}
+
+int InternalClockDeviceType::getIndexOfDevice (AudioIODevice* device, bool asInput) const
+{
+    if (asInput)
+        return -1;
+
+    return dynamic_cast<InternalClockDevice*> (device) != nullptr ? 0 : -1;
+}
+
+AudioIODevice* InternalClockDeviceType::createDevice (const String& outputDeviceName,
+                                                      const String& inputDeviceName)
+{
+    if (outputDeviceName == INTERNAL_CLOCK_NAME || (outputDeviceName.isEmpty() && inputDeviceName.isEmpty()))
+        return new InternalClockDevice();
+
+    return nullptr;
+}
@@ -0,0 +1,145 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __INTERNALCLOCK_H_3F1A9C2E__
+#define __INTERNALCLOCK_H_3F1A9C2E__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+/** Name of both the device type and the single device it provides */
+#define INTERNAL_CLOCK_NAME "Internal Clock"
+
+/**
+
+  An audio device that has no hardware behind it.
+
+  Runs the AudioIODeviceCallback (i.e., the ProcessorGraph) from a dedicated
+  high-priority thread, once per block of samples at the selected sample rate.
+  Deadlines are computed from the number of blocks since the clock started,
+  so timing errors don't accumulate. If the graph falls behind, late blocks are
+  run back-to-back until the clock has caught up; after more than
+  INTERNAL_CLOCK_MAX_LATE_BLOCKS, the schedule is restarted instead.
+
+  Any block size is accepted, which makes it possible to run the GUI on machines
+  without a sound card, with a block cadence that doesn't depend on one.
+
+  @see AudioComponent, InternalClockDeviceType
+
+*/
+
+class InternalClockDevice : public AudioIODevice,
+                            private Thread
+{
+public:
+
+    /** Constructor */
+    InternalClockDevice();
+
+    /** Destructor */
+    ~InternalClockDevice();
+
+    StringArray getOutputChannelNames() override;
+    StringArray getInputChannelNames() override;
+
+    Array<double> getAvailableSampleRates() override;
+    Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override;
+
+    String open (const BigInteger& inputChannels,
+                 const BigInteger& outputChannels,
+                 double sampleRate,
+                 int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override;
+
+    void start (AudioIODeviceCallback* callback) override;
+    void stop() override;
+    bool isPlaying() override;
+
+    String getLastError() override;
+
+    int getCurrentBufferSizeSamples() override;
+    double getCurrentSampleRate() override;
+    int getCurrentBitDepth() override;
+
+    BigInteger getActiveOutputChannels() const override;
+    BigInteger getActiveInputChannels() const override;
+
+    int getOutputLatencyInSamples() override;
+    int getInputLatencyInSamples() override;
+
+private:
+
+    /** Calls the callback once per block until the thread is stopped */
+    void run() override;
+
+    AudioIODeviceCallback* callback;
+
+    AudioBuffer<float> outputBuffer;
+    BigInteger activeOutputChannels;
+
+    double sampleRate;
+    int bufferSize;
+
+    bool deviceIsOpen;
+    bool deviceIsPlaying;
+
+    int64 lateBlocks;
+    int64 maxLatenessUs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InternalClockDevice);
+};
+
+/**
+
+  Makes the InternalClockDevice available to the AudioDeviceManager,
+  alongside the device types of the sound cards.
+
+*/
+
+class InternalClockDeviceType : public AudioIODeviceType
+{
+public:
+
+    /** Constructor */
+    InternalClockDeviceType();
+
+    void scanForDevices() override { }
+
+    StringArray getDeviceNames (bool wantInputNames = false) const override;
+
+    int getDefaultDeviceIndex (bool forInput) const override;
+
+    int getIndexOfDevice (AudioIODevice* device, bool asInput) const override;
+
+    bool hasSeparateInputsAndOutputs() const override { return false; }
+
+    AudioIODevice* createDevice (const String& outputDeviceName,
+                                 const String& inputDeviceName) override;
+
+private:
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InternalClockDeviceType);
+};
+
+#endif
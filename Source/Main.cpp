@@ -27,6 +27,9 @@
 #endif
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainWindow.h"
+#include "AccessClass.h"
+#include "Audio/AudioComponent.h"
+#include "Audio/InternalClock.h"
 #include "UI/LookAndFeel/CustomLookAndFeel.h"
 
 #include <stdio.h>
@@ -39,6 +42,12 @@
   The OpenEphysApplication class own the application's MainWindow (via
   a ScopedPointer).
 
+  Command line: open-ephys [signal chain file] [options], where options are:
+  --internal-clock               drive acquisition from the internal clock instead of the audio device
+  --sample-rate=<Hz>             sample rate of the device driving acquisition
+  --block-size=<samples>         number of samples processed per block
+  --block-duration=<us>          duration of each block in microseconds (if --block-size isn't given)
+
   @see MainWindow
 
 */
@@ -60,6 +69,17 @@ public:
         parameters.addTokens(commandLine, " ", "\"");
         parameters.removeEmptyStrings();
 
+        StringArray options;
+
+        for (int i = parameters.size() - 1; i >= 0; i--)
+        {
+            if (parameters[i].startsWith("--"))
+            {
+                options.insert(0, parameters[i]);
+                parameters.remove(i);
+            }
+        }
+
 #ifdef _WIN32
 
         if (AllocConsole())
@@ -94,6 +114,41 @@ public:
         {
             mainWindow = std::make_unique<MainWindow>();
         }
+
+        // command line options take precedence over the audio settings of the loaded signal chain
+        applyDeviceOptions(options);
+    }
+
+    void applyDeviceOptions(const StringArray& options)
+    {
+        String deviceType;
+        double sampleRate = 0;
+        int blockSize = 0;
+        double blockDurationUs = 0;
+
+        for (auto& option : options)
+        {
+            String value = option.fromFirstOccurrenceOf("=", false, false);
+
+            if (option == "--internal-clock")
+                deviceType = INTERNAL_CLOCK_NAME;
+            else if (option.startsWith("--sample-rate="))
+                sampleRate = value.getDoubleValue();
+            else if (option.startsWith("--block-size="))
+                blockSize = value.getIntValue();
+            else if (option.startsWith("--block-duration="))
+                blockDurationUs = value.getDoubleValue();
+            else
+                LOGE("Unknown command line option: ", option);
+        }
+
+        if (deviceType.isEmpty() && sampleRate <= 0 && blockSize <= 0 && blockDurationUs <= 0)
+            return;
+
+        String error = AccessClass::getAudioComponent()->setDevice(deviceType, sampleRate, blockSize, blockDurationUs);
+
+        if (error.isNotEmpty())
+            LOGE("Unable to apply command line device options: ", error);
     }
 
     void shutdown() { }
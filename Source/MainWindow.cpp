@@ -180,6 +180,10 @@ MainWindow::~MainWindow()
 	saveWindowBounds();
 
 	audioComponent->disconnectProcessorGraph();
+
+	// the shared worker threads would otherwise outlive the message thread
+	GenericProcessor::setParallelStreamProcessingEnabled(false);
+
 	UIComponent* ui = (UIComponent*) getContentComponent();
 	ui->disableDataViewport();
 	
@@ -274,6 +278,8 @@ void MainWindow::saveWindowBounds()
 	xml->setAttribute("shouldReloadOnStartup", shouldReloadOnStartup);
 	xml->setAttribute("shouldEnableHttpServer", shouldEnableHttpServer);
 	xml->setAttribute("automaticVersionChecking", automaticVersionChecking);
+	xml->setAttribute("parallelRendering", processorGraph->isParallelRenderingEnabled());
+	xml->setAttribute("parallelStreamProcessing", GenericProcessor::isParallelStreamProcessingEnabled());
 
 	XmlElement* bounds = new XmlElement("BOUNDS");
 	bounds->setAttribute("x",getScreenX());
@@ -338,6 +344,8 @@ void MainWindow::loadWindowBounds()
 		shouldReloadOnStartup = xml->getBoolAttribute("shouldReloadOnStartup", false);
 		shouldEnableHttpServer = xml->getBoolAttribute("shouldEnableHttpServer", false);
 		automaticVersionChecking = xml->getBoolAttribute("automaticVersionChecking", true);
+		processorGraph->setParallelRendering(xml->getBoolAttribute("parallelRendering", false));
+		GenericProcessor::setParallelStreamProcessingEnabled(xml->getBoolAttribute("parallelStreamProcessing", false));
 
 		for (auto* e : xml->getChildIterator())
 		{
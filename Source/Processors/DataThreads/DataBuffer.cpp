@@ -22,16 +22,114 @@
 
 #include "DataBuffer.h"
 
+#if JUCE_USE_SSE_INTRINSICS
+ #include <immintrin.h>
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+ #include <arm_neon.h>
+#endif
+
+/* Frames deinterleaved per tile; the source rows of a tile stay in cache while every channel is copied out */
+#define DEINTERLEAVE_TILE_FRAMES 64
+
+/* Maximum number of writes whose metadata can be waiting to be read */
+#define MAX_METADATA_RECORDS 1024
+
+#if JUCE_USE_SSE_INTRINSICS
+
+/* Transposes 4 frames x 4 channels into 4 channel pointers */
+static inline void transpose4x4(const float* src, int srcStride, float* const* dest, int destOffset)
+{
+    __m128 r0 = _mm_loadu_ps(src);
+    __m128 r1 = _mm_loadu_ps(src + srcStride);
+    __m128 r2 = _mm_loadu_ps(src + 2 * srcStride);
+    __m128 r3 = _mm_loadu_ps(src + 3 * srcStride);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(dest[0] + destOffset, r0);
+    _mm_storeu_ps(dest[1] + destOffset, r1);
+    _mm_storeu_ps(dest[2] + destOffset, r2);
+    _mm_storeu_ps(dest[3] + destOffset, r3);
+}
+
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+
+static inline void transpose4x4(const float* src, int srcStride, float* const* dest, int destOffset)
+{
+    float32x4_t r0 = vld1q_f32(src);
+    float32x4_t r1 = vld1q_f32(src + srcStride);
+    float32x4_t r2 = vld1q_f32(src + 2 * srcStride);
+    float32x4_t r3 = vld1q_f32(src + 3 * srcStride);
+
+    float32x4_t t0 = vtrn1q_f32(r0, r1);
+    float32x4_t t1 = vtrn2q_f32(r0, r1);
+    float32x4_t t2 = vtrn1q_f32(r2, r3);
+    float32x4_t t3 = vtrn2q_f32(r2, r3);
+
+    vst1q_f32(dest[0] + destOffset, vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2))));
+    vst1q_f32(dest[1] + destOffset, vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3))));
+    vst1q_f32(dest[2] + destOffset, vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2))));
+    vst1q_f32(dest[3] + destOffset, vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3))));
+}
+
+#else
+
+static inline void transpose4x4(const float* src, int srcStride, float* const* dest, int destOffset)
+{
+    for (int frame = 0; frame < 4; frame++)
+        for (int chan = 0; chan < 4; chan++)
+            dest[chan][destOffset + frame] = src[frame * srcStride + chan];
+}
+
+#endif
+
+/* Copies numFrames interleaved frames of numChans channels into per-channel arrays, starting at destOffset */
+static void deinterleave(const float* src, int numChans, int numFrames, float* const* dest, int destOffset)
+{
+    for (int firstFrame = 0; firstFrame < numFrames; firstFrame += DEINTERLEAVE_TILE_FRAMES)
+    {
+        const int tileFrames = jmin(DEINTERLEAVE_TILE_FRAMES, numFrames - firstFrame);
+        const int vectorFrames = tileFrames & ~3;
+        const float* tile = src + (size_t) firstFrame * numChans;
+
+        int chan = 0;
+
+        for (; chan + 4 <= numChans; chan += 4)
+        {
+            for (int frame = 0; frame < vectorFrames; frame += 4)
+                transpose4x4(tile + frame * numChans + chan, numChans, dest + chan, destOffset + firstFrame + frame);
+
+            for (int frame = vectorFrames; frame < tileFrames; frame++)
+                for (int k = 0; k < 4; k++)
+                    dest[chan + k][destOffset + firstFrame + frame] = tile[frame * numChans + chan + k];
+        }
+
+        for (; chan < numChans; chan++)
+        {
+            float* out = dest[chan] + destOffset + firstFrame;
+
+            for (int frame = 0; frame < tileFrames; frame++)
+                out[frame] = tile[frame * numChans + chan];
+        }
+    }
+}
+
 
 DataBuffer::DataBuffer (int chans, int size)
     : abstractFifo  (size)
     , buffer        (chans, size)
+    , metadataWritten (0)
+    , metadataRead  (0)
+    , metadataDropped (0)
+    , samplesWritten (0)
+    , samplesRead   (0)
     , numChans      (chans)
 {
-    sampleNumberBuffer.malloc (size);
-    timestampBuffer.malloc (size);
     eventCodeBuffer.malloc (size);
 
+    metadataCapacity = jmin (size, MAX_METADATA_RECORDS);
+    metadataBuffer.malloc (metadataCapacity);
+
 	lastSampleNumber = 0;
     lastTimestamp = -1.0;
 }
@@ -41,9 +139,17 @@ void DataBuffer::clear()
 {
     buffer.clear();
     abstractFifo.reset();
+
+    metadataWritten = 0;
+    metadataRead = 0;
+    metadataDropped = 0;
+    samplesWritten = 0;
+    samplesRead = 0;
     
     lastSampleNumber = 0;
     lastTimestamp = -1.0;
+
+    spaceNotifier.notify();
 }
 
 
@@ -51,16 +157,126 @@ void DataBuffer::resize (int chans, int size)
 {
     buffer.setSize (chans, size);
 
-    sampleNumberBuffer.malloc (size);
-    timestampBuffer.malloc (size);
     eventCodeBuffer.malloc (size);
 
+    metadataCapacity = jmin (size, MAX_METADATA_RECORDS);
+    metadataBuffer.malloc (metadataCapacity);
+
+    metadataWritten = 0;
+    metadataRead = 0;
+    metadataDropped = 0;
+    samplesWritten = 0;
+    samplesRead = 0;
+
     lastSampleNumber = 0;
     lastTimestamp = -1.0;
 
     numChans = chans;
 }
 
+
+void DataBuffer::addBlockMetadata (int64 sampleNumber, double timestamp)
+{
+    const int64 written = metadataWritten.load (std::memory_order_relaxed);
+
+    double timestampStep = 0.0;
+
+    if (written > 0)
+    {
+        const BlockMetadata& previous = metadataBuffer[(written - 1) % metadataCapacity];
+
+        // the newest record can't be interpolated, so keep the rate seen between the last two writes
+        if (sampleNumber > previous.sampleNumber)
+            timestampStep = (timestamp - previous.timestamp) / double (sampleNumber - previous.sampleNumber);
+        else
+            timestampStep = previous.timestampStep;
+
+        // a write that continues the previous one on the same line needs no record of its own
+        const int64 offset = samplesWritten - previous.firstSample;
+
+        if (sampleNumber == previous.sampleNumber + offset
+            && std::abs (timestamp - (previous.timestamp + previous.timestampStep * double (offset))) < 1e-9)
+            return;
+    }
+
+    // when the reader is far behind, later samples are extrapolated from the newest record instead
+    if (written - metadataRead.load (std::memory_order_acquire) >= metadataCapacity)
+    {
+        metadataDropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    BlockMetadata& record = metadataBuffer[written % metadataCapacity];
+
+    record.firstSample = samplesWritten;
+    record.sampleNumber = sampleNumber;
+    record.timestamp = timestamp;
+    record.timestampStep = timestampStep;
+
+    metadataWritten.store (written + 1, std::memory_order_release);
+}
+
+
+int64 DataBuffer::getNumDroppedMetadataRecords() const
+{
+    return metadataDropped.load (std::memory_order_relaxed);
+}
+
+
+void DataBuffer::getBlockMetadata (int64& sampleNumber, double& timestamp)
+{
+    const int64 written = metadataWritten.load (std::memory_order_acquire);
+    int64 read = metadataRead.load (std::memory_order_relaxed);
+
+    // retire the records that end before the next sample to be read
+    while (read + 1 < written && metadataBuffer[(read + 1) % metadataCapacity].firstSample <= samplesRead)
+        read++;
+
+    metadataRead.store (read, std::memory_order_release);
+
+    const BlockMetadata& record = metadataBuffer[read % metadataCapacity];
+    const int64 offset = samplesRead - record.firstSample;
+
+    sampleNumber = record.sampleNumber + offset;
+
+    const BlockMetadata* next = read + 1 < written ? &metadataBuffer[(read + 1) % metadataCapacity] : nullptr;
+
+    if (next != nullptr && next->sampleNumber > record.sampleNumber)
+    {
+        timestamp = record.timestamp + (next->timestamp - record.timestamp) * double (offset) / double (next->sampleNumber - record.sampleNumber);
+    }
+    else
+    {
+        timestamp = record.timestamp + record.timestampStep * double (offset);
+    }
+}
+
+int DataBuffer::reserveWrite (int numItems, WriteReservation& reservation)
+{
+    abstractFifo.prepareToWrite (numItems,
+                                 reservation.startIndex[0], reservation.numSamples[0],
+                                 reservation.startIndex[1], reservation.numSamples[1]);
+
+    reservation.channels = buffer.getArrayOfWritePointers();
+    reservation.eventCodes = eventCodeBuffer;
+
+    return reservation.getNumSamples();
+}
+
+
+void DataBuffer::commitWrite (int numItems, int64 sampleNumber, double timestamp)
+{
+    if (numItems <= 0)
+        return;
+
+    addBlockMetadata (sampleNumber, timestamp);
+
+    samplesWritten += numItems;
+
+    abstractFifo.finishedWrite (numItems);
+}
+
+
 int DataBuffer::addToBuffer (float* data,
                              int64* sampleNumbers,
                              double* timestamps,
@@ -68,39 +284,64 @@ int DataBuffer::addToBuffer (float* data,
                              int numItems,
                              int chunkSize)
 {
-    int startIndex1, blockSize1, startIndex2, blockSize2;
+    WriteReservation reservation;
 
-    abstractFifo.prepareToWrite (numItems, startIndex1, blockSize1, startIndex2, blockSize2);
+    reserveWrite (numItems, reservation);
 
-    int bs[3] = { blockSize1, blockSize2, 0 };
-    int si[2] = { startIndex1, startIndex2 };
-    int cSize = 0;
     int idx = 0;
-    int blkIdx;
-        
-    for (int i = 0; bs[i] != 0; ++i)
+
+    for (int segment = 0; segment < 2; ++segment)
     {                                // for each of the dest blocks we can write to...
-        blkIdx = 0;
-        for (int j = 0; j < bs[i]; j+= chunkSize) 
-        {                     // for each chunk...
-            cSize = chunkSize <= bs[i] - j ? chunkSize : bs[i] - j;     // figure our how much you can write
-            for (int chan = 0; chan < numChans; ++chan)         // write that much, per channel
-            {
-                buffer.copyFrom (chan,                           // (int destChannel)
-                                 si[i] + j,                      // (int destStartSample)
-                                 data + (idx * numChans) + chan, // (const float* source)
-                                 cSize);                         // (int num samples)
+        const int segmentSize = reservation.numSamples[segment];
+
+        if (segmentSize == 0)
+            break;
+
+        if (chunkSize == 1)
+        {
+            // interleaved frames: transpose the whole segment
+            deinterleave (data + (size_t) idx * numChans, numChans, segmentSize,
+                          reservation.channels, reservation.startIndex[segment]);
+        }
+        else
+        {
+            int cSize;
+
+            for (int j = 0; j < segmentSize; j += cSize)
+            {                     // for each chunk...
+                cSize = jmin (chunkSize, segmentSize - j);     // figure our how much you can write
+
+                for (int chan = 0; chan < numChans; ++chan)         // write that much, per channel
+                {
+                    FloatVectorOperations::copy (reservation.getChannelPointer (chan, segment) + j,
+                                                 data + ((idx + j) * numChans) + chan,
+                                                 cSize);
+                }
             }
+        }
+
+        memcpy (reservation.getEventCodePointer (segment), eventCodes + idx, segmentSize * sizeof (uint64));
+
+        idx += segmentSize;
+    }
 
-            for (int k = 0; k < cSize; ++k)
+    // only the first sample of each contiguous run of sample numbers needs a record
+    if (idx > 0)
+    {
+        int runStart = 0;
+
+        for (int i = 1; i < idx; ++i)
+        {
+            if (sampleNumbers[i] != sampleNumbers[i - 1] + 1)
             {
-                sampleNumberBuffer[si[i] + blkIdx + k] = sampleNumbers[idx + k];
-                timestampBuffer[si[i] + blkIdx + k] = timestamps[idx + k];
-                eventCodeBuffer[si[i] + blkIdx + k] = eventCodes[idx + k];
+                addBlockMetadata (sampleNumbers[runStart], timestamps[runStart]);
+                samplesWritten += i - runStart;
+                runStart = i;
             }
-            idx     += cSize;
-            blkIdx  += cSize;
         }
+
+        addBlockMetadata (sampleNumbers[runStart], timestamps[runStart]);
+        samplesWritten += idx - runStart;
     }
 
     // finish write
@@ -113,6 +354,17 @@ int DataBuffer::addToBuffer (float* data,
 int DataBuffer::getNumSamples() const { return abstractFifo.getNumReady(); }
 
 
+int DataBuffer::getNumFree() const { return abstractFifo.getFreeSpace(); }
+
+
+bool DataBuffer::waitForSpace (int numItems, int timeoutMs)
+{
+    const int needed = jmin (numItems, abstractFifo.getTotalSize() - 1);
+
+    return spaceNotifier.waitUntil ([this, needed] { return abstractFifo.getFreeSpace() >= needed; }, timeoutMs);
+}
+
+
 int DataBuffer::readAllFromBuffer (AudioBuffer<float>& data,
                                    int64* blockSampleNumber,
                                    double* blockTimestamp,
@@ -142,8 +394,7 @@ int DataBuffer::readAllFromBuffer (AudioBuffer<float>& data,
                            blockSize1);     // numSamples
         }
 
-        memcpy (blockSampleNumber, sampleNumberBuffer + startIndex1, 8);
-        memcpy (blockTimestamp, timestampBuffer + startIndex1, 8);
+        getBlockMetadata (*blockSampleNumber, *blockTimestamp);
         memcpy (eventCodes, eventCodeBuffer + startIndex1, blockSize1 * 8);
     }
     else
@@ -178,7 +429,12 @@ int DataBuffer::readAllFromBuffer (AudioBuffer<float>& data,
        // std::cout << "Updating last sample number: " << lastSampleNumber << std::endl;
     }
 
+    samplesRead += numItems;
+
     abstractFifo.finishedRead (numItems);
 
+    if (numItems > 0)
+        spaceNotifier.notify();
+
     return numItems;
 }
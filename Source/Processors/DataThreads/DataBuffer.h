@@ -25,6 +25,7 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../PluginManager/OpenEphysPlugin.h"
+#include "../../Utils/FillLevelNotifier.h"
 
 
 /**
@@ -42,6 +43,31 @@ public:
     /** Destructor */
     ~DataBuffer() { }
 
+    /** Space reserved in the buffer by reserveWrite().
+
+        The reserved samples are split into at most two contiguous segments of the ring
+        (the second one is used when the write wraps around). A DataThread can decode
+        samples directly into these segments and then make them visible with commitWrite(),
+        instead of filling its own arrays and copying them with addToBuffer().
+    */
+    struct WriteReservation
+    {
+        int startIndex[2] = { 0, 0 };
+        int numSamples[2] = { 0, 0 };
+
+        float* const* channels = nullptr;
+        uint64* eventCodes = nullptr;
+
+        /** Returns the total number of samples reserved */
+        int getNumSamples() const { return numSamples[0] + numSamples[1]; }
+
+        /** Returns where a channel's samples go in one segment (0 or 1) */
+        float* getChannelPointer (int channel, int segment) const { return channels[channel] + startIndex[segment]; }
+
+        /** Returns where the per-sample event codes go in one segment */
+        uint64* getEventCodePointer (int segment) const { return eventCodes + startIndex[segment]; }
+    };
+
     /** Clears the buffer.*/
     void clear();
 
@@ -49,7 +75,9 @@ public:
 
         @param data The data.
         @param sampleNumbers  Array of sample numbers (integers). Same length as numItems.
+        Only the first sample number of each contiguous run is stored.
         @param timestamps  Array of timestamps (in seconds) (double). Same length as numItems.
+        Only the timestamp of the first sample of each contiguous run is stored.
         @param eventCodes Array of event codes. Same length as numItems.
         @param numItems Total number of samples per channel.
         @param chunkSize Number of consecutive samples per channel per chunk.
@@ -65,9 +93,38 @@ public:
                      int numItems,
                      int chunkSize=1);
 
+    /** Reserves space for up to numItems samples per channel.
+
+        @return The number of samples actually reserved. May be less than numItems if
+        the buffer doesn't have space. Nothing is visible to the reader until commitWrite()
+        is called, and only one reservation can be outstanding at a time.
+    */
+    int reserveWrite (int numItems, WriteReservation& reservation);
+
+    /** Makes the first numItems samples of the last reservation available to the reader.
+        numItems must not exceed the number of samples reserved.
+
+        @param sampleNumber The sample number of the first committed sample; the others
+        are assumed to follow on contiguously.
+        @param timestamp The timestamp (in seconds) of the first committed sample; timestamps
+        of later samples are interpolated.
+    */
+    void commitWrite (int numItems, int64 sampleNumber, double timestamp);
+
     /** Returns the number of samples currently available in the buffer.*/
     int getNumSamples() const;
 
+    /** Returns the number of samples that can currently be written to the buffer.*/
+    int getNumFree() const;
+
+    /** Blocks the writing thread until there is space for numItems samples, the thread
+        is asked to exit, or timeoutMs milliseconds have passed. Wakes as soon as the
+        reader frees enough space.
+
+        @return true if there is space for numItems samples.
+    */
+    bool waitForSpace (int numItems, int timeoutMs);
+
     /** Copies as many samples as possible from the DataBuffer to an AudioBuffer.*/
     int readAllFromBuffer (AudioBuffer<float>& data,
                            int64* sampleNumbers,
@@ -80,20 +137,50 @@ public:
     /** Resizes the data buffer */
     void resize (int chans, int size);
 
+    /** Returns the number of writes whose sample number and timestamp couldn't be stored
+        because the reader was too far behind, since the last clear() or resize().
+        Timestamps of those samples are extrapolated from the previous write. */
+    int64 getNumDroppedMetadataRecords() const;
+
 
 private:
+
+    /** Sample number and timestamp of the first sample of one write */
+    struct BlockMetadata
+    {
+        int64 firstSample;      // position in the stream of samples written to this buffer
+        int64 sampleNumber;
+        double timestamp;
+        double timestampStep;   // seconds per sample, used past the newest record
+    };
+
+    /** Adds a record for a write starting at the current write position */
+    void addBlockMetadata (int64 sampleNumber, double timestamp);
+
+    /** Computes the sample number and timestamp of the next sample to be read */
+    void getBlockMetadata (int64& sampleNumber, double& timestamp);
+
     AbstractFifo abstractFifo;
     AudioBuffer<float> buffer;
 
-    HeapBlock<int64> sampleNumberBuffer;
-    HeapBlock<double> timestampBuffer;
     HeapBlock<uint64> eventCodeBuffer;
 
+    HeapBlock<BlockMetadata> metadataBuffer;
+    int metadataCapacity;
+    std::atomic<int64> metadataWritten;
+    std::atomic<int64> metadataRead;
+    std::atomic<int64> metadataDropped;
+
+    int64 samplesWritten;
+    int64 samplesRead;
+
 	int64 lastSampleNumber;
     double lastTimestamp;
 
     int numChans;
 
+    FillLevelNotifier spaceNotifier;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DataBuffer);
 };
 
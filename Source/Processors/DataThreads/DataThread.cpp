@@ -23,9 +23,16 @@
 #include "DataThread.h"
 #include "../SourceNode/SourceNode.h"
 #include "../../Utils/Utils.h"
+#include "../../Utils/TraceRecorder.h"
 
 #include "../Editors/GenericEditor.h"
 
+/* Longest time run() sleeps while every buffer is full, before calling updateBuffer() anyway */
+#define FULL_BUFFER_WAIT_MS 10
+
+/* Shortest time between two reports of dropped buffer metadata */
+#define DROP_REPORT_INTERVAL_MS 1000
+
 DataThread::DataThread (SourceNode* s_)
     : Thread     ("Data Thread"),
       sn(s_)
@@ -43,7 +50,26 @@ void DataThread::run()
 {
     while (! threadShouldExit())
     {
-        if (! updateBuffer())
+        bool buffersFull = sourceBuffers.size() > 0;
+
+        for (auto buffer : sourceBuffers)
+            buffersFull = buffersFull && buffer->getNumFree() == 0;
+
+        // nothing could be written; sleep until the SourceNode reads, but still call
+        // updateBuffer() regularly so that hardware FIFOs are drained
+        if (buffersFull)
+            waitForSpace (1, FULL_BUFFER_WAIT_MS);
+
+        bool bufferUpdated;
+
+        {
+            TraceSpan span ("DataThread::updateBuffer");
+            bufferUpdated = updateBuffer();
+        }
+
+        reportDroppedMetadata();
+
+        if (! bufferUpdated)
         {
             const MessageManagerLock mmLock (Thread::getCurrentThread());
 
@@ -56,6 +82,30 @@ void DataThread::run()
 }
 
 
+void DataThread::reportDroppedMetadata()
+{
+    const uint32 now = Time::getMillisecondCounter();
+
+    if (now - lastDropReportTime < DROP_REPORT_INTERVAL_MS)
+        return;
+
+    lastDropReportTime = now;
+
+    reportedDroppedMetadata.resize (sourceBuffers.size());
+
+    for (int i = 0; i < sourceBuffers.size(); i++)
+    {
+        const int64 dropped = sourceBuffers[i]->getNumDroppedMetadataRecords();
+
+        if (dropped > reportedDroppedMetadata[i])
+            LOGE("DataThread: metadata buffer overrun on stream ", i, ", ", dropped - reportedDroppedMetadata[i],
+                 " sample number / timestamp records were not stored (", dropped, " total); their timestamps were extrapolated");
+
+        reportedDroppedMetadata.set (i, dropped);
+    }
+}
+
+
 DataBuffer* DataThread::getBufferAddress(int streamIdx) const
 {
 	return sourceBuffers[streamIdx];
@@ -72,3 +122,19 @@ void DataThread::broadcastMessage(String msg)
 {
     sn->broadcastDataThreadMessage(msg);
 }
+
+
+bool DataThread::waitForSpace(int numSamples, int timeoutMs)
+{
+    const uint32 start = Time::getMillisecondCounter();
+
+    for (auto buffer : sourceBuffers)
+    {
+        const int remaining = jmax (0, timeoutMs - int (Time::getMillisecondCounter() - start));
+
+        if (! buffer->waitForSpace (numSamples, remaining))
+            return false;
+    }
+
+    return true;
+}
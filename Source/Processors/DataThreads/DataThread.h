@@ -64,7 +64,10 @@ public:
     // ---------------------
 
     /** Fills the DataBuffer with incoming data. This is the most important
-        method for each DataThread.*/
+        method for each DataThread.
+
+        Data can be copied in with DataBuffer::addToBuffer(), or decoded straight
+        into the buffer with DataBuffer::reserveWrite() and commitWrite().*/
     virtual bool updateBuffer() = 0;
 
     /** Returns true if the data source is connected, false otherwise.*/
@@ -104,6 +107,9 @@ public:
     /** Allows the DataThread to set its default state, depending on whether the signal chain is loading */
     virtual void initialize(bool signalChainIsLoading) { }
 
+    /** Called when one of the SourceNode's parameters changes value */
+    virtual void parameterValueChanged(Parameter* param) { }
+
     // ---------------------
     // NON-VIRTUAL METHODS
     // ---------------------
@@ -119,12 +125,26 @@ protected:
     // ** Allows the DataThread to broadcast a message other plugins */
     void broadcastMessage(String msg);
 
+    /** Sleeps until every source buffer has space for numSamples samples, the thread is
+        asked to exit, or timeoutMs milliseconds have passed. Wakes as soon as the SourceNode
+        reads from the buffers, so it can replace polling in updateBuffer().
+
+        @return true if all buffers have enough space.
+    */
+    bool waitForSpace(int numSamples, int timeoutMs);
+
     SourceNode* sn;
 
 	OwnedArray<DataBuffer> sourceBuffers;
 
 private:
 
+    /** Logs the sample number / timestamp records that the source buffers had to drop since the last report */
+    void reportDroppedMetadata();
+
+    Array<int64> reportedDroppedMetadata;
+    uint32 lastDropReportTime = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DataThread);
 };
 
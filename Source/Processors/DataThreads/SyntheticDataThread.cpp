@@ -0,0 +1,421 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "SyntheticDataThread.h"
+#include "SyntheticSourceEditor.h"
+#include "../SourceNode/SourceNode.h"
+#include "../../Utils/Utils.h"
+
+/* Size of the noise table (a power of two) */
+#define NOISE_TABLE_SIZE 65536
+
+/* Samples per stream in each DataBuffer */
+#define SYNTHETIC_BUFFER_SIZE 30000
+
+/* Largest number of samples written per stream in one go */
+#define MAX_SAMPLES_PER_WRITE 2048
+
+/* In fast pacing, the free space to wait for when the buffers are full */
+#define MIN_SAMPLES_PER_WRITE 256
+
+#define MAX_SYNTHETIC_CHANNELS 8192
+
+/* Length of the spike template */
+#define SPIKE_DURATION_MS 1.6f
+
+SyntheticDataThread::SyntheticDataThread(SourceNode* sn)
+    : DataThread(sn),
+      noiseLevel(20.0f),
+      spikeRate(10.0f),
+      spikeAmplitude(150.0f),
+      numTtlLines(4),
+      ttlPeriodMs(500.0f),
+      realtime(true),
+      startTicks(0)
+{
+    sn->addIntParameter(Parameter::GLOBAL_SCOPE, "streams", "Number of data streams", 1, 1, 64, true);
+    sn->addStringParameter(Parameter::GLOBAL_SCOPE, "channels", "Channels per stream (comma-separated)", "384", true);
+    sn->addStringParameter(Parameter::GLOBAL_SCOPE, "sample_rate", "Sample rate per stream in Hz (comma-separated)", "30000", true);
+    sn->addFloatParameter(Parameter::GLOBAL_SCOPE, "noise_uv", "RMS noise in microvolts", 20.0f, 0.0f, 1000.0f, 1.0f, true);
+    sn->addFloatParameter(Parameter::GLOBAL_SCOPE, "spike_hz", "Mean spike rate per channel", 10.0f, 0.0f, 500.0f, 0.5f, true);
+    sn->addFloatParameter(Parameter::GLOBAL_SCOPE, "spike_uv", "Spike amplitude in microvolts", 150.0f, 0.0f, 5000.0f, 10.0f, true);
+    sn->addIntParameter(Parameter::GLOBAL_SCOPE, "ttl_lines", "TTL lines per stream", 4, 0, 64, true);
+    sn->addFloatParameter(Parameter::GLOBAL_SCOPE, "ttl_ms", "Period of the first TTL line in ms (doubles for each line)", 500.0f, 1.0f, 1000000.0f, 1.0f, true);
+    sn->addCategoricalParameter(Parameter::GLOBAL_SCOPE, "pacing", "Generate in real time, or as fast as the buffers allow", { "realtime", "fast" }, 0, true);
+
+    channelPointers.malloc(MAX_SYNTHETIC_CHANNELS);
+    noiseTable.malloc(NOISE_TABLE_SIZE);
+
+    // Box-Muller transform
+    for (int i = 0; i < NOISE_TABLE_SIZE; i += 2)
+    {
+        float u1 = jmax(1.0e-7f, random.nextFloat());
+        float u2 = random.nextFloat();
+        float r = std::sqrt(-2.0f * std::log(u1));
+
+        noiseTable[i] = r * std::cos(MathConstants<float>::twoPi * u2);
+        noiseTable[i + 1] = r * std::sin(MathConstants<float>::twoPi * u2);
+    }
+
+    readParameters();
+}
+
+SyntheticDataThread::~SyntheticDataThread()
+{
+}
+
+DataThread* SyntheticDataThread::createDataThread(SourceNode* sn)
+{
+    return new SyntheticDataThread(sn);
+}
+
+bool SyntheticDataThread::foundInputSource()
+{
+    return true;
+}
+
+std::unique_ptr<GenericEditor> SyntheticDataThread::createEditor(SourceNode* sn)
+{
+    return std::make_unique<SyntheticSourceEditor>(sn);
+}
+
+void SyntheticDataThread::parameterValueChanged(Parameter* param)
+{
+    if (sn->getEditor() != nullptr)
+        sn->requestSignalChainUpdate();
+}
+
+void SyntheticDataThread::readParameters()
+{
+    int numStreams = (int) sn->getParameter("streams")->getValue();
+
+    StringArray channelCounts;
+    channelCounts.addTokens(sn->getParameter("channels")->getValue().toString(), ",", "");
+    channelCounts.trim();
+    channelCounts.removeEmptyStrings();
+
+    StringArray sampleRates;
+    sampleRates.addTokens(sn->getParameter("sample_rate")->getValue().toString(), ",", "");
+    sampleRates.trim();
+    sampleRates.removeEmptyStrings();
+
+    noiseLevel = (float) sn->getParameter("noise_uv")->getValue();
+    spikeRate = (float) sn->getParameter("spike_hz")->getValue();
+    spikeAmplitude = (float) sn->getParameter("spike_uv")->getValue();
+    numTtlLines = (int) sn->getParameter("ttl_lines")->getValue();
+    ttlPeriodMs = (float) sn->getParameter("ttl_ms")->getValue();
+    realtime = ((CategoricalParameter*) sn->getParameter("pacing"))->getSelectedString() == "realtime";
+
+    streams.clear();
+
+    for (int i = 0; i < numStreams; i++)
+    {
+        Stream* stream = new Stream();
+
+        String channels = channelCounts.isEmpty() ? "384" : channelCounts[jmin(i, channelCounts.size() - 1)];
+        String rate = sampleRates.isEmpty() ? "30000" : sampleRates[jmin(i, sampleRates.size() - 1)];
+
+        stream->numChannels = jlimit(1, MAX_SYNTHETIC_CHANNELS, channels.getIntValue());
+        stream->sampleRate = jlimit(1.0f, 1000000.0f, rate.getFloatValue());
+        stream->samplesGenerated = 0;
+        stream->samplesDelayed = 0;
+        stream->delayedUntil = 0;
+
+        stream->nextSpike.calloc(stream->numChannels);
+
+        // negative trough followed by a slower positive rebound
+        stream->spikeLength = jmax(1, roundToInt(SPIKE_DURATION_MS * stream->sampleRate / 1000.0f));
+        stream->spikeTemplate.malloc(stream->spikeLength);
+
+        for (int s = 0; s < stream->spikeLength; s++)
+        {
+            float t = float(s) / float(stream->spikeLength);
+            float trough = std::exp(-std::pow((t - 0.25f) / 0.08f, 2.0f));
+            float rebound = std::exp(-std::pow((t - 0.55f) / 0.18f, 2.0f));
+
+            stream->spikeTemplate[s] = -trough + 0.35f * rebound;
+        }
+
+        for (int line = 0; line < numTtlLines; line++)
+        {
+            double halfPeriod = ttlPeriodMs * std::pow(2.0, line) * stream->sampleRate / 2000.0;
+            stream->ttlHalfPeriods.add(jmax((int64) 1, (int64) halfPeriod));
+        }
+
+        streams.add(stream);
+    }
+}
+
+void SyntheticDataThread::updateSettings(OwnedArray<ContinuousChannel>* continuousChannels,
+    OwnedArray<EventChannel>* eventChannels,
+    OwnedArray<SpikeChannel>* spikeChannels,
+    OwnedArray<DataStream>* sourceStreams,
+    OwnedArray<DeviceInfo>* devices,
+    OwnedArray<ConfigurationObject>* configurationObjects)
+{
+    readParameters();
+
+    continuousChannels->clear();
+    eventChannels->clear();
+    spikeChannels->clear();
+    sourceStreams->clear();
+    devices->clear();
+    configurationObjects->clear();
+
+    for (int i = 0; i < streams.size(); i++)
+    {
+        DataStream::Settings streamSettings
+        {
+            "synthetic" + String(i),
+            "Synthetic noise, spikes and TTL patterns",
+            "synthetic.stream" + String(i),
+            streams[i]->sampleRate
+        };
+
+        sourceStreams->add(new DataStream(streamSettings));
+        DataStream* stream = sourceStreams->getLast();
+
+        for (int ch = 0; ch < streams[i]->numChannels; ch++)
+        {
+            ContinuousChannel::Settings channelSettings
+            {
+                ContinuousChannel::Type::ELECTRODE,
+                "CH" + String(ch + 1),
+                "Synthetic channel",
+                "synthetic.continuous",
+                0.195f,
+                stream
+            };
+
+            continuousChannels->add(new ContinuousChannel(channelSettings));
+        }
+
+        EventChannel::Settings eventSettings
+        {
+            EventChannel::Type::TTL,
+            "Synthetic TTL",
+            "Square waves with doubling periods",
+            "synthetic.events",
+            stream,
+            jmax(1, numTtlLines)
+        };
+
+        eventChannels->add(new EventChannel(eventSettings));
+    }
+}
+
+void SyntheticDataThread::resizeBuffers()
+{
+    sourceBuffers.clear();
+
+    for (auto stream : streams)
+        sourceBuffers.add(new DataBuffer(stream->numChannels, SYNTHETIC_BUFFER_SIZE));
+}
+
+bool SyntheticDataThread::startAcquisition()
+{
+    for (int i = 0; i < streams.size(); i++)
+    {
+        Stream* stream = streams[i];
+
+        stream->samplesGenerated = 0;
+        stream->samplesDelayed = 0;
+        stream->delayedUntil = 0;
+
+        for (int ch = 0; ch < stream->numChannels; ch++)
+            stream->nextSpike[ch] = getSpikeInterval(*stream);
+
+        sourceBuffers[i]->clear();
+    }
+
+    startTicks = Time::getHighResolutionTicks();
+
+    startThread();
+
+    return true;
+}
+
+bool SyntheticDataThread::stopAcquisition()
+{
+    if (isThreadRunning())
+        signalThreadShouldExit();
+
+    waitForThreadToExit(500);
+
+    double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+    for (int i = 0; i < streams.size(); i++)
+    {
+        const Stream* stream = streams[i];
+
+        LOGC("Synthetic stream ", i, ": ", stream->numChannels, " channels, ",
+             roundToInt(stream->samplesGenerated / seconds), " samples/s (", stream->sampleRate, " Hz nominal)");
+
+        if (stream->samplesDelayed > 0)
+            LOGC("Synthetic stream ", i, ": buffer was full for ", stream->samplesDelayed, " due samples");
+    }
+
+    return true;
+}
+
+int64 SyntheticDataThread::getSpikeInterval(const Stream& stream)
+{
+    if (spikeRate <= 0.0f)
+        return std::numeric_limits<int64>::max() / 2;
+
+    // exponential intervals give Poisson spike times; never overlap two spikes on one channel
+    float u = jmax(1.0e-7f, random.nextFloat());
+    int64 interval = (int64) (-std::log(u) * stream.sampleRate / spikeRate);
+
+    return jmax((int64) stream.spikeLength, interval);
+}
+
+void SyntheticDataThread::generate(Stream& stream, float* const* channels, uint64* eventCodes, int64 firstSample, int numSamples)
+{
+    const int64 lastSample = firstSample + numSamples;
+
+    for (int ch = 0; ch < stream.numChannels; ch++)
+    {
+        float* out = channels[ch];
+
+        // each channel reads the noise table from its own offset
+        int position = int((firstSample + int64(ch) * 7919) & (NOISE_TABLE_SIZE - 1));
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            int n = jmin(numSamples - done, NOISE_TABLE_SIZE - position);
+
+            FloatVectorOperations::copyWithMultiply(out + done, noiseTable + position, noiseLevel, n);
+
+            done += n;
+            position = 0;
+        }
+
+        int64& spikeStart = stream.nextSpike[ch];
+
+        while (spikeStart < lastSample)
+        {
+            int64 from = jmax(spikeStart, firstSample);
+            int64 to = jmin(spikeStart + stream.spikeLength, lastSample);
+
+            FloatVectorOperations::addWithMultiply(out + (from - firstSample),
+                                                   stream.spikeTemplate + (from - spikeStart),
+                                                   spikeAmplitude,
+                                                   int(to - from));
+
+            if (spikeStart + stream.spikeLength > lastSample)
+                break; // finished in the next write
+
+            spikeStart += getSpikeInterval(stream);
+        }
+    }
+
+    if (stream.ttlHalfPeriods.isEmpty())
+    {
+        zeromem(eventCodes, numSamples * sizeof(uint64));
+        return;
+    }
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        uint64 code = 0;
+
+        for (int line = 0; line < stream.ttlHalfPeriods.size(); line++)
+            code |= uint64(((firstSample + i) / stream.ttlHalfPeriods.getUnchecked(line)) & 1) << line;
+
+        eventCodes[i] = code;
+    }
+}
+
+bool SyntheticDataThread::updateBuffer()
+{
+    const double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+    bool wroteSamples = false;
+
+    for (int i = 0; i < streams.size(); i++)
+    {
+        Stream& stream = *streams[i];
+        DataBuffer* buffer = sourceBuffers[i];
+
+        int64 due = realtime ? int64(elapsed * stream.sampleRate) - stream.samplesGenerated
+                             : MAX_SAMPLES_PER_WRITE;
+
+        if (due <= 0)
+            continue;
+
+        const int requested = (int) jmin(due, (int64) MAX_SAMPLES_PER_WRITE);
+
+        DataBuffer::WriteReservation reservation;
+        int reserved = buffer->reserveWrite(requested, reservation);
+
+        // a full buffer holds back every due sample, but each one is only counted the first time
+        if (realtime && reserved < requested)
+        {
+            const int64 firstDelayed = jmax(stream.samplesGenerated + reserved, stream.delayedUntil);
+            const int64 endOfDue = stream.samplesGenerated + due;
+
+            if (endOfDue > firstDelayed)
+            {
+                stream.samplesDelayed += endOfDue - firstDelayed;
+                stream.delayedUntil = endOfDue;
+            }
+        }
+
+        if (reserved == 0)
+            continue;
+
+        int64 sampleNumber = stream.samplesGenerated;
+
+        for (int segment = 0; segment < 2; segment++)
+        {
+            const int numSamples = reservation.numSamples[segment];
+
+            if (numSamples == 0)
+                break;
+
+            for (int ch = 0; ch < stream.numChannels; ch++)
+                channelPointers[ch] = reservation.getChannelPointer(ch, segment);
+
+            generate(stream, channelPointers, reservation.getEventCodePointer(segment), sampleNumber, numSamples);
+
+            sampleNumber += numSamples;
+        }
+
+        buffer->commitWrite(reserved, stream.samplesGenerated, stream.samplesGenerated / stream.sampleRate);
+
+        stream.samplesGenerated += reserved;
+        wroteSamples = true;
+    }
+
+    if (!wroteSamples)
+    {
+        if (realtime)
+            sleep(1); // wait for the next samples to be due
+        else
+            waitForSpace(MIN_SAMPLES_PER_WRITE, 10);
+    }
+
+    return true;
+}
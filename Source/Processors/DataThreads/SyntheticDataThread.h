@@ -0,0 +1,154 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __SYNTHETICDATATHREAD_H_6B2D41A7__
+#define __SYNTHETICDATATHREAD_H_6B2D41A7__
+
+#include "DataThread.h"
+
+/**
+    Generates synthetic data for load testing, without any hardware.
+
+    Produces any number of streams, each with its own channel count and sample rate.
+    Every channel carries Gaussian noise plus spikes (a fixed template at Poisson
+    intervals), and each stream has TTL lines that toggle as square waves, with the
+    period doubling from one line to the next.
+
+    Data is written straight into the DataBuffers with reserveWrite() / commitWrite().
+    In "realtime" pacing, samples are produced at the stream sample rates; in "fast"
+    pacing, the buffers are kept as full as possible, so the producer is never the
+    bottleneck.
+
+    The settings are SourceNode parameters, so they're saved with the signal chain and
+    can be changed from the editor or over the HTTP API:
+    - streams: number of streams
+    - channels: channel count per stream, comma-separated (the last value is used for the remaining streams)
+    - sample_rate: sample rate per stream in Hz, comma-separated in the same way
+    - noise_uv: RMS noise in microvolts
+    - spike_hz: mean spike rate per channel
+    - spike_uv: spike trough amplitude in microvolts
+    - ttl_lines: number of TTL lines per stream
+    - ttl_ms: period of the first TTL line in milliseconds
+    - pacing: "realtime" or "fast"
+
+    @see DataThread, SourceNode
+*/
+class SyntheticDataThread : public DataThread
+{
+public:
+
+    /** Constructor (adds the generator's parameters to the SourceNode) */
+    SyntheticDataThread(SourceNode* sn);
+
+    /** Destructor */
+    ~SyntheticDataThread();
+
+    /** Creates a SyntheticDataThread for a SourceNode */
+    static DataThread* createDataThread(SourceNode* sn);
+
+    /** Generates the samples that are due (or that fit in the buffers) for every stream */
+    bool updateBuffer() override;
+
+    /** Always true */
+    bool foundInputSource() override;
+
+    /** Resets the sample counters and starts the thread */
+    bool startAcquisition() override;
+
+    /** Stops the thread and logs the generation rate */
+    bool stopAcquisition() override;
+
+    /** Creates the streams, channels and TTL event channels described by the parameters */
+    void updateSettings(OwnedArray<ContinuousChannel>* continuousChannels,
+        OwnedArray<EventChannel>* eventChannels,
+        OwnedArray<SpikeChannel>* spikeChannels,
+        OwnedArray<DataStream>* sourceStreams,
+        OwnedArray<DeviceInfo>* devices,
+        OwnedArray<ConfigurationObject>* configurationObjects) override;
+
+    /** Creates one DataBuffer per stream */
+    void resizeBuffers() override;
+
+    /** Rebuilds the streams when a parameter changes */
+    void parameterValueChanged(Parameter* param) override;
+
+    /** Creates an editor for the generator's parameters */
+    std::unique_ptr<GenericEditor> createEditor(SourceNode* sn) override;
+
+private:
+
+    /** Layout and generator state of one stream */
+    struct Stream
+    {
+        int numChannels;
+        float sampleRate;
+
+        int64 samplesGenerated;
+        int64 samplesDelayed;
+
+        /** End of the range of due samples already counted in samplesDelayed */
+        int64 delayedUntil;
+
+        /** Next spike start (in samples) for each channel */
+        HeapBlock<int64> nextSpike;
+
+        /** Spike waveform at this stream's sample rate */
+        HeapBlock<float> spikeTemplate;
+        int spikeLength;
+
+        /** Half-period of each TTL line, in samples */
+        Array<int64> ttlHalfPeriods;
+    };
+
+    /** Reads the parameters into the stream layout */
+    void readParameters();
+
+    /** Writes numSamples samples starting at sample number firstSample, in one ring segment */
+    void generate(Stream& stream, float* const* channels, uint64* eventCodes, int64 firstSample, int numSamples);
+
+    /** Draws the number of samples until a channel's next spike */
+    int64 getSpikeInterval(const Stream& stream);
+
+    OwnedArray<Stream> streams;
+
+    /** Gaussian noise (unit variance), read by every channel at a different offset */
+    HeapBlock<float> noiseTable;
+
+    /** Channel pointers for the ring segment being written */
+    HeapBlock<float*> channelPointers;
+
+    float noiseLevel;
+    float spikeRate;
+    float spikeAmplitude;
+    int numTtlLines;
+    float ttlPeriodMs;
+    bool realtime;
+
+    Random random;
+
+    int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticDataThread);
+};
+
+#endif  // __SYNTHETICDATATHREAD_H_6B2D41A7__
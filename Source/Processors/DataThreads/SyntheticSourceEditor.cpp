@@ -0,0 +1,41 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "SyntheticSourceEditor.h"
+
+SyntheticSourceEditor::SyntheticSourceEditor(GenericProcessor* parentNode)
+    : GenericEditor(parentNode)
+{
+    desiredWidth = 460;
+
+    addTextBoxParameterEditor("streams", 10, 25);
+    addTextBoxParameterEditor("channels", 100, 25);
+    addTextBoxParameterEditor("sample_rate", 190, 25);
+    addTextBoxParameterEditor("ttl_lines", 280, 25);
+    addComboBoxParameterEditor("pacing", 370, 25);
+
+    addTextBoxParameterEditor("noise_uv", 10, 75);
+    addTextBoxParameterEditor("spike_hz", 100, 75);
+    addTextBoxParameterEditor("spike_uv", 190, 75);
+    addTextBoxParameterEditor("ttl_ms", 280, 75);
+}
@@ -0,0 +1,54 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __SYNTHETICSOURCEEDITOR_H_3F8C7D20__
+#define __SYNTHETICSOURCEEDITOR_H_3F8C7D20__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../Editors/GenericEditor.h"
+
+/**
+
+  Interface for the synthetic data source; shows one
+  editor for each of its parameters.
+
+  @see SyntheticDataThread
+
+*/
+class SyntheticSourceEditor : public GenericEditor
+{
+public:
+
+    /** Constructor */
+    SyntheticSourceEditor(GenericProcessor* parentNode);
+
+    /** Destructor */
+    virtual ~SyntheticSourceEditor() { }
+
+private:
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticSourceEditor);
+
+};
+
+#endif  // __SYNTHETICSOURCEEDITOR_H_3F8C7D20__
@@ -116,11 +116,11 @@ void EventTranslator::process (AudioBuffer<float>& buffer)
 }
 
 
-void EventTranslator::handleTTLEvent(TTLEventPtr event)
+void EventTranslator::handleTTLEventView(const TTLEventView& event)
 {
-    const uint16 eventStream = event->getStreamId();
-    const int ttlLine = event->getLine();
-    const int64 sampleNumber = event->getSampleNumber();
+    const uint16 eventStream = event.getStreamId();
+    const int ttlLine = event.getLine();
+    const int64 sampleNumber = event.getSampleNumber();
     
     if (synchronizer.getSyncLine(eventStream) == ttlLine)
     {
@@ -134,7 +134,7 @@ void EventTranslator::handleTTLEvent(TTLEventPtr event)
         
         //std::cout << "TRANSLATE!" << std::endl;
         
-        const bool state = event->getState();
+        const bool state = event.getState();
         
         double timestamp = synchronizer.convertSampleNumberToTimestamp(eventStream, sampleNumber);
         
@@ -88,7 +88,7 @@ public:
 private:
     
     /** Called whenever a new TTL event arrives*/
-    void handleTTLEvent (TTLEventPtr event) override;
+    void handleTTLEventView (const TTLEventView& event) override;
     
     StreamSettings<EventTranslatorSettings> settings;
     
@@ -206,19 +206,36 @@ size_t SystemEvent::fillTimestampAndSamplesData(HeapBlock<char>& data,
 	uint32 nSamplesInBlock,
 	int64 processStartTime)
 {
-	const int eventSize = EVENT_BASE_SIZE + 4 + 8;
-	data.malloc(eventSize);
+	data.malloc(TIMESTAMP_AND_SAMPLES_SIZE);
+
+	return fillTimestampAndSamplesData(data.getData(),
+		proc,
+		streamId,
+		startSampleForBlock,
+		startTimestampForBlock,
+		nSamplesInBlock,
+		processStartTime);
+}
+
+size_t SystemEvent::fillTimestampAndSamplesData(char* data,
+	const GenericProcessor* proc,
+	uint16 streamId,
+	int64 startSampleForBlock,
+	double startTimestampForBlock,
+	uint32 nSamplesInBlock,
+	int64 processStartTime)
+{
 	data[0] = SYSTEM_EVENT;													 // 1 byte
 	data[1] = TIMESTAMP_AND_SAMPLES;										 // 1 byte
-	*reinterpret_cast<uint16*>(data.getData() + 2) = proc->getNodeId();		 // 2 bytes
-	*reinterpret_cast<uint16*>(data.getData() + 4) = streamId;				 // 2 bytes
+	*reinterpret_cast<uint16*>(data + 2) = proc->getNodeId();				 // 2 bytes
+	*reinterpret_cast<uint16*>(data + 4) = streamId;						 // 2 bytes
 	data[6] = 0;															 // 1 byte 
 	data[7] = 0;															 // 1 byte
-	*reinterpret_cast<int64*>(data.getData() + 8) = startSampleForBlock;     // 8 bytes
-    *reinterpret_cast<double*>(data.getData() + 16) = startTimestampForBlock;// 8 bytes
-	*reinterpret_cast<uint32*>(data.getData() + EVENT_BASE_SIZE) = nSamplesInBlock;		 // 8 bytes
-	*reinterpret_cast<int64*>(data.getData() + EVENT_BASE_SIZE + 4) = processStartTime; // 8 bytes
-	return eventSize;
+	*reinterpret_cast<int64*>(data + 8) = startSampleForBlock;				 // 8 bytes
+	*reinterpret_cast<double*>(data + 16) = startTimestampForBlock;			 // 8 bytes
+	*reinterpret_cast<uint32*>(data + EVENT_BASE_SIZE) = nSamplesInBlock;	 // 4 bytes
+	*reinterpret_cast<int64*>(data + EVENT_BASE_SIZE + 4) = processStartTime; // 8 bytes
+	return TIMESTAMP_AND_SAMPLES_SIZE;
 }
 
 size_t SystemEvent::fillTimestampSyncTextData(
@@ -471,6 +488,31 @@ TTLEventPtr TTLEvent::createTTLEvent(const EventChannel* channelInfo,
 	return new TTLEvent(channelInfo, sampleNumber, data);
 }
 
+void TTLEvent::serializeTTLEvent(const EventChannel* channelInfo,
+                                 int64 sampleNumber,
+                                 uint8 line,
+                                 bool state,
+                                 uint64 word,
+                                 void* dstBuffer)
+{
+	jassert(channelInfo->getType() == EventChannel::TTL);
+	jassert(channelInfo->getTotalEventMetadataSize() == 0);
+
+	char* buffer = static_cast<char*>(dstBuffer);
+
+	*(buffer + 0) = PROCESSOR_EVENT;
+	*(buffer + 1) = static_cast<char>(EventChannel::TTL);
+	*(reinterpret_cast<uint16*>(buffer + 2)) = channelInfo->getSourceNodeId();
+	*(reinterpret_cast<uint16*>(buffer + 4)) = channelInfo->getStreamId();
+	*(reinterpret_cast<uint16*>(buffer + 6)) = channelInfo->getLocalIndex();
+	*(reinterpret_cast<juce::int64*>(buffer + 8)) = sampleNumber;
+	*(reinterpret_cast<double*>(buffer + 16)) = -1.0;
+
+	*(buffer + EVENT_BASE_SIZE) = line;
+	*(buffer + EVENT_BASE_SIZE + 1) = state;
+	memcpy(buffer + EVENT_BASE_SIZE + 2, &word, sizeof(uint64));
+}
+
 TTLEventPtr TTLEvent::createTTLEvent(EventChannel* channelInfo, 
                                      int64 sampleNumber,
                                      uint8 line,
@@ -567,6 +609,38 @@ TTLEventPtr TTLEvent::deserialize(const EventPacket& packet, const EventChannel*
 	
 }
 
+TTLEventView::TTLEventView(const uint8* data, const EventChannel* channelInfo) :
+	m_data(data),
+	m_channelInfo(channelInfo),
+	m_header(EventPacketHeader::read(data))
+{
+}
+
+uint64 TTLEventView::getWord() const
+{
+	uint64 word;
+	memcpy(&word, m_data + EVENT_BASE_SIZE + 2, sizeof(uint64));
+	return word;
+}
+
+void TTLEventView::setTimestampInSeconds(double timestamp)
+{
+	uint8* modifiableBuffer = const_cast<uint8*>(m_data);
+
+	memcpy(modifiableBuffer + 16, &timestamp, sizeof(double));
+	m_header.timestamp = timestamp;
+}
+
+size_t TTLEventView::getRawDataSize() const
+{
+	return EVENT_BASE_SIZE + m_channelInfo->getDataSize() + m_channelInfo->getTotalEventMetadataSize();
+}
+
+TTLEventPtr TTLEventView::toTTLEvent() const
+{
+	return TTLEvent::deserialize(m_data, m_channelInfo);
+}
+
 TextEvent::TextEvent(const EventChannel* channelInfo, int64 sampleNumber, const String& text, double timestamp)
 	: Event(channelInfo, sampleNumber, timestamp)
 {
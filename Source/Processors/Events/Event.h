@@ -29,6 +29,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define EVENT_BASE_SIZE 24
 
+/* Size of a serialized TTL event without metadata */
+#define TTL_EVENT_SIZE (EVENT_BASE_SIZE + 10)
+
+/* Size of a serialized TIMESTAMP_AND_SAMPLES system event */
+#define TIMESTAMP_AND_SAMPLES_SIZE (EVENT_BASE_SIZE + 12)
+
 typedef MidiMessage EventPacket;
 
 class GenericProcessor;
@@ -41,6 +47,37 @@ class BinaryEvent;
 
 typedef ScopedPointer<EventBase> EventBasePtr;
 
+/**
+*
+* Fixed-layout copy of the first EVENT_BASE_SIZE bytes of every
+* serialized event or spike (see EventBase for the packet structure).
+*
+* Packets stored in a MidiBuffer are not necessarily aligned, so the
+* header is always copied out with memcpy rather than cast in place.
+*
+*/
+struct EventPacketHeader
+{
+	uint8 baseType;
+	uint8 eventType;
+	uint16 processorId;
+	uint16 streamId;
+	uint16 channelIndex;
+	int64 sampleNumber;
+	double timestamp;
+
+	/* Reads the header from the start of a serialized event */
+	static EventPacketHeader read(const uint8* data)
+	{
+		EventPacketHeader header;
+		memcpy(&header, data, sizeof(EventPacketHeader));
+		return header;
+	}
+};
+
+static_assert(sizeof(EventPacketHeader) == EVENT_BASE_SIZE, "EventPacketHeader must match the serialized event layout");
+static_assert(std::is_trivially_copyable<EventPacketHeader>::value, "EventPacketHeader must be a POD type");
+
 /**
 * 
 * Base class for all Event objects (including Spikes)
@@ -232,6 +269,15 @@ public:
         double timestamp,
 		uint32 nSamplesInBlock,
 		int64 processStartTime);
+
+	/* Write a TIMESTAMP_AND_SAMPLES event into a buffer of TIMESTAMP_AND_SAMPLES_SIZE bytes */
+	static size_t fillTimestampAndSamplesData(char* data,
+		const GenericProcessor* proc,
+		uint16 streamId,
+		int64 startSampleForBlock,
+		double timestamp,
+		uint32 nSamplesInBlock,
+		int64 processStartTime);
 		
 	/* Create a TIMESTAMP_SYNC_TEXT event */
 	static size_t fillTimestampSyncTextData(HeapBlock<char>& data, 
@@ -396,6 +442,15 @@ public:
 		bool state,
 		const MetadataValueArray& metaData);
 
+	/* Writes a TTL event (for a channel without metadata) straight into a buffer of
+	   TTL_EVENT_SIZE bytes, without creating a TTLEvent */
+	static void serializeTTLEvent(const EventChannel* channelInfo,
+		int64 sampleNumber,
+		uint8 line,
+		bool state,
+		uint64 word,
+		void* dstBuffer);
+
 	/* Deserialize a TTL event from an EventPacket object */
 	static TTLEventPtr deserialize(const EventPacket& packet, const EventChannel* channelInfo);
 
@@ -412,6 +467,71 @@ private:
 	JUCE_LEAK_DETECTOR(TTLEvent);
 };
 
+/**
+*
+* Read view of a serialized TTL event
+*
+* Passed to GenericProcessor::handleTTLEventView() by checkForEvents().
+* Unlike TTLEvent::deserialize(), creating a view does not allocate:
+* it points straight into the event buffer, so it is only valid for
+* the duration of the handler call. Use toTTLEvent() to keep a copy.
+*
+* The TTLEventView class is part of the Open Ephys Plugin API
+*
+*/
+class PLUGIN_API TTLEventView
+{
+public:
+
+	/* Constructor */
+	TTLEventView(const uint8* data, const EventChannel* channelInfo);
+
+	/* Get the EventChannel info object associated with this event */
+	const EventChannel* getChannelInfo() const { return m_channelInfo; }
+
+	/* Get the ID of the processor that generated this event */
+	uint16 getProcessorId() const { return m_header.processorId; }
+
+	/* Get the ID of the DataStream associated with this event */
+	uint16 getStreamId() const { return m_header.streamId; }
+
+	/* Get the index of the event channel that generated this event */
+	uint16 getChannelIndex() const { return m_header.channelIndex; }
+
+	/* Get the sample number for this event */
+	int64 getSampleNumber() const { return m_header.sampleNumber; }
+
+	/* Get the timestamp (in seconds) for this event */
+	double getTimestampInSeconds() const { return m_header.timestamp; }
+
+	/* Get the TTL line for this event */
+	uint8 getLine() const { return m_data[EVENT_BASE_SIZE]; }
+
+	/* Get the state (on or off) for this event */
+	bool getState() const { return m_data[EVENT_BASE_SIZE + 1] == 1; }
+
+	/* Get the full TTL word for this event */
+	uint64 getWord() const;
+
+	/* Overwrites the timestamp in the underlying event buffer, so
+	   processors further down the signal chain will also see it */
+	void setTimestampInSeconds(double timestamp);
+
+	/* Get a pointer to the serialized event */
+	const uint8* getRawData() const { return m_data; }
+
+	/* Get the size of the serialized event, including metadata */
+	size_t getRawDataSize() const;
+
+	/* Creates an owning TTLEvent object with the same contents (allocates) */
+	TTLEventPtr toTTLEvent() const;
+
+private:
+	const uint8* m_data;
+	const EventChannel* m_channelInfo;
+	EventPacketHeader m_header;
+};
+
 typedef ScopedPointer<TextEvent> TextEventPtr;
 
 /**
@@ -0,0 +1,71 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventArena.h"
+
+EventArena::EventArena(size_t initialCapacity) :
+	block(initialCapacity),
+	capacity(initialCapacity),
+	used(0),
+	overflowBytes(0)
+{
+}
+
+EventArena::~EventArena()
+{
+}
+
+void* EventArena::allocate(size_t size)
+{
+	size_t alignedSize = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	if (used + alignedSize <= capacity)
+	{
+		void* ptr = block.getData() + used;
+		used += alignedSize;
+		return ptr;
+	}
+
+	/* Out of space for this block: serve the request from the heap and
+	   remember how much was needed, so that reset() can grow the arena */
+	overflowChunks.emplace_back(alignedSize);
+	overflowBytes += alignedSize;
+
+	return overflowChunks.back().getData();
+}
+
+void EventArena::reset()
+{
+	if (overflowBytes > 0)
+	{
+		size_t required = used + overflowBytes;
+
+		overflowChunks.clear();
+		overflowBytes = 0;
+
+		capacity = jmax(required, capacity * 2);
+		block.malloc(capacity);
+	}
+
+	used = 0;
+}
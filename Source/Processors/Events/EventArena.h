@@ -0,0 +1,89 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EVENTARENA_H_INCLUDED
+#define EVENTARENA_H_INCLUDED
+
+#include <JuceHeader.h>
+
+#include "../PluginManager/OpenEphysPlugin.h"
+
+#include <vector>
+
+
+/**
+*
+* Bump allocator for the events a processor creates during a single
+* processing block.
+*
+* Memory handed out by allocate() stays valid until the next call to
+* reset(), which GenericProcessor makes at the start of every block,
+* so serializing an event costs a pointer increment instead of a heap
+* allocation.
+*
+* If a block needs more than the current capacity, the excess is
+* served from overflow chunks and the arena grows to the high-water
+* mark on the next reset(); in steady state it never allocates.
+*
+* The EventArena class is part of the Open Ephys Plugin API
+*
+*/
+class PLUGIN_API EventArena
+{
+public:
+
+	/* Constructor */
+	EventArena(size_t initialCapacity = DEFAULT_CAPACITY);
+
+	/* Destructor */
+	~EventArena();
+
+	/* Returns size bytes of 8-byte aligned memory, valid until the next reset() */
+	void* allocate(size_t size);
+
+	/* Releases everything allocated since the last reset */
+	void reset();
+
+	/* Returns the number of bytes handed out since the last reset */
+	size_t getNumBytesUsed() const { return used + overflowBytes; }
+
+	/* Returns the number of bytes that can be allocated without falling back to the heap */
+	size_t getCapacity() const { return capacity; }
+
+	static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+private:
+
+	static const size_t ALIGNMENT = 8;
+
+	HeapBlock<char> block;
+	size_t capacity;
+	size_t used;
+
+	std::vector<HeapBlock<char>> overflowChunks;
+	size_t overflowBytes;
+
+	JUCE_DECLARE_NON_COPYABLE(EventArena);
+};
+
+#endif
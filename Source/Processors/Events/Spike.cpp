@@ -393,3 +393,71 @@ const float* Spike::Buffer::getRawPointer()
 	}
 	return m_data.getData();
 }
+
+SpikeView::SpikeView(uint8* data, const SpikeChannel* channelInfo) :
+	m_data(data),
+	m_channelInfo(channelInfo),
+	m_header(EventPacketHeader::read(data))
+{
+}
+
+uint16 SpikeView::getSortedId() const
+{
+	uint16 sortedId;
+	memcpy(&sortedId, m_data + EVENT_BASE_SIZE, sizeof(uint16));
+	return sortedId;
+}
+
+float SpikeView::getThreshold(int chan) const
+{
+	jassert(chan >= 0 && chan < int(m_channelInfo->getNumChannels()));
+
+	float threshold;
+	memcpy(&threshold, m_data + SPIKE_BASE_SIZE + chan * sizeof(float), sizeof(float));
+	return threshold;
+}
+
+const uint8* SpikeView::getWaveformData() const
+{
+	return m_data + SPIKE_BASE_SIZE + m_channelInfo->getNumChannels() * sizeof(float);
+}
+
+float SpikeView::getSample(int chan, int samp) const
+{
+	const int nSamples = m_channelInfo->getTotalSamples();
+
+	float value;
+	memcpy(&value, getWaveformData() + (chan * nSamples + samp) * sizeof(float), sizeof(float));
+	return value;
+}
+
+void SpikeView::copyChannelData(int chan, float* dest) const
+{
+	const int nSamples = m_channelInfo->getTotalSamples();
+
+	memcpy(dest, getWaveformData() + chan * nSamples * sizeof(float), nSamples * sizeof(float));
+}
+
+void SpikeView::setSortedId(uint16 sortedId)
+{
+	memcpy(m_data + EVENT_BASE_SIZE, &sortedId, sizeof(uint16));
+}
+
+void SpikeView::setTimestampInSeconds(double timestamp)
+{
+	memcpy(m_data + 16, &timestamp, sizeof(double));
+	m_header.timestamp = timestamp;
+}
+
+size_t SpikeView::getRawDataSize() const
+{
+	return SPIKE_BASE_SIZE
+		+ m_channelInfo->getNumChannels() * sizeof(float)
+		+ m_channelInfo->getDataSize()
+		+ m_channelInfo->getTotalEventMetadataSize();
+}
+
+SpikePtr SpikeView::toSpike() const
+{
+	return Spike::deserialize(m_data, m_channelInfo);
+}
@@ -206,4 +206,78 @@ private:
 	JUCE_LEAK_DETECTOR(Spike);
 };
 
+
+/**
+*
+* Read view of a serialized spike
+*
+* Passed to GenericProcessor::handleSpikeView() by checkForEvents().
+* Creating a view does not allocate: it points straight into the event
+* buffer, so it is only valid for the duration of the handler call.
+* setSortedId() and setTimestampInSeconds() write into that buffer, so
+* processors further down the signal chain see the updated values.
+*
+* The SpikeView class is part of the Open Ephys Plugin API
+*
+*/
+class PLUGIN_API SpikeView
+{
+public:
+
+	/* Constructor */
+	SpikeView(uint8* data, const SpikeChannel* channelInfo);
+
+	/* Get the SpikeChannel info object associated with this spike */
+	const SpikeChannel* getChannelInfo() const { return m_channelInfo; }
+
+	/* Get the ID of the processor that generated this spike */
+	uint16 getProcessorId() const { return m_header.processorId; }
+
+	/* Get the ID of the DataStream associated with this spike */
+	uint16 getStreamId() const { return m_header.streamId; }
+
+	/* Get the index of the spike channel that generated this spike */
+	uint16 getChannelIndex() const { return m_header.channelIndex; }
+
+	/* Get the sample number of the spike peak */
+	int64 getSampleNumber() const { return m_header.sampleNumber; }
+
+	/* Get the timestamp (in seconds) of the spike peak */
+	double getTimestampInSeconds() const { return m_header.timestamp; }
+
+	/* Get the sorted ID for this spike */
+	uint16 getSortedId() const;
+
+	/* Get the threshold used to trigger spike capture on a particular channel */
+	float getThreshold(int chan) const;
+
+	/* Get a single sample of the waveform */
+	float getSample(int chan, int samp) const;
+
+	/* Copies the waveform of one channel (getTotalSamples() floats) into dest */
+	void copyChannelData(int chan, float* dest) const;
+
+	/* Updates the sorted ID in the underlying event buffer */
+	void setSortedId(uint16 sortedId);
+
+	/* Updates the timestamp in the underlying event buffer */
+	void setTimestampInSeconds(double timestamp);
+
+	/* Get a pointer to the serialized spike */
+	const uint8* getRawData() const { return m_data; }
+
+	/* Get the size of the serialized spike, including metadata */
+	size_t getRawDataSize() const;
+
+	/* Creates an owning Spike object with the same contents (allocates) */
+	SpikePtr toSpike() const;
+
+private:
+	const uint8* getWaveformData() const;
+
+	uint8* m_data;
+	const SpikeChannel* m_channelInfo;
+	EventPacketHeader m_header;
+};
+
 #endif
@@ -124,16 +124,30 @@ void BinaryFileSource::fillRecordInfo()
 		streamName = streamName.trimCharactersAtEnd("/");
 
 		File dataFile = m_rootPath.getChildFile("continuous").getChildFile(streamName).getChildFile("continuous.dat");
-		if (!dataFile.existsAsFile()) continue;
 
 		int numChannels = record[idNumChannels];
-		int64 numSamples = (dataFile.getSize() / numChannels) / sizeof(int16);
+		int64 numSamples;
+
+		if (dataFile.existsAsFile())
+		{
+			numSamples = (dataFile.getSize() / numChannels) / sizeof(int16);
+		}
+		else
+		{
+			dataFile = dataFile.withFileExtension("oec");
+
+			CompressedChunkReader reader;
+			if (!dataFile.existsAsFile() || !reader.openFile(dataFile) || reader.getNumChannels() != numChannels) continue;
+
+			numSamples = reader.getNumSamples();
+		}
 
 		info.name = streamName;
 		info.sampleRate = record[idSampleRate];
 		info.numSamples = numSamples;
 		
 		File tsFile = m_rootPath.getChildFile("continuous").getChildFile(streamName).getChildFile(sampleNumbersFilename);
+		File segmentsFile = tsFile.getSiblingFile("timestamp_segments.npy");
 		if (tsFile.exists())
 		{
 			std::unique_ptr<FileInputStream> tsDataStream = tsFile.createInputStream();
@@ -143,6 +157,12 @@ void BinaryFileSource::fillRecordInfo()
 			info.startTimestamp = *startTimestamp;
 			startSampleNumbers[streamName] = *startTimestamp;
 		}
+		else if (segmentsFile.existsAsFile())
+		{
+			TimestampSegmentReader segments;
+			info.startTimestamp = segments.openFile(segmentsFile) ? segments.getSegment(0).sampleNumber : 0;
+			startSampleNumbers[streamName] = info.startTimestamp;
+		}
 		else 
 		{
 			info.startTimestamp = 0;
@@ -305,7 +325,29 @@ void BinaryFileSource::processEventData(EventInfo &eventInfo, int64 start, int64
 void BinaryFileSource::updateActiveRecord(int index)
 {
     m_dataFile.reset();
-	m_dataFile = std::make_unique<MemoryMappedFile>(m_dataFileArray[index], MemoryMappedFile::readOnly);
+	m_compressedFile.reset();
+
+	if (m_dataFileArray[index].hasFileExtension("oec"))
+	{
+		m_compressedFile = std::make_unique<CompressedChunkReader>();
+
+		if (!m_compressedFile->openFile(m_dataFileArray[index]))
+		{
+			LOGE("BinaryFileSource: unable to open compressed file ", m_dataFileArray[index].getFullPathName());
+			m_compressedFile.reset();
+		}
+	}
+	else
+	{
+		m_dataFile = std::make_unique<MemoryMappedFile>(m_dataFileArray[index], MemoryMappedFile::readOnly);
+
+		if (m_dataFile->getData() == nullptr)
+		{
+			LOGE("BinaryFileSource: unable to map ", m_dataFileArray[index].getFullPathName());
+			m_dataFile.reset();
+		}
+	}
+
 	m_samplePos = 0;
 	numActiveChannels = getActiveNumChannels();
 
@@ -336,6 +378,22 @@ int BinaryFileSource::readData(int16* buffer, int nSamples)
 		samplesToRead = nSamples;
 	}
 
+	if (m_compressedFile)
+	{
+		/* Only the chunks that contain the requested samples are decoded */
+		samplesToRead = m_compressedFile->readSamples(m_samplePos, buffer, samplesToRead);
+		m_samplePos += samplesToRead;
+		return samplesToRead;
+	}
+
+	/* The record couldn't be opened (see updateActiveRecord()), so play back silence */
+	if (!m_dataFile)
+	{
+		memset(buffer, 0, samplesToRead * numActiveChannels * sizeof(int16));
+		m_samplePos += samplesToRead;
+		return samplesToRead;
+	}
+
 	int16* data = static_cast<int16*>(m_dataFile->getData()) + (m_samplePos * numActiveChannels);
 
 	//FIXME: Can crash here (heap overflow?), secondary either to wrong index or scrubbing too fast? Not sure yet. 
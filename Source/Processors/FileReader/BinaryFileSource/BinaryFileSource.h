@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../FileSource.h"
 #include "../../../Utils/Utils.h"
+#include "../../RecordNode/CompressedFormat/CompressedChunkReader.h"
+#include "../../RecordNode/BinaryFormat/TimestampSegments.h"
 
 /** 
 	
@@ -35,6 +37,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 	The files are indexed by a "structure.oebin" file, which 
 	is what is loaded into the File Reader.
 
+	Continuous data can be stored either as a flat "continuous.dat"
+	file, or compressed as "continuous.oec" (see CompressedRecording).
+	Sample numbers are stored either per sample, or as segments in
+	"timestamp_segments.npy" (see TimestampSegmentWriter).
+
 */
 namespace BinarySource
 {
@@ -77,6 +84,7 @@ namespace BinarySource
 		Array<float> bitVolts;
 
 		std::unique_ptr<MemoryMappedFile> m_dataFile;
+		std::unique_ptr<CompressedChunkReader> m_compressedFile;
 		var m_jsonData;
 		Array<File> m_dataFileArray;
 
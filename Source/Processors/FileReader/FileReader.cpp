@@ -35,6 +35,8 @@
 
 #include "../Events/Event.h"
 
+#include "../../Utils/TraceRecorder.h"
+
 FileReader::FileReader() : GenericProcessor ("File Reader")
     , Thread ("filereader_Async_Reader")
     , totalSamplesAcquired      (0)
@@ -107,8 +109,7 @@ FileReader::FileReader() : GenericProcessor ("File Reader")
 
 FileReader::~FileReader()
 {
-    signalThreadShouldExit();
-    notify();
+    stopThread(500);
 }
 
 AudioProcessorEditor* FileReader::createEditor()
@@ -614,7 +615,7 @@ void FileReader::switchBuffer()
         readBuffer = &bufferA;
     
     m_shouldFillBackBuffer.set(true);
-    notify();
+    m_backBufferNotifier.notify();
 }
 
 HeapBlock<int16>* FileReader::getFrontBuffer()
@@ -637,13 +638,14 @@ void FileReader::run()
         {
             readAndFillBufferCache(*getBackBuffer());
         }
-        
-        wait(30);
+
+        m_backBufferNotifier.waitUntil([this] { return m_shouldFillBackBuffer.get() != 0; }, 100);
     }
 }
 
 void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
 {
+    TraceSpan span("FileReader::readAndFillBufferCache");
 
     const int samplesNeededPerBuffer = m_samplesPerBuffer.get();
     const int samplesNeeded = samplesNeededPerBuffer * BUFFER_WINDOW_CACHE_SIZE;
@@ -664,7 +666,7 @@ void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
         {
             samplesToRead = stopSample - currentSample;
             if (samplesToRead > 0)
-                input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
+                readSamples (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
 
             if (startSample != 0)
             {
@@ -678,7 +680,7 @@ void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
         }
         else // else read the block needed
         {
-            input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
+            readSamples (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
             
             currentSample += samplesToRead;
         }
@@ -688,6 +690,22 @@ void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
     }
 }
 
+void FileReader::readSamples(int16* dest, int nSamples)
+{
+    const int numRead = jmax(0, input->readData (dest, nSamples));
+
+    if (numRead < nSamples)
+    {
+        LOGE("FileReader: only ", numRead, " of ", nSamples, " samples could be read at sample ", currentSample,
+             "; playing silence instead of the rest");
+
+        memset (dest + numRead * currentNumChannels, 0, size_t (nSamples - numRead) * currentNumChannels * sizeof(int16));
+
+        // keep the source in step with currentSample
+        input->seekTo (currentSample + nSamples);
+    }
+}
+
 StringArray FileReader::getSupportedExtensions() const
 {
 	StringArray extensions;
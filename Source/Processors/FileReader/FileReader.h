@@ -32,6 +32,7 @@
 #include "FileSource.h"
 
 #include "../../Utils/Utils.h"
+#include "../../Utils/FillLevelNotifier.h"
 
 
 #define BUFFER_WINDOW_CACHE_SIZE 10
@@ -176,6 +177,7 @@ private:
     HashMap<String, int> supportedExtensions;
     
     Atomic<int> m_shouldFillBackBuffer;
+    FillLevelNotifier m_backBufferNotifier;
     Atomic<int> m_samplesPerBuffer;
 
 	unsigned int m_bufferSize;
@@ -190,6 +192,9 @@ private:
     /** Reads a chunk of the file that fills an entire buffer cache. */
     void readAndFillBufferCache(HeapBlock<int16> &cacheBuffer);
 
+    /** Reads nSamples from the input, filling any samples it can't provide (e.g. in a corrupt chunk) with silence */
+    void readSamples(int16* dest, int nSamples);
+
 	/** Returns the number of included file sources */
 	int getNumBuiltInFileSources() const;
 
@@ -41,6 +41,11 @@
 
 #include "../MessageCenter/MessageCenterEditor.h"
 
+#include "../../Audio/AudioComponent.h"
+#include "../../Utils/TraceRecorder.h"
+#include "../../Utils/RealtimeSafetyChecker.h"
+#include "../../Utils/RealtimeWorkerPool.h"
+
 #include <exception>
 
 #define MS_FROM_START Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1000
@@ -63,6 +68,13 @@ GenericProcessor::GenericProcessor(const String& name)
 	, sendSampleCount(true)
 	, m_name(name)
 	, m_paramsWereLoaded(false)
+	, firstBlockInfoStreamId(0)
+	, parallelStreamProcessing(false)
+	, currentStreamBuffer(nullptr)
+	, currentStreamChannels(nullptr)
+	, numProcessOverruns(0)
+	, processBudgetNs(0)
+	, processTimingResetRequested(false)
 
 {
 	latencyMeter = std::make_unique<LatencyMeter>(this);
@@ -542,10 +554,8 @@ void GenericProcessor::clearSettings()
 
     ttlEventChannel = nullptr;
 
-	startTimestampsForBlock.clear();
-    startSamplesForBlock.clear();
-	numSamplesInBlock.clear();
-	processStartTimes.clear();
+	blockInfo.clear();
+	blockInfoIndex.clear();
 
 }
 
@@ -1086,6 +1096,11 @@ void GenericProcessor::updateChannelIndexMaps()
 	spikeChannelMap.clear();
 	dataStreamMap.clear();
 
+	updateBlockInfo();
+
+	streamJob.reset();
+	streamContexts.clear();
+
     if (dataStreams.size() == 0)
         return;
 
@@ -1133,6 +1148,9 @@ void GenericProcessor::updateChannelIndexMaps()
 
 		dataStreamMap[streamId] = stream;
 	}
+
+	if (parallelStreamProcessing)
+		createStreamContexts();
 	
     if (latencyMeter != nullptr)
         latencyMeter->update(getDataStreams());
@@ -1150,20 +1168,70 @@ void GenericProcessor::getDefaultEventInfo(Array<DefaultEventInfo>& events, int
 }
 
 
+void GenericProcessor::updateBlockInfo()
+{
+	blockInfo.clearQuick();
+	blockInfoIndex.clearQuick();
+
+	if (dataStreams.size() == 0)
+		return;
+
+	uint16 minId = dataStreams[0]->getStreamId();
+	uint16 maxId = minId;
+
+	for (auto stream : dataStreams)
+	{
+		minId = jmin(minId, stream->getStreamId());
+		maxId = jmax(maxId, stream->getStreamId());
+	}
+
+	firstBlockInfoStreamId = minId;
+	blockInfoIndex.insertMultiple(0, -1, maxId - minId + 1);
+
+	for (int i = 0; i < dataStreams.size(); i++)
+	{
+		BlockInfo info;
+		info.streamId = dataStreams[i]->getStreamId();
+
+		blockInfo.add(info);
+		blockInfoIndex.set(info.streamId - minId, i);
+	}
+}
+
+GenericProcessor::BlockInfo* GenericProcessor::findBlockInfo(uint16 streamId)
+{
+	const int offset = int(streamId) - int(firstBlockInfoStreamId);
+
+	if (offset < 0 || offset >= blockInfoIndex.size())
+		return nullptr;
+
+	const int index = blockInfoIndex.getUnchecked(offset);
+
+	return index >= 0 ? &blockInfo.getReference(index) : nullptr;
+}
+
+const GenericProcessor::BlockInfo& GenericProcessor::getBlockInfo(uint16 streamId) const
+{
+	const BlockInfo* info = const_cast<GenericProcessor*>(this)->findBlockInfo(streamId);
+
+	jassert(info != nullptr);
+
+	return info != nullptr ? *info : emptyBlockInfo;
+}
+
 uint32 GenericProcessor::getNumSamplesInBlock(uint16 streamId) const
 {
-    
-	return numSamplesInBlock.at(streamId);
+	return getBlockInfo(streamId).numSamples;
 }
 
 int64 GenericProcessor::getFirstSampleNumberForBlock(uint16 streamId) const
 {
-	return startSamplesForBlock.at(streamId);
+	return getBlockInfo(streamId).firstSampleNumber;
 }
 
 double GenericProcessor::getFirstTimestampForBlock(uint16 streamId) const
 {
-    return startTimestampsForBlock.at(streamId);
+    return getBlockInfo(streamId).firstTimestamp;
 }
 
 
@@ -1173,7 +1241,7 @@ void GenericProcessor::setTimestampAndSamples(int64 sampleNumber,
                                               uint16 streamId)
 {
     
-	HeapBlock<char> data;
+	char data[TIMESTAMP_AND_SAMPLES_SIZE];
 	size_t dataSize = SystemEvent::fillTimestampAndSamplesData(data, 
 		this, 
 		streamId,
@@ -1182,15 +1250,176 @@ void GenericProcessor::setTimestampAndSamples(int64 sampleNumber,
 		nSamples,
 		m_initialProcessTime);
 
-    
+	m_currentMidiBuffer->addEvent(data, int(dataSize), 0);
+
+	//since the processor generating the timestamp won't get the event, store the block info here
+	if (BlockInfo* info = findBlockInfo(streamId))
+	{
+		info->firstTimestamp = timestamp;
+		info->firstSampleNumber = sampleNumber;
+		info->numSamples = nSamples;
+		info->processStartTime = m_initialProcessTime;
+		info->isValid = true;
+	}
+
+}
+
+class GenericProcessor::StreamJob : public RealtimeWorkerPool::Job
+{
+public:
+	StreamJob(GenericProcessor* processor_) : processor(processor_) { }
+
+	void runTask(int index) override
+	{
+		processor->runStreamTask(processor->streamContexts.getUnchecked(index));
+	}
+
+private:
+	GenericProcessor* processor;
+};
+
+GenericProcessor::StreamContext*& GenericProcessor::activeStreamContext()
+{
+	static thread_local StreamContext* context = nullptr;
+
+	return context;
+}
+
+GenericProcessor::StreamContext* GenericProcessor::getActiveStreamContext() const
+{
+	StreamContext* context = activeStreamContext();
+
+	if (context != nullptr && context->processor == this)
+		return context;
+
+	return nullptr;
+}
+
+void GenericProcessor::setParallelStreamProcessing(bool shouldProcessInParallel)
+{
+	parallelStreamProcessing = shouldProcessInParallel;
+}
+
+std::unique_ptr<RealtimeWorkerPool>& GenericProcessor::sharedStreamWorkers()
+{
+	static std::unique_ptr<RealtimeWorkerPool> workers;
+
+	return workers;
+}
+
+void GenericProcessor::setParallelStreamProcessingEnabled(bool shouldBeEnabled)
+{
+	if (shouldBeEnabled == isParallelStreamProcessingEnabled())
+		return;
+
+	// the thread calling process() takes one of the streams
+	const int numWorkers = SystemStats::getNumCpus() - 1;
+
+	if (shouldBeEnabled && numWorkers > 0)
+		sharedStreamWorkers() = std::make_unique<RealtimeWorkerPool>("Stream Worker", numWorkers);
+	else
+		sharedStreamWorkers().reset();
+}
+
+bool GenericProcessor::isParallelStreamProcessingEnabled()
+{
+	return sharedStreamWorkers() != nullptr;
+}
+
+float* GenericProcessor::getStreamWritePointer(int channel) const
+{
+	jassert(currentStreamChannels != nullptr);
+
+	return currentStreamChannels[channel];
+}
+
+void GenericProcessor::createStreamContexts()
+{
+	if (dataStreams.size() < 2)
+		return;
+
+	for (auto stream : dataStreams)
+	{
+		StreamContext* context = new StreamContext();
+		context->processor = this;
+		context->stream = stream;
+		context->eventBuffer.ensureSize(EventArena::DEFAULT_CAPACITY);
+		context->firstTTLState = nullptr;
+		context->lastTTLState = nullptr;
+
+		streamContexts.add(context);
+	}
 
-	m_currentMidiBuffer->addEvent(data, dataSize, 0);
+	streamJob = std::make_unique<StreamJob>(this);
+}
+
+void GenericProcessor::runStreamTask(StreamContext* context)
+{
+	if (!(*context->stream)["enable_stream"])
+		return;
+
+	activeStreamContext() = context;
+
+	RealtimeSafetyScope realtimeSafetyScope(nodeId, context->stream->getStreamId());
+
+	processStream(context->stream->getStreamId(), *currentStreamBuffer);
+
+	activeStreamContext() = nullptr;
+}
+
+void GenericProcessor::processStreamsInParallel(AudioBuffer<float>& buffer)
+{
+	// marks the buffer as not clear once, before processStream() runs on several threads
+	currentStreamChannels = buffer.getArrayOfWritePointers();
+
+	RealtimeWorkerPool* workers = sharedStreamWorkers().get();
+
+	if (workers == nullptr || streamContexts.isEmpty())
+	{
+		for (auto stream : dataStreams)
+		{
+			if (!(*stream)["enable_stream"])
+				continue;
+
+			RealtimeSafetyScope realtimeSafetyScope(nodeId, stream->getStreamId());
+
+			processStream(stream->getStreamId(), buffer);
+		}
+
+		currentStreamChannels = nullptr;
+		return;
+	}
 
-	//since the processor generating the timestamp won't get the event, add it to the map
-    startTimestampsForBlock[streamId] = timestamp;
-    startSamplesForBlock[streamId] = sampleNumber;
-	processStartTimes[streamId] = m_initialProcessTime;
+	for (auto context : streamContexts)
+	{
+		context->eventBuffer.clear();
+		context->eventArena.reset();
+		context->firstTTLState = nullptr;
+		context->lastTTLState = nullptr;
+	}
+
+	currentStreamBuffer = &buffer;
+
+	// another processor is using the workers (parallel rendering), so run the streams here
+	if (!workers->tryRun(*streamJob, streamContexts.size()))
+	{
+		for (int i = 0; i < streamContexts.size(); i++)
+			streamJob->runTask(i);
+	}
 
+	currentStreamBuffer = nullptr;
+	currentStreamChannels = nullptr;
+
+	// publish events in stream order, independent of which stream finished first
+	for (auto context : streamContexts)
+	{
+		if (context->eventBuffer.getNumEvents() > 0)
+			m_currentMidiBuffer->addEvents(context->eventBuffer, 0, -1, 0);
+
+		// the editor isn't thread-safe, so it's only updated from the calling thread
+		for (PendingTTLState* ttl = context->firstTTLState; ttl != nullptr; ttl = ttl->next)
+			getEditor()->setTTLState(ttl->streamId, ttl->line, ttl->state);
+	}
 }
 
 int GenericProcessor::getGlobalChannelIndex(uint16 streamId, int localIndex) const
@@ -1229,13 +1458,14 @@ int GenericProcessor::processEventBuffer()
 				uint32 nSamples = *reinterpret_cast<const uint32*>(dataptr + 24);
 				int64 initialTicks = *reinterpret_cast<const int64*>(dataptr + 28);
 
-               // if (startSamplesForBlock[sourceStreamId] > startSample)
-                //    std::cout << "GET: " << getNodeId() << " " << sourceStreamId << " " << startSamplesForBlock[sourceStreamId] << " " << startSample << std::endl;
-				
-                startSamplesForBlock[sourceStreamId] = startSample;
-                startTimestampsForBlock[sourceStreamId] = startTimestamp;
-                numSamplesInBlock[sourceStreamId] = nSamples;
-				processStartTimes[sourceStreamId] = initialTicks;
+                if (BlockInfo* info = findBlockInfo(sourceStreamId))
+                {
+                    info->firstSampleNumber = startSample;
+                    info->firstTimestamp = startTimestamp;
+                    info->numSamples = nSamples;
+                    info->processStartTime = initialTicks;
+                    info->isValid = true;
+                }
 					
 			}
             else if (static_cast<Event::Type> (*dataptr) == Event::Type::PROCESSOR_EVENT
@@ -1267,11 +1497,11 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 
 	if (m_currentMidiBuffer->getNumEvents() > 0)
 	{
-		/** Since adding events to the buffer inside this loop could be dangerous, create a temporary event buffer
-		    so any call to addEvent will operate on it; */
-		MidiBuffer temporaryEventBuffer;
+		/** Since adding events to the buffer inside this loop could be dangerous, redirect any call
+		    to addEvent to a separate buffer, which keeps its capacity between blocks */
+		pendingEventBuffer.clear();
 		MidiBuffer* originalEventBuffer = m_currentMidiBuffer;
-		m_currentMidiBuffer = &temporaryEventBuffer;
+		m_currentMidiBuffer = &pendingEventBuffer;
 
 		for (const auto meta : *originalEventBuffer) {
 
@@ -1279,6 +1509,8 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 			uint16 sourceStreamId = EventBase::getStreamId(meta.data);
 			uint16 sourceChannelIdx = EventBase::getChannelIndex(meta.data);
 
+			RealtimeSafetyScope realtimeSafetyScope(nodeId, sourceStreamId);
+
 			if (EventBase::getBaseType(meta.data) == Event::Type::PROCESSOR_EVENT)
 			{
                 
@@ -1286,9 +1518,9 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
                 {
                     const EventChannel* eventChannel = getEventChannel(sourceProcessorId, sourceStreamId, sourceChannelIdx);
                     
-                    if (eventChannel != nullptr)
+                    if (eventChannel != nullptr && eventChannel->getType() == EventChannel::TTL)
                     {
-                        handleTTLEvent(TTLEvent::deserialize(meta.data, eventChannel));
+                        handleTTLEventView(TTLEventView(meta.data, eventChannel));
                     }
                 }
 
@@ -1299,7 +1531,9 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 
                 if (spikeChannel != nullptr)
                 {
-                    handleSpike(Spike::deserialize(meta.data, spikeChannel));
+                    /* Like Spike::setSortedId(), the view may write back into the packet */
+                    SpikeView spike(const_cast<uint8*>(meta.data), spikeChannel);
+                    handleSpikeView(spike);
                 }
 					
 			}
@@ -1308,9 +1542,9 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 		// been added here, copy them to the original buffer
 		m_currentMidiBuffer = originalEventBuffer;
 
-		if (temporaryEventBuffer.getNumEvents() > 0)
+		if (pendingEventBuffer.getNumEvents() > 0)
 		{
-			m_currentMidiBuffer->addEvents(temporaryEventBuffer, 0, -1, 0);
+			m_currentMidiBuffer->addEvents(pendingEventBuffer, 0, -1, 0);
 		}
 			
 		return 0;
@@ -1319,15 +1553,29 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 	return -1;
 }
 
+void GenericProcessor::handleTTLEventView(const TTLEventView& event)
+{
+	handleTTLEvent(event.toTTLEvent());
+}
+
+void GenericProcessor::handleSpikeView(SpikeView& spike)
+{
+	handleSpike(spike.toSpike());
+}
+
 void GenericProcessor::addEvent(const Event* event, int sampleNum)
 {
 	size_t size = event->getChannelInfo()->getDataSize() + event->getChannelInfo()->getTotalEventMetadataSize() + EVENT_BASE_SIZE;
+
+	StreamContext* context = getActiveStreamContext();
 	
-	HeapBlock<char> buffer(size);
+	void* buffer = context != nullptr ? context->eventArena.allocate(size) : eventArena.allocate(size);
 
 	event->serialize(buffer, size);
 
-	m_currentMidiBuffer->addEvent(buffer, size, sampleNum >= 0 ? sampleNum : 0);
+	MidiBuffer* eventBuffer = context != nullptr ? &context->eventBuffer : m_currentMidiBuffer;
+
+	eventBuffer->addEvent(buffer, int(size), sampleNum >= 0 ? sampleNum : 0);
     
     if (event->getBaseType() == Event::Type::PROCESSOR_EVENT)
     {
@@ -1335,15 +1583,46 @@ void GenericProcessor::addEvent(const Event* event, int sampleNum)
         {
             
             const uint8* dataptr = reinterpret_cast<const uint8*>(event->getRawDataPointer());
-            
-            getEditor()->setTTLState(event->getStreamId(),
-                                     *(dataptr),
-                                     *(dataptr+1));
+
+            if (context != nullptr)
+            {
+                PendingTTLState* ttl = static_cast<PendingTTLState*>(context->eventArena.allocate(sizeof(PendingTTLState)));
+                ttl->streamId = event->getStreamId();
+                ttl->line = *(dataptr);
+                ttl->state = *(dataptr+1);
+                ttl->next = nullptr;
+
+                if (context->lastTTLState != nullptr)
+                    context->lastTTLState->next = ttl;
+                else
+                    context->firstTTLState = ttl;
+
+                context->lastTTLState = ttl;
+            }
+            else
+            {
+                getEditor()->setTTLState(event->getStreamId(),
+                                         *(dataptr),
+                                         *(dataptr+1));
+            }
         }
     }
     
 }
 
+void GenericProcessor::addTTLEvent(const EventChannel* channel, int64 sampleNumber, uint8 line, bool state, uint64 word, int sampleNum)
+{
+	char packet[TTL_EVENT_SIZE];
+
+	TTLEvent::serializeTTLEvent(channel, sampleNumber, line, state, word, packet);
+
+	StreamContext* context = getActiveStreamContext();
+
+	MidiBuffer* eventBuffer = context != nullptr ? &context->eventBuffer : m_currentMidiBuffer;
+
+	eventBuffer->addEvent(packet, TTL_EVENT_SIZE, sampleNum >= 0 ? sampleNum : 0);
+}
+
 void GenericProcessor::addTTLChannel(String name)
 {
     if (dataStreams.size() == 0)
@@ -1385,7 +1664,7 @@ void GenericProcessor::flipTTLState(int sampleIndex, int lineIndex)
 	bool currentState = ttlLineStates[lineIndex];
     ttlLineStates.set(lineIndex, !currentState);
 
-	int64 startSample = startSamplesForBlock[ttlEventChannel->getStreamId()] + sampleIndex;
+	int64 startSample = getFirstSampleNumberForBlock(ttlEventChannel->getStreamId()) + sampleIndex;
 
 	TTLEventPtr eventPtr = TTLEvent::createTTLEvent(ttlEventChannel, startSample, lineIndex, !currentState);
 
@@ -1399,7 +1678,7 @@ void GenericProcessor::setTTLState(int sampleIndex, int lineIndex, bool state)
 
     ttlLineStates.set(lineIndex, state);
 
-    int64 startSample = startSamplesForBlock[ttlEventChannel->getStreamId()] + sampleIndex;
+    int64 startSample = getFirstSampleNumberForBlock(ttlEventChannel->getStreamId()) + sampleIndex;
 
     TTLEventPtr eventPtr = TTLEvent::createTTLEvent(ttlEventChannel, startSample, lineIndex, state);
 
@@ -1426,27 +1705,83 @@ void GenericProcessor::addSpike(const Spike* spike)
 		+ spike->spikeChannel->getTotalEventMetadataSize()
 		+ spike->spikeChannel->getNumChannels() * sizeof(float);
 
-	HeapBlock<char> buffer(size);
+	StreamContext* context = getActiveStreamContext();
+
+	void* buffer = context != nullptr ? context->eventArena.allocate(size) : eventArena.allocate(size);
 
 	spike->serialize(buffer, size);
 
-	m_currentMidiBuffer->addEvent(buffer, size, 0);
+	MidiBuffer* eventBuffer = context != nullptr ? &context->eventBuffer : m_currentMidiBuffer;
+
+	eventBuffer->addEvent(buffer, int(size), 0);
 }
 
 
 void GenericProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& eventBuffer)
 {
+	TraceSpan span("processBlock", nodeId);
+
+	RealtimeSafetyScope realtimeSafetyScope(nodeId);
+
+	const int64 blockStartTicks = Time::getHighResolutionTicks();
+
+	if (processTimingResetRequested.exchange(false))
+	{
+		processTimes.reset();
+		numProcessOverruns = 0;
+	}
     
 	if (isSource())
 		m_initialProcessTime = Time::getHighResolutionTicks();
 
 	m_currentMidiBuffer = &eventBuffer;
+
+	eventArena.reset();
     
 	processEventBuffer(); // extract buffer sizes and timestamps,
 
 	process(buffer);
     
-	latencyMeter->setLatestLatency(processStartTimes);
+	latencyMeter->setLatestLatency(blockInfo);
+
+	const int64 elapsedNs = int64(double(Time::getHighResolutionTicks() - blockStartTicks)
+		* 1.0e9 / double(Time::getHighResolutionTicksPerSecond()));
+
+	processTimes.record(elapsedNs);
+
+	const int64 budgetNs = processBudgetNs.load(std::memory_order_relaxed);
+
+	if (budgetNs > 0 && elapsedNs > budgetNs)
+		numProcessOverruns++;
+}
+
+GenericProcessor::ProcessTimingStats GenericProcessor::getProcessTimingStats() const
+{
+	ProcessTimingStats stats;
+
+	stats.numBlocks = processTimes.getCount();
+	stats.meanMs = processTimes.getMean() / 1.0e6;
+	stats.p50Ms = double(processTimes.getPercentile(0.5)) / 1.0e6;
+	stats.p99Ms = double(processTimes.getPercentile(0.99)) / 1.0e6;
+	stats.maxMs = double(processTimes.getMax()) / 1.0e6;
+	stats.budgetMs = double(processBudgetNs.load()) / 1.0e6;
+	stats.meanBudgetShare = stats.budgetMs > 0 ? stats.meanMs / stats.budgetMs : 0.0;
+	stats.p99BudgetShare = stats.budgetMs > 0 ? stats.p99Ms / stats.budgetMs : 0.0;
+	stats.numOverruns = numProcessOverruns.load();
+
+	return stats;
+}
+
+void GenericProcessor::resetProcessTimingStats()
+{
+	AudioComponent* audio = AccessClass::getAudioComponent();
+
+	if (audio != nullptr && audio->getSampleRate() > 0)
+		processBudgetNs = int64(double(audio->getBufferSize()) * 1.0e9 / audio->getSampleRate());
+	else
+		processBudgetNs = 0;
+
+	processTimingResetRequested = true;
 }
 
 Array<const EventChannel*> GenericProcessor::getEventChannels()
@@ -2011,45 +2346,43 @@ void LatencyMeter::update(Array<const DataStream*>dataStreams)
 	latencies.clear();
 
 	for (auto dataStream : dataStreams)
-		latencies[dataStream->getStreamId()].insertMultiple(0, 0, 5);
+		latencies[dataStream->getStreamId()].insertMultiple(0, 0, NUM_LATENCY_SAMPLES);
 
 }
 
-void LatencyMeter::setLatestLatency(std::map<uint16, juce::int64>& processStartTimes)
+void LatencyMeter::setLatestLatency(const Array<GenericProcessor::BlockInfo>& blockInfo)
 {
 
 	if (counter % 10 == 0) // update latency estimate every 10 process blocks
 	{
 
-		std::map<uint16, juce::int64>::iterator it = processStartTimes.begin();
-
 		int64 currentTime = Time::getHighResolutionTicks();
 
-		while (it != processStartTimes.end())
+		for (const auto& info : blockInfo)
 		{
-			latencies[it->first].set(counter % 5, currentTime - it->second);
-			it++;
+			if (info.isValid)
+				latencies[info.streamId].set((counter / 10) % NUM_LATENCY_SAMPLES, currentTime - info.processStartTime);
 		}
 
 		if (counter % 50 == 0) // compute mean latency every 50 process blocks
 		{
 
-			std::map<uint16, juce::int64>::iterator it = processStartTimes.begin();
-
-			while (it != processStartTimes.end())
+			for (const auto& info : blockInfo)
 			{
+				if (!info.isValid)
+					continue;
+
 				float totalLatency = 0.0f;
 
-				for (int i = 0; i < 10; i++)
-					totalLatency += float(latencies[it->first][i]);
+				for (int i = 0; i < NUM_LATENCY_SAMPLES; i++)
+					totalLatency += float(latencies[info.streamId][i]);
 
 				totalLatency = totalLatency 
+					/ float(NUM_LATENCY_SAMPLES)
 					/ float(Time::getHighResolutionTicksPerSecond())
 					* 1000.0f;
 
-				processor->getEditor()->setMeanLatencyMs(it->first, totalLatency);
-
-				it++;
+				processor->getEditor()->setMeanLatencyMs(info.streamId, totalLatency);
 
 			}
 			
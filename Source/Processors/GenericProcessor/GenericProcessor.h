@@ -41,8 +41,11 @@
 #include "../Settings/InfoObject.h"
 
 #include "../Events/Event.h"
+#include "../Events/EventArena.h"
 #include "../Events/Spike.h"
 
+#include "TimingHistogram.h"
+
 #include <time.h>
 #include <stdio.h>
 #include <map>
@@ -65,6 +68,8 @@ class Spike;
 
 class LatencyMeter;
 
+class RealtimeWorkerPool;
+
 using namespace Plugin;
 
 namespace AccessClass
@@ -90,6 +95,7 @@ class PLUGIN_API GenericProcessor   : public GenericProcessorBase
     friend class GenericEditor;
     friend class Splitter;
     friend class Merger;
+    friend class LatencyMeter;
 
 public:
     /** Constructor (sets the processor's name). */
@@ -258,6 +264,40 @@ public:
     /** Indicates whether a source node is connected to a processor (used for mergers).*/
     virtual bool stillHasSource() const { return true; }
 
+    // --------------------------------------------
+    //     PROCESS TIMING
+    // --------------------------------------------
+
+    /** Summary of the wall-clock time spent in processBlock() since the last reset. */
+    struct ProcessTimingStats
+    {
+        /** Number of blocks measured */
+        int64 numBlocks;
+
+        /** Process time statistics, in milliseconds */
+        double meanMs;
+        double p50Ms;
+        double p99Ms;
+        double maxMs;
+
+        /** Duration of one audio callback, in milliseconds (0 if unknown) */
+        double budgetMs;
+
+        /** Fraction of the callback budget used by this processor (mean and 99th percentile) */
+        double meanBudgetShare;
+        double p99BudgetShare;
+
+        /** Number of blocks in which this processor alone took longer than the callback budget */
+        int64 numOverruns;
+    };
+
+    /** Returns the process time statistics; safe to call from any thread while acquisition is active. */
+    ProcessTimingStats getProcessTimingStats() const;
+
+    /** Clears the process time statistics before the next block and reads the callback
+        budget from the audio device. Called by the ProcessorGraph when acquisition starts. */
+    void resetProcessTimingStats();
+
     // --------------------------------------------
     //     PARAMETERS
     // --------------------------------------------
@@ -461,6 +501,14 @@ public:
     
     static Plugin::Processor::Type typeFromString(String typeName);
 
+    /** Turns the worker threads used by processStreamsInParallel() on or off for every
+        processor. The threads are shared by all processors, so at most NumCpus - 1 are
+        created. Off by default; call from the message thread while acquisition is stopped. */
+    static void setParallelStreamProcessingEnabled(bool shouldBeEnabled);
+
+    /** Returns true if processStreamsInParallel() spreads streams across worker threads */
+    static bool isParallelStreamProcessingEnabled();
+
     String getDisplayName() { return m_name; }
 
     void updateDisplayName(String name);
@@ -497,6 +545,32 @@ protected:
     //     SAMPLES + TIMESTAMPS
     // --------------------------------------------
 
+    /** Describes the current block of one data stream */
+    struct BlockInfo
+    {
+        /** The stream this block belongs to */
+        uint16 streamId = 0;
+
+        /** Sample number of the first sample in the block */
+        int64 firstSampleNumber = 0;
+
+        /** Timestamp (in seconds) of the first sample in the block */
+        double firstTimestamp = 0.0;
+
+        /** Number of samples in the block */
+        uint32 numSamples = 0;
+
+        /** High-resolution ticks at the start of the processing cycle that produced the block */
+        int64 processStartTime = 0;
+
+        /** False until a block has been received for this stream */
+        bool isValid = false;
+    };
+
+    /** Returns the current block's sample numbers and timestamps for a given stream.
+        Cheaper than calling the individual getters inside per-channel loops. */
+    const BlockInfo& getBlockInfo(uint16 streamId) const;
+
     /** Used to get the number of samples available in a current block, for a given stream */
     uint32 getNumSamplesInBlock(uint16 streamId) const;
 
@@ -517,6 +591,38 @@ protected:
     // --------------------------------------------
     int getGlobalChannelIndex(uint16 streamId, int localIndex) const;
 
+    // --------------------------------------------
+    //     PARALLEL STREAM PROCESSING
+    // --------------------------------------------
+
+    /** Processes a single data stream; called by processStreamsInParallel() once for
+        every enabled stream. Implementations must only read and write the channels and
+        settings that belong to streamId, since other streams may be processed at the same
+        time on different threads. Events added here are held back until all streams are
+        done (see processStreamsInParallel()). */
+    virtual void processStream(uint16 streamId, AudioBuffer<float>& continuousBuffer) { }
+
+    /** Optional helper for process(): runs processStream() for each enabled data stream
+        and returns once every stream is finished. If parallel stream processing is on,
+        the streams are spread across the shared worker threads; events, TTL events
+        and spikes added by processStream() are then appended to the outgoing buffer in
+        data stream order, so the event order does not depend on thread scheduling.
+        Otherwise the streams are processed one after another on the calling thread.
+
+        checkForEvents() must be called before this method, not from processStream().
+    */
+    void processStreamsInParallel(AudioBuffer<float>& continuousBuffer);
+
+    /** Lets processStreamsInParallel() use the shared worker threads when they are enabled
+        (see setParallelStreamProcessingEnabled()). Takes effect the next time the channel
+        maps are updated. Off by default; call from the constructor. */
+    void setParallelStreamProcessing(bool shouldProcessInParallel);
+
+    /** Returns a channel of the buffer passed to processStreamsInParallel(). Use this inside
+        processStream() instead of the buffer's write methods, which also update state
+        shared by all streams. */
+    float* getStreamWritePointer(int channel) const;
+
     // --------------------------------------------
     //     HANDLING EVENTS AND MESSAGES
     // --------------------------------------------
@@ -531,10 +637,20 @@ protected:
 	Set respondToSpikes to true if the processor should also search for spikes*/
 	virtual int checkForEvents(bool respondToSpikes = false);
 
-	/** Allows processors to respond to incoming TTL events; called by checkForEvents() */
+	/** Allows processors to respond to incoming TTL events; called by checkForEvents().
+	    The view points into the event buffer and does not allocate. The default
+	    implementation creates a TTLEvent object and passes it to handleTTLEvent(). */
+	virtual void handleTTLEventView(const TTLEventView& event);
+
+	/** Allows processors to respond to incoming spikes; called by checkForEvents(true).
+	    The view points into the event buffer and does not allocate. The default
+	    implementation creates a Spike object and passes it to handleSpike(). */
+	virtual void handleSpikeView(SpikeView& spike);
+
+	/** Allows processors to respond to incoming TTL events; called by the default handleTTLEventView() */
 	virtual void handleTTLEvent(TTLEventPtr event) { }
 
-	/** Allows processors to respond to incoming spikes; called by checkForEvents(true) */
+	/** Allows processors to respond to incoming spikes; called by the default handleSpikeView() */
 	virtual void handleSpike(SpikePtr spike) { }
 
 	/** Returns info about the default events a specific subprocessor generates.
@@ -549,6 +665,10 @@ protected:
     /** Add an event (usually a TTLEventPtr) to the processing buffer */
     void addEvent(const Event* event, int sampleNum);
 
+    /** Adds a TTL event to the processing buffer without creating a TTLEvent object.
+        Unlike addEvent(), this doesn't update the editor's TTL monitor. */
+    void addTTLEvent(const EventChannel* channel, int64 sampleNumber, uint8 line, bool state, uint64 word, int sampleNum);
+
     /** Sends a TEXT event to all other processors, via the MessageCenter, while acquisition is active.
         If recording is active, this message will be recorded */
     void broadcastMessage(String msg);
@@ -650,17 +770,77 @@ private:
     /** Clears the settings arrays.*/
     void clearSettings();
 
-    /** Map between stream IDs and buffer sample counts. */
-	std::map<uint16, uint32> numSamplesInBlock;
+    /** Rebuilds blockInfo and blockInfoIndex for the current data streams. */
+    void updateBlockInfo();
 
-    /** Map between stream IDs and buffer timestamps. */
-	std::map<uint16, double> startTimestampsForBlock;
-    
-    /** Map between stream IDs and buffer timestamps. */
-    std::map<uint16, int64> startSamplesForBlock;
+    /** Returns the BlockInfo for a stream ID, or nullptr if this processor doesn't have that stream. */
+    BlockInfo* findBlockInfo(uint16 streamId);
+
+    /** Current block info for each data stream, in the same order as dataStreams. */
+    Array<BlockInfo> blockInfo;
+
+    /** Index into blockInfo for each stream ID, offset by firstBlockInfoStreamId (-1 if absent). */
+    Array<int> blockInfoIndex;
+
+    /** Lowest stream ID covered by blockInfoIndex. */
+    uint16 firstBlockInfoStreamId;
+
+    /** Returned by getBlockInfo() for streams this processor doesn't have. */
+    const BlockInfo emptyBlockInfo;
+
+    /** A TTL line change to show in the editor once all streams are done. */
+    struct PendingTTLState
+    {
+        uint16 streamId;
+        uint8 line;
+        bool state;
+        PendingTTLState* next;
+    };
+
+    /** Holds the events added by processStream() for one data stream. */
+    struct StreamContext
+    {
+        GenericProcessor* processor;
+        DataStream* stream;
+        MidiBuffer eventBuffer;
+        EventArena eventArena;
+
+        /** TTL states for the editor, allocated from eventArena */
+        PendingTTLState* firstTTLState;
+        PendingTTLState* lastTTLState;
+    };
+
+    /** Runs processStream() for the stream with the same index as the task. */
+    class StreamJob;
+
+    /** Creates the stream contexts used by processStreamsInParallel(). */
+    void createStreamContexts();
+
+    /** Calls processStream() for one stream, routing its events to the stream's context. */
+    void runStreamTask(StreamContext* context);
 
-    /** Map between stream IDs and start time of process callbacks. */
-    std::map<uint16, int64> processStartTimes;
+    /** Returns the context of the stream being processed on the calling thread,
+        or nullptr if this thread is not inside processStream() for this processor. */
+    StreamContext* getActiveStreamContext() const;
+
+    /** The context of the stream being processed on the calling thread. */
+    static StreamContext*& activeStreamContext();
+
+    /** One context per data stream, in the same order as dataStreams. */
+    OwnedArray<StreamContext> streamContexts;
+
+    /** Set by setParallelStreamProcessing(). */
+    bool parallelStreamProcessing;
+
+    /** Runs one task per stream context; null if there are no contexts. */
+    std::unique_ptr<StreamJob> streamJob;
+
+    /** Worker threads shared by every processor; null unless parallel stream processing is enabled. */
+    static std::unique_ptr<RealtimeWorkerPool>& sharedStreamWorkers();
+
+    /** The buffer passed to processStreamsInParallel(), and its channels. */
+    AudioBuffer<float>* currentStreamBuffer;
+    float** currentStreamChannels;
 
     /** First software timestamp of process() callback. */
 	juce::int64 m_initialProcessTime;
@@ -692,6 +872,12 @@ private:
 	std::map<int,bool> m_needsToSendTimestampMessages;
 
 	MidiBuffer* m_currentMidiBuffer;
+
+	/** Holds events added while checkForEvents() iterates over m_currentMidiBuffer */
+	MidiBuffer pendingEventBuffer;
+
+	/** Scratch memory for serializing events; reset at the start of every block */
+	EventArena eventArena;
     MidiBuffer messageCenterBuffer;
 
     typedef std::unordered_map<uint16, 
@@ -726,6 +912,18 @@ private:
 
     std::unique_ptr<LatencyMeter> latencyMeter;
 
+    /** Wall-clock duration of each processBlock() call, in nanoseconds */
+    TimingHistogram processTimes;
+
+    /** Number of processBlock() calls that took longer than processBudgetNs */
+    std::atomic<int64> numProcessOverruns;
+
+    /** Duration of one audio callback, in nanoseconds */
+    std::atomic<int64> processBudgetNs;
+
+    /** Set by resetProcessTimingStats(); the histogram is cleared by the audio thread */
+    std::atomic<bool> processTimingResetRequested;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GenericProcessor);
 };
 
@@ -741,7 +939,7 @@ public:
     LatencyMeter(GenericProcessor* processor);
 
     /** Sets the latest latency values for each data stream */
-    void setLatestLatency(std::map<uint16, juce::int64>& processStartTimes);
+    void setLatestLatency(const Array<GenericProcessor::BlockInfo>& blockInfo);
 
     /** Updates the available data streams */
     void update(Array<const DataStream*>);
@@ -749,7 +947,10 @@ public:
 private:
     int counter;
 
-    std::map<uint16, Array<int>> latencies;
+    /** Number of latency values averaged for each stream */
+    static const int NUM_LATENCY_SAMPLES = 5;
+
+    std::map<uint16, Array<int64>> latencies;
     GenericProcessor* processor;
 };
 
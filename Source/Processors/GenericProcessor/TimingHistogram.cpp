@@ -0,0 +1,133 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TimingHistogram.h"
+
+/* Number of sub-buckets per power of two is 2^SUB_BUCKET_BITS */
+static const int SUB_BUCKET_BITS = 4;
+static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+/* Upper bound of the last bucket (2^41 - 1 ns); larger values are clamped to it */
+static const int64 MAX_TRACKABLE_VALUE = (int64(1) << 41) - 1;
+
+TimingHistogram::TimingHistogram()
+{
+	reset();
+}
+
+TimingHistogram::~TimingHistogram()
+{
+}
+
+int TimingHistogram::getBucketIndex(int64 value)
+{
+	if (value < 2 * SUB_BUCKET_COUNT)
+		return int(jmax(value, int64(0)));
+
+	value = jmin(value, MAX_TRACKABLE_VALUE);
+
+	const uint64 v = uint64(value);
+
+	const int highestBit = (v >> 32) != 0 ? 32 + findHighestSetBit(uint32(v >> 32))
+	                                      : findHighestSetBit(uint32(v));
+
+	const int shift = highestBit - SUB_BUCKET_BITS;
+
+	return shift * SUB_BUCKET_COUNT + int(v >> shift);
+}
+
+int64 TimingHistogram::getBucketUpperBound(int index)
+{
+	if (index < 2 * SUB_BUCKET_COUNT)
+		return index;
+
+	const int shift = index / SUB_BUCKET_COUNT - 1;
+	const int64 mantissa = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void TimingHistogram::record(int64 nanoseconds)
+{
+	counts[getBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+	totalValue.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	if (nanoseconds > maxValue.load(std::memory_order_relaxed))
+		maxValue.store(nanoseconds, std::memory_order_relaxed);
+
+	/* Published last, so readers never see more values than bucket counts */
+	totalCount.fetch_add(1, std::memory_order_release);
+}
+
+void TimingHistogram::reset()
+{
+	for (auto& count : counts)
+		count.store(0, std::memory_order_relaxed);
+
+	totalValue.store(0, std::memory_order_relaxed);
+	maxValue.store(0, std::memory_order_relaxed);
+	totalCount.store(0, std::memory_order_release);
+}
+
+int64 TimingHistogram::getCount() const
+{
+	return totalCount.load(std::memory_order_acquire);
+}
+
+int64 TimingHistogram::getMax() const
+{
+	return maxValue.load(std::memory_order_relaxed);
+}
+
+double TimingHistogram::getMean() const
+{
+	const int64 count = getCount();
+
+	if (count == 0)
+		return 0.0;
+
+	return double(totalValue.load(std::memory_order_relaxed)) / double(count);
+}
+
+int64 TimingHistogram::getPercentile(double fraction) const
+{
+	const int64 count = getCount();
+
+	if (count == 0)
+		return 0;
+
+	const int64 target = jlimit(int64(1), count, int64(std::ceil(fraction * double(count))));
+
+	int64 seen = 0;
+
+	for (int i = 0; i < NUM_BUCKETS; i++)
+	{
+		seen += counts[i].load(std::memory_order_relaxed);
+
+		if (seen >= target)
+			return jmin(getBucketUpperBound(i), getMax());
+	}
+
+	return getMax();
+}
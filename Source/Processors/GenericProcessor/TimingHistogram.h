@@ -0,0 +1,97 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef TIMINGHISTOGRAM_H_INCLUDED
+#define TIMINGHISTOGRAM_H_INCLUDED
+
+#include <JuceHeader.h>
+
+#include "../PluginManager/OpenEphysPlugin.h"
+
+#include <atomic>
+
+
+/**
+*
+* Lock-free histogram of durations, in nanoseconds.
+*
+* Buckets are spaced like an HDR histogram: values below 32 ns get
+* one bucket each, and every power of two above that is split into 16
+* buckets, so any recorded value is reported within ~6% of its true
+* size, up to 2^41 ns (about 36 minutes). Longer durations are counted
+* in the last bucket.
+*
+* record() is wait-free and may be called from the audio thread while
+* other threads read percentiles; readers see a consistent-enough view
+* for monitoring, but not an atomic snapshot of all buckets.
+*
+* The TimingHistogram class is part of the Open Ephys Plugin API
+*
+*/
+class PLUGIN_API TimingHistogram
+{
+public:
+
+	/* Constructor */
+	TimingHistogram();
+
+	/* Destructor */
+	~TimingHistogram();
+
+	/* Adds one duration to the histogram. Only one thread should record at a time. */
+	void record(int64 nanoseconds);
+
+	/* Clears all recorded values. Must not be called while another thread records. */
+	void reset();
+
+	/* Returns the number of recorded values */
+	int64 getCount() const;
+
+	/* Returns the largest recorded value */
+	int64 getMax() const;
+
+	/* Returns the mean of the recorded values */
+	double getMean() const;
+
+	/* Returns the value below which the given fraction (0-1) of recorded values fall */
+	int64 getPercentile(double fraction) const;
+
+	static const int NUM_BUCKETS = 608;
+
+private:
+
+	/* Returns the bucket that holds a value */
+	static int getBucketIndex(int64 value);
+
+	/* Returns the largest value that falls into a bucket */
+	static int64 getBucketUpperBound(int index);
+
+	std::atomic<int64> counts[NUM_BUCKETS];
+	std::atomic<int64> totalCount;
+	std::atomic<int64> totalValue;
+	std::atomic<int64> maxValue;
+
+	JUCE_DECLARE_NON_COPYABLE(TimingHistogram);
+};
+
+#endif
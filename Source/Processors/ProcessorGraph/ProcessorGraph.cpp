@@ -44,6 +44,7 @@
 #include "../ProcessorManager/ProcessorManager.h"
 #include "../../Audio/AudioComponent.h"
 #include "../../AccessClass.h"
+#include "../../Utils/RealtimeSafetyChecker.h"
 
 std::map< ChannelKey, bool> ProcessorGraph::bufferLookupMap;
 
@@ -1443,6 +1444,9 @@ void ProcessorGraph::startAcquisition()
 
     LOGD("ProcessorGraph starting acquisition...");
 
+    if (RealtimeSafetyChecker::isEnabled())
+        RealtimeSafetyChecker::clear();
+
     for (int i = 0; i < getNumNodes(); i++)
     {
         Node* node = getNode(i);
@@ -1450,6 +1454,7 @@ void ProcessorGraph::startAcquisition()
         if (node->nodeID != NodeID(OUTPUT_NODE_ID))
         {
             GenericProcessor* p = (GenericProcessor*) node->getProcessor();
+            p->resetProcessTimingStats();
             p->startAcquisition();
 
             if (p->getEditor() != nullptr)
@@ -1484,10 +1489,46 @@ void ProcessorGraph::stopAcquisition()
 
             allClear = p->stopAcquisition();
 
+            GenericProcessor::ProcessTimingStats timing = p->getProcessTimingStats();
+
+            if (timing.numBlocks > 0)
+            {
+                LOGC(p->getName(), " (", p->getNodeId(), ") process time: p50 ", timing.p50Ms,
+                     " ms, p99 ", timing.p99Ms, " ms, max ", timing.maxMs,
+                     " ms, ", int(timing.p99BudgetShare * 100), "% of ", timing.budgetMs,
+                     " ms budget (p99), ", timing.numOverruns, " overruns in ", timing.numBlocks, " blocks");
+            }
 
         }
     }
 
+    if (RealtimeSafetyChecker::isEnabled())
+        logRealtimeSafetyViolations();
+
+}
+
+void ProcessorGraph::logRealtimeSafetyViolations()
+{
+    Array<RealtimeSafetyChecker::Violation> violations = RealtimeSafetyChecker::getViolations();
+
+    if (violations.size() == 0)
+    {
+        LOGC("Real-time safety: no allocations or locks inside processBlock()");
+        return;
+    }
+
+    for (auto& violation : violations)
+    {
+        GenericProcessor* p = getProcessorWithNodeId(violation.nodeId);
+
+        LOGC("Real-time safety: ", p != nullptr ? p->getName() : String("Unknown processor"),
+             " (", violation.nodeId, "), stream ",
+             violation.streamId >= 0 ? String(violation.streamId) : String("unknown"), ": ",
+             violation.count, " x ", RealtimeSafetyChecker::getTypeName(violation.type));
+
+        for (auto& backtrace : violation.backtraces)
+            LOGC("  sample backtrace:\n", backtrace);
+    }
 }
 
 void ProcessorGraph::setRecordState(bool isRecording)
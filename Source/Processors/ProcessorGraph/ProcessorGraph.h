@@ -210,6 +210,9 @@ private:
     /* Disconnect all processors*/
     void clearConnections();
 
+    /* Logs the allocations and locks recorded by the RealtimeSafetyChecker, per processor and stream*/
+    void logRealtimeSafetyViolations();
+
     /* Connect a source processor and a destination processor*/
     void connectProcessors(GenericProcessor* source, 
         GenericProcessor* dest,
@@ -34,11 +34,12 @@
 #include "../AudioMonitor/AudioMonitor.h"
 #include "../RecordNode/RecordNode.h"
 #include "../EventTranslator/EventTranslator.h"
+#include "../DataThreads/SyntheticDataThread.h"
 
 #include "../PlaceholderProcessor/PlaceholderProcessor.h"
 
 /** Total number of built-in processors **/
-#define BUILT_IN_PROCESSOR_COUNT 6
+#define BUILT_IN_PROCESSOR_COUNT 7
 
 namespace ProcessorManager
 {
@@ -86,6 +87,10 @@ namespace ProcessorManager
         case 5:
             description.name = "Event Translator";
             description.processorType = Plugin::Processor::UTILITY;
+            break;
+        case 6:
+            description.name = "Synthetic Source";
+            description.processorType = Plugin::Processor::SOURCE;
             break;
 		default:
 			description.name = String();
@@ -129,6 +134,10 @@ namespace ProcessorManager
         case 5:
             proc = new EventTranslator();
             proc->setProcessorType(Plugin::Processor::UTILITY);
+            break;
+        case 6:
+            proc = new SourceNode("Synthetic Source", &SyntheticDataThread::createDataThread);
+            proc->setProcessorType(Plugin::Processor::SOURCE);
             break;
 		default:
 			return nullptr;
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #include "BinaryRecording.h"
+#include "Int16Converter.h"
 
 #include "../../Settings/InfoObject.h"
 #include "../../Settings/DataStream.h"
@@ -35,13 +36,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 BinaryRecording::BinaryRecording()
 {
     m_bufferSize = MAX_BUFFER_SIZE;
-	m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
 	m_intBuffer.malloc(MAX_BUFFER_SIZE);
-    m_sampleNumberBuffer.malloc(MAX_BUFFER_SIZE);
 }
 
 BinaryRecording::~BinaryRecording() {}
 
+BinaryRecording::StreamBuffers::StreamBuffers(int size)
+{
+    resize(size);
+}
+
+void BinaryRecording::StreamBuffers::resize(int size)
+{
+    sampleNumberBuffer.malloc(size);
+    bufferSize = size;
+}
+
 String BinaryRecording::getEngineId() const
 {
 	return "BINARY";
@@ -138,14 +148,21 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         streamIndex++;
 
         String datPath = getProcessorString(ch);
-        String filename = contPath + datPath + "continuous.dat";
 
-        LOGD("Creating file: ", contPath, datPath, "sample_numbers.npy");
-        ScopedPointer<NpyFile> tFile = new NpyFile(contPath + datPath + "sample_numbers.npy", NpyType(BaseType::INT64,1));
-        m_dataTimestampFiles.add(tFile.release());
+        if (m_segmentedTimestamps)
+        {
+            LOGD("Creating file: ", contPath, datPath, "timestamp_segments.npy");
+            m_timestampSegmentFiles.add(new TimestampSegmentWriter(contPath + datPath + "timestamp_segments.npy", ch->getSampleRate()));
+        }
+        else
+        {
+            LOGD("Creating file: ", contPath, datPath, "sample_numbers.npy");
+            ScopedPointer<NpyFile> tFile = new NpyFile(contPath + datPath + "sample_numbers.npy", NpyType(BaseType::INT64,1));
+            m_dataTimestampFiles.add(tFile.release());
 
-        ScopedPointer<NpyFile> syncTimestampFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::DOUBLE,1));
-        m_dataSyncTimestampFiles.add(syncTimestampFile.release());
+            ScopedPointer<NpyFile> syncTimestampFile = new NpyFile(contPath + datPath + "timestamps.npy", NpyType(BaseType::DOUBLE,1));
+            m_dataSyncTimestampFiles.add(syncTimestampFile.release());
+        }
 
         DynamicObject::Ptr fileJSON = new DynamicObject();
         fileJSON->setProperty("folder_name", datPath.replace(File::getSeparatorString(), "/")); //to make it more system agnostic, replace separator with only one slash
@@ -156,19 +173,23 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         fileJSON->setProperty("recorded_processor", ch->getNodeName());
         fileJSON->setProperty("recorded_processor_id", ch->getNodeId());
         fileJSON->setProperty("num_channels", channelCounts[streamIndex]);
+        fileJSON->setProperty("timestamp_format", m_segmentedTimestamps ? "segments" : "samples");
 
-        ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(channelCounts[streamIndex], samplesPerBlock);
+        m_streamBuffers.add(new StreamBuffers(MAX_BUFFER_SIZE));
 
-        if (bFile->openFile(filename))
-            m_continuousFiles.add(bFile.release());
-        else
-            m_continuousFiles.add(nullptr);
+        m_continuousFiles.add(createContinuousFile(contPath + datPath, channelCounts[streamIndex]));
 
         fileJSON->setProperty("channels", multiStreamJSON.getReference(streamIndex));
 
         continuousChannelJSON.add(var(fileJSON));
     }
 
+    for (int ch = 0; ch < getNumRecordedContinuousChannels(); ch++)
+    {
+        const ContinuousChannel* channelInfo = getContinuousChannel(getGlobalIndex(ch));
+        m_streamBuffers[m_fileIndexes[ch]]->scaleFactors.add(1 / (float(0x7fff) * channelInfo->getBitVolts()));
+    }
+
     //Event data files
     String eventPath(basepath + "events" + File::getSeparatorString());
     Array<var> eventChannelJSON;
@@ -339,6 +360,16 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
 
 }
 
+SequentialBlockFile* BinaryRecording::createContinuousFile(const String& folder, int numChannels)
+{
+    ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
+
+    if (bFile->openFile(folder + "continuous.dat", m_useDirectIO))
+        return bFile.release();
+
+    return nullptr;
+}
+
 std::unique_ptr<NpyFile> BinaryRecording::createEventMetadataFile(const MetadataEventObject* channel, String filename, DynamicObject* jsonFile)
 {
     int nMetadata = channel->getEventMetadataCount();
@@ -477,6 +508,17 @@ void BinaryRecording::createChannelMetadata(const MetadataObject* channel, Dynam
 	jsonFile->setProperty("channel_metadata", jsonMetadata);
 }
 
+bool BinaryRecording::hasWriteError() const
+{
+	for (auto file : m_continuousFiles)
+	{
+		if (file != nullptr && file->hasWriteError())
+			return true;
+	}
+
+	return false;
+}
+
 void BinaryRecording::closeFiles()
 {
 
@@ -492,13 +534,14 @@ void BinaryRecording::closeFiles()
     
     m_dataTimestampFiles.clear();
     m_dataSyncTimestampFiles.clear();
+    m_timestampSegmentFiles.clear();
 
     m_spikeChannelIndexes.clear();
     m_spikeFileIndexes.clear();
 
-    m_scaledBuffer.malloc(MAX_BUFFER_SIZE);
+    m_streamBuffers.clear();
+
     m_intBuffer.malloc(MAX_BUFFER_SIZE);
-    m_sampleNumberBuffer.malloc(MAX_BUFFER_SIZE);
     m_bufferSize = MAX_BUFFER_SIZE;
 
 }
@@ -533,54 +576,97 @@ void BinaryRecording::writeContinuousData(int writeChannel,
     if (!size)
         return;
 
-    /* If our internal buffer is too small to hold the data... */
-	if (size > m_bufferSize) //shouldn't happen, but if does, this prevents crash...
-	{
-		std::cerr << "[RN] Write buffer overrun, resizing from: " << m_bufferSize << " to: " << size << std::endl;
-		m_scaledBuffer.malloc(size);
-		m_intBuffer.malloc(size);
-        m_sampleNumberBuffer.malloc(size);
-		m_bufferSize = size;
-	}
-
-    /* Convert signal from float to int w/ bitVolts scaling */
-	double multFactor = 1 / (float(0x7fff) * getContinuousChannel(realChannel)->getBitVolts());
-	FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), dataBuffer, multFactor, size);
-	AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(), size);
-
     /* Get the file index that belongs to the current recording channel */
 	int fileIndex = m_fileIndexes[writeChannel];
 
-    /* Write the data to that file */
+    /* Convert signal from float to int w/ bitVolts scaling, directly into the file's memory blocks */
+	float multFactor = m_streamBuffers[fileIndex]->scaleFactors[m_channelIndexes[writeChannel]];
+
 	m_continuousFiles[fileIndex]->writeChannel(
 		m_samplesWritten[writeChannel],
 		m_channelIndexes[writeChannel],
-		m_intBuffer.getData(),
+		dataBuffer,
+		multFactor,
         size);
     
     m_samplesWritten.set(writeChannel, m_samplesWritten[writeChannel] + size);
 
     /* If is first channel in subprocessor */
 	if (m_channelIndexes[writeChannel] == 0)
+        writeTimestamps(writeChannel, timestampBuffer, size);
+}
+
+void BinaryRecording::writeContinuousStreamData(int firstWriteChannel,
+    int numChannels,
+    const float* const* dataBuffers,
+    const double* timestampBuffer,
+    int size)
+{
+    if (!size)
+        return;
+
+    int fileIndex = m_fileIndexes[firstWriteChannel];
+    StreamBuffers* buffers = m_streamBuffers[fileIndex];
+
+    /* The whole file must be written at once, with every channel at the same position */
+    bool canInterleave = m_channelIndexes[firstWriteChannel] == 0 && numChannels == buffers->scaleFactors.size();
+
+    for (int i = 1; i < numChannels && canInterleave; i++)
+        canInterleave = m_samplesWritten[firstWriteChannel + i] == m_samplesWritten[firstWriteChannel];
+
+    if (!canInterleave)
     {
+        RecordEngine::writeContinuousStreamData(firstWriteChannel, numChannels, dataBuffers, timestampBuffer, size);
+        return;
+    }
 
-		int64 baseSampleNumber = getLatestSampleNumber(writeChannel);
+    m_continuousFiles[fileIndex]->writeChannels(
+        m_samplesWritten[firstWriteChannel],
+        dataBuffers,
+        buffers->scaleFactors.getRawDataPointer(),
+        size);
 
-		for (int i = 0; i < size; i++)
-            /* Generate int sample number */
-            m_sampleNumberBuffer[i] = baseSampleNumber + i;
+    for (int i = 0; i < numChannels; i++)
+        m_samplesWritten.set(firstWriteChannel + i, m_samplesWritten[firstWriteChannel + i] + size);
 
-        /* Write int timestamps to disc */
-		m_dataTimestampFiles[fileIndex]->writeData(m_sampleNumberBuffer, size*sizeof(int64));
-		m_dataTimestampFiles[fileIndex]->increaseRecordCount(size);
+    writeTimestamps(firstWriteChannel, timestampBuffer, size);
+}
+
+void BinaryRecording::writeTimestamps(int writeChannel, const double* timestampBuffer, int size)
+{
+    int fileIndex = m_fileIndexes[writeChannel];
 
-        //LOGD("BinaryRecording::writeSynchronizedData: ", *timestampBuffer);
-        //std::cout << timestampBuffer
+    if (m_segmentedTimestamps)
+    {
+        m_timestampSegmentFiles[fileIndex]->writeSamples(getLatestSampleNumber(writeChannel), timestampBuffer, size);
+        return;
+    }
 
-        m_dataSyncTimestampFiles[fileIndex]->writeData(timestampBuffer, size*sizeof(double));
-        m_dataSyncTimestampFiles[fileIndex]->increaseRecordCount(size);
+    /* Each stream has its own buffers, so that streams can be written from different threads */
+    StreamBuffers* buffers = m_streamBuffers[fileIndex];
 
+    /* If our internal buffer is too small to hold the data... */
+	if (size > buffers->bufferSize) //shouldn't happen, but if does, this prevents crash...
+	{
+		std::cerr << "[RN] Write buffer overrun, resizing from: " << buffers->bufferSize << " to: " << size << std::endl;
+		buffers->resize(size);
 	}
+
+	int64 baseSampleNumber = getLatestSampleNumber(writeChannel);
+
+	for (int i = 0; i < size; i++)
+        /* Generate int sample number */
+        buffers->sampleNumberBuffer[i] = baseSampleNumber + i;
+
+    /* Write int timestamps to disc */
+	m_dataTimestampFiles[fileIndex]->writeData(buffers->sampleNumberBuffer, size*sizeof(int64));
+	m_dataTimestampFiles[fileIndex]->increaseRecordCount(size);
+
+    //LOGD("BinaryRecording::writeSynchronizedData: ", *timestampBuffer);
+    //std::cout << timestampBuffer
+
+    m_dataSyncTimestampFiles[fileIndex]->writeData(timestampBuffer, size*sizeof(double));
+    m_dataSyncTimestampFiles[fileIndex]->increaseRecordCount(size);
 }
 
 void BinaryRecording::writeEvent(int eventIndex, const EventPacket& event)
@@ -650,13 +736,11 @@ void BinaryRecording::writeSpike(int electrodeIndex, const Spike* spike)
 	{
 		std::cerr << "(spike) Write buffer overrun, resizing to" << totalSamples << std::endl;
 		m_bufferSize = totalSamples;
-		m_scaledBuffer.malloc(totalSamples);
 		m_intBuffer.malloc(totalSamples);
 	}
 
 	double multFactor = 1 / (float(0x7fff) * channel->getChannelBitVolts(0));
-	FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), spike->getDataPointer(), multFactor, totalSamples);
-	AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(), totalSamples);
+	Int16Converter::convert(spike->getDataPointer(), m_intBuffer.getData(), totalSamples, multFactor);
 	rec->data->writeData(m_intBuffer.getData(), totalSamples*sizeof(int16));
 
 	int64 sampleIdx = spike->getSampleNumber();
@@ -695,10 +779,16 @@ RecordEngineManager* BinaryRecording::getEngineManager()
     EngineParameter* param;
     param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
     man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 1, "Direct I/O for continuous data (Linux only)", false);
+    man->addParameter(param);
+    param = new EngineParameter(EngineParameter::BOOL, 2, "Store sample numbers and timestamps as segments", false);
+    man->addParameter(param);
     return man;
 }
 
 void BinaryRecording::setParameter(EngineParameter& parameter)
 {
 	boolParameter(0, m_saveTTLWords);
+	boolParameter(1, m_useDirectIO);
+	boolParameter(2, m_segmentedTimestamps);
 }
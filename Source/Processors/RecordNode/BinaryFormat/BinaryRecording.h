@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "SequentialBlockFile.h"
 #include "NpyFile.h"
+#include "TimestampSegments.h"
 
 class BinaryRecording : public RecordEngine
 {
@@ -63,6 +64,13 @@ public:
 		const double* timestampBuffer,
 		int size);
 
+	/** Writes a block of continuous data for all channels of a stream at once */
+	void writeContinuousStreamData(int firstWriteChannel,
+		int numChannels,
+		const float* const* dataBuffers,
+		const double* timestampBuffer,
+		int size) override;
+
 	/** Writes an event to disk */
 	void writeEvent(int eventIndex, const EventPacket& packet);
 
@@ -72,11 +80,43 @@ public:
 	/** Writes timestamp sync texts */
 	void writeTimestampSyncText(uint64 streamId, int64 sampleNumber, float sampleRate, String text);
 
-	/** Sets an engine parameter (in this case TTL word writing bool) */
+	/** Sets an engine parameter (TTL word writing, direct I/O and timestamp segment bools) */
 	void setParameter(EngineParameter& parameter);
 
+	/** Each stream has its own files and buffers, so streams can be written in parallel */
+	bool supportsParallelWrites() const override { return true; }
+
+	/** Returns true if a block of any continuous file could not be written */
+	bool hasWriteError() const override;
+
+protected:
+
+	/** Creates the file that holds the continuous data of one stream, inside the stream's
+	    folder. Returns nullptr if the file cannot be opened. */
+	virtual SequentialBlockFile* createContinuousFile(const String& folder, int numChannels);
+
+	const int samplesPerBlock{ 4096 };
+
 private:
 
+    /** Sample number buffer and channel scale factors for a single continuous stream */
+    class StreamBuffers
+    {
+    public:
+
+        StreamBuffers(int size);
+
+        void resize(int size);
+
+        HeapBlock<int64> sampleNumberBuffer;
+        int bufferSize;
+
+        Array<float> scaleFactors;
+    };
+
+    /** Writes sample numbers and timestamps for the first channel of a stream */
+    void writeTimestamps(int writeChannel, const double* timestampBuffer, int size);
+
     class EventRecording
     {
     public:
@@ -94,11 +134,13 @@ private:
     void increaseEventCounts(EventRecording* rec);
 
     bool m_saveTTLWords{ true };
+    bool m_useDirectIO{ false };
+    bool m_segmentedTimestamps{ false };
 
-	HeapBlock<float> m_scaledBuffer;
 	HeapBlock<int16> m_intBuffer;
-	HeapBlock<int64> m_sampleNumberBuffer;
 	int m_bufferSize;
+
+	OwnedArray<StreamBuffers> m_streamBuffers;
 	int m_syncTimestampBufferSize;
 
 	Array<unsigned int> m_channelIndexes;
@@ -113,6 +155,7 @@ private:
 
 	OwnedArray<NpyFile> m_dataTimestampFiles;
 	OwnedArray<NpyFile> m_dataSyncTimestampFiles;
+	OwnedArray<TimestampSegmentWriter> m_timestampSegmentFiles;
 	std::unique_ptr<FileOutputStream> m_syncTextFile;
 
 	Array<unsigned int> m_spikeFileIndexes;
@@ -122,8 +165,5 @@ private:
     int m_experimentNum;
     Array<int64> m_samplesWritten;
 
-	const int samplesPerBlock{ 4096 };
-
-
 };
 #endif
@@ -0,0 +1,56 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef BLOCKWRITER_H
+#define BLOCKWRITER_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+
+/**
+
+    Destination for the memory blocks of a SequentialBlockFile
+
+    Blocks are obtained from allocateBlock(), filled with interleaved samples,
+    and handed back in file order with writeBlock(), which takes ownership of
+    them. Implementations decide how (and when) the data reaches the disk.
+
+ */
+
+class BlockWriter
+{
+public:
+
+    /** Destructor; must flush all blocks that have been written */
+    virtual ~BlockWriter() { }
+
+    /** Returns a zeroed block that can hold one full block of samples, or nullptr if none can be allocated */
+    virtual void* allocateBlock() = 0;
+
+    /** Appends the first numBytes of a block and takes ownership of the block */
+    virtual void writeBlock(void* block, size_t numBytes) = 0;
+
+    /** Returns true if any block could not be written */
+    virtual bool hasWriteError() const { return false; }
+};
+
+#endif // BLOCKWRITER_H
@@ -0,0 +1,246 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "DirectBlockWriter.h"
+#include "../../../Utils/Utils.h"
+
+#if JUCE_LINUX
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+/** O_DIRECT requires buffers, offsets and lengths aligned to the logical block size of the device */
+#define DIRECT_IO_ALIGNMENT 4096
+
+static size_t alignUp(size_t size)
+{
+    return (size + DIRECT_IO_ALIGNMENT - 1) & ~(size_t(DIRECT_IO_ALIGNMENT) - 1);
+}
+
+#if JUCE_LINUX
+
+struct DirectBlockWriter::PendingWrite
+{
+    struct aiocb cb;
+    void* block;
+};
+
+DirectBlockWriter::DirectBlockWriter(size_t blockSizeBytes, int maxWritesInFlight) :
+    m_fd(-1),
+    m_directIO(false),
+    m_blockSizeBytes(blockSizeBytes),
+    m_allocatedBytes(alignUp(blockSizeBytes)),
+    m_maxWritesInFlight(jmax(1, maxWritesInFlight)),
+    m_writePosition(0),
+    m_fileLength(0),
+    m_writeError(false)
+{
+    /* Blocks are padded to the alignment, so only the last one may be shorter */
+    jassert(blockSizeBytes % DIRECT_IO_ALIGNMENT == 0);
+}
+
+DirectBlockWriter::~DirectBlockWriter()
+{
+    while (!m_pendingWrites.empty())
+        reapWrites(true);
+
+    if (m_fd >= 0)
+    {
+        /* The last block is padded to the alignment boundary, so trim the file to the real data length */
+        if (ftruncate(m_fd, m_fileLength) != 0)
+            LOGE("DirectBlockWriter: unable to truncate file: ", strerror(errno));
+
+        close(m_fd);
+    }
+
+    for (auto block : m_freeBlocks)
+        free(block);
+}
+
+bool DirectBlockWriter::isSupported()
+{
+    return true;
+}
+
+bool DirectBlockWriter::openFile(const File& file)
+{
+    const char* path = file.getFullPathName().toRawUTF8();
+
+    /* Unaligned blocks would leave padding in the middle of the file */
+    if (m_blockSizeBytes % DIRECT_IO_ALIGNMENT == 0)
+        m_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+
+    m_directIO = m_fd >= 0;
+
+    if (!m_directIO)
+    {
+        /* e.g. tmpfs does not support O_DIRECT */
+        LOGD("DirectBlockWriter: O_DIRECT not available for ", file.getFullPathName(), ", using buffered writes");
+        m_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    if (m_fd < 0)
+    {
+        LOGE("DirectBlockWriter: unable to open ", file.getFullPathName(), ": ", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+void* DirectBlockWriter::allocateBlock()
+{
+    void* block = nullptr;
+
+    if (!m_freeBlocks.empty())
+    {
+        block = m_freeBlocks.back();
+        m_freeBlocks.pop_back();
+    }
+    else if (posix_memalign(&block, DIRECT_IO_ALIGNMENT, m_allocatedBytes) != 0)
+    {
+        return nullptr;
+    }
+
+    memset(block, 0, m_allocatedBytes);
+    return block;
+}
+
+void DirectBlockWriter::releaseBlock(void* block)
+{
+    m_freeBlocks.push_back(block);
+}
+
+void DirectBlockWriter::writeBlock(void* block, size_t numBytes)
+{
+    jassert(numBytes <= m_blockSizeBytes);
+
+    if (m_fd < 0 || numBytes == 0)
+    {
+        releaseBlock(block);
+        return;
+    }
+
+    reapWrites(false);
+
+    while ((int) m_pendingWrites.size() >= m_maxWritesInFlight)
+        reapWrites(true);
+
+    auto write = std::make_unique<PendingWrite>();
+    memset(&write->cb, 0, sizeof(struct aiocb));
+
+    write->block = block;
+    write->cb.aio_fildes = m_fd;
+    write->cb.aio_buf = block;
+    write->cb.aio_nbytes = m_directIO ? alignUp(numBytes) : numBytes;
+    write->cb.aio_offset = m_writePosition;
+    write->cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+
+    m_fileLength = m_writePosition + numBytes;
+    m_writePosition += write->cb.aio_nbytes;
+
+    if (aio_write(&write->cb) != 0)
+    {
+        /* Could not queue the request (e.g. EAGAIN); fall back to a blocking write */
+        if (pwrite(m_fd, block, write->cb.aio_nbytes, write->cb.aio_offset) != (ssize_t) write->cb.aio_nbytes)
+        {
+            LOGE("DirectBlockWriter: write failed: ", strerror(errno));
+            m_writeError = true;
+        }
+
+        releaseBlock(block);
+        return;
+    }
+
+    m_pendingWrites.push_back(std::move(write));
+}
+
+void DirectBlockWriter::reapWrites(bool wait)
+{
+    while (!m_pendingWrites.empty())
+    {
+        PendingWrite* write = m_pendingWrites.front().get();
+
+        int status = aio_error(&write->cb);
+
+        if (status == EINPROGRESS)
+        {
+            if (!wait)
+                return;
+
+            const struct aiocb* list[1] = { &write->cb };
+            aio_suspend(list, 1, nullptr);
+            continue;
+        }
+
+        ssize_t written = aio_return(&write->cb);
+
+        if (status != 0 || written != (ssize_t) write->cb.aio_nbytes)
+        {
+            LOGE("DirectBlockWriter: write failed at offset ", (int64) write->cb.aio_offset, ": ", strerror(status));
+            m_writeError = true;
+        }
+
+        releaseBlock(write->block);
+        m_pendingWrites.pop_front();
+
+        /* Only wait for a single write to complete */
+        wait = false;
+    }
+}
+
+#else
+
+struct DirectBlockWriter::PendingWrite {};
+
+DirectBlockWriter::DirectBlockWriter(size_t blockSizeBytes, int maxWritesInFlight) :
+    m_fd(-1),
+    m_directIO(false),
+    m_blockSizeBytes(blockSizeBytes),
+    m_allocatedBytes(alignUp(blockSizeBytes)),
+    m_maxWritesInFlight(maxWritesInFlight),
+    m_writePosition(0),
+    m_fileLength(0),
+    m_writeError(false)
+{
+}
+
+DirectBlockWriter::~DirectBlockWriter() {}
+
+bool DirectBlockWriter::isSupported() { return false; }
+
+bool DirectBlockWriter::openFile(const File&) { return false; }
+
+void* DirectBlockWriter::allocateBlock() { return nullptr; }
+
+void DirectBlockWriter::writeBlock(void*, size_t) {}
+
+void DirectBlockWriter::reapWrites(bool) {}
+
+void DirectBlockWriter::releaseBlock(void*) {}
+
+#endif
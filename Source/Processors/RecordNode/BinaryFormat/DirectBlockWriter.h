@@ -0,0 +1,104 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef DIRECTBLOCKWRITER_H
+#define DIRECTBLOCKWRITER_H
+
+#include "BlockWriter.h"
+
+#include <deque>
+#include <vector>
+
+/**
+
+    Appends fixed-size memory blocks to a file using asynchronous, unbuffered writes
+
+    Used by SequentialBlockFile on Linux as an alternative to FileOutputStream.
+    The file is opened with O_DIRECT, so blocks bypass the page cache, and each
+    block is handed to the kernel with POSIX AIO as soon as it is retired, with up
+    to maxWritesInFlight writes outstanding at any time.
+
+    Blocks must be obtained from allocateBlock() (which returns memory with the
+    alignment required by O_DIRECT) and ownership is passed back with writeBlock().
+    Blocks must be written in file order. If the file system does not support
+    O_DIRECT, the file is opened normally and writes remain asynchronous. Every
+    block except the last is written whole, so with O_DIRECT the block size must
+    be a multiple of the 4096-byte alignment.
+
+    Not thread safe; each writer must be used by a single thread at a time.
+
+ */
+
+class DirectBlockWriter : public BlockWriter
+{
+public:
+
+    /** Creates a writer for blocks of blockSizeBytes */
+    DirectBlockWriter(size_t blockSizeBytes, int maxWritesInFlight = 8);
+
+    /** Waits for all pending writes, trims the file to its written length and closes it */
+    ~DirectBlockWriter() override;
+
+    /** Returns true if direct I/O is available on this platform */
+    static bool isSupported();
+
+    /** Creates (or truncates) the file at the requested path */
+    bool openFile(const File& file);
+
+    /** Returns a zeroed, suitably aligned block of blockSizeBytes */
+    void* allocateBlock() override;
+
+    /** Appends the first numBytes of a block to the file and takes ownership of the block */
+    void writeBlock(void* block, size_t numBytes) override;
+
+    /** Returns true if a write failed or completed only partially */
+    bool hasWriteError() const override { return m_writeError; }
+
+private:
+
+    struct PendingWrite;
+
+    /** Completes finished writes; if wait is true, blocks until the oldest write has finished */
+    void reapWrites(bool wait);
+
+    /** Returns a block to the free list */
+    void releaseBlock(void* block);
+
+    int m_fd;
+    bool m_directIO;
+
+    const size_t m_blockSizeBytes;
+    const size_t m_allocatedBytes;
+    const int m_maxWritesInFlight;
+
+    int64 m_writePosition;
+    int64 m_fileLength;
+    bool m_writeError;
+
+    std::deque<std::unique_ptr<PendingWrite>> m_pendingWrites;
+    std::vector<void*> m_freeBlocks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DirectBlockWriter);
+};
+
+#endif // DIRECTBLOCKWRITER_H
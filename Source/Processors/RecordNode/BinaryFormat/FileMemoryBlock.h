@@ -23,27 +23,48 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "../../../../JuceLibraryCode/JuceHeader.h"
 
+#include "BlockWriter.h"
+
 template <class StorageType = int16>
 class FileMemoryBlock
 {
 public:
 	FileMemoryBlock(std::shared_ptr<FileOutputStream> file, int blockSize, uint64 offset) :
 		m_data(blockSize, true),
+		m_buffer(m_data.getData()),
 		m_file(file),
 		m_blockSize(blockSize),
 		m_offset(offset),
         m_finalFlushSamples(blockSize)
 	{};
 
+	/** Creates a block whose memory is owned by a BlockWriter, and handed back to it when the block is retired.
+		Check isValid() afterwards, since the writer may be out of memory. */
+	FileMemoryBlock(std::shared_ptr<BlockWriter> writer, int blockSize, uint64 offset) :
+		m_buffer(static_cast<StorageType*>(writer->allocateBlock())),
+		m_writer(writer),
+		m_blockSize(blockSize),
+		m_offset(offset),
+        m_finalFlushSamples(blockSize)
+	{};
+
 	~FileMemoryBlock() {
-		if (~m_flushed)
+		if (m_writer)
+		{
+			if (m_buffer != nullptr)
+				m_writer->writeBlock(m_buffer, m_finalFlushSamples*sizeof(StorageType));
+		}
+		else if (~m_flushed)
 		{
-			m_file->write(m_data, m_finalFlushSamples*sizeof(StorageType));
+			m_file->write(m_buffer, m_finalFlushSamples*sizeof(StorageType));
 		}
 	};
 
+	/** Returns false if the block has no memory to write to */
+	inline bool isValid() const { return m_buffer != nullptr; }
+
 	inline uint64 getOffset() { return m_offset; }
-	inline StorageType* getData() { return m_data.getData(); }
+	inline StorageType* getData() { return m_buffer; }
 	void partialFlush(size_t size)
 	{
         m_finalFlushSamples = size;
@@ -51,7 +72,9 @@ public:
 
 private:
 	HeapBlock<StorageType> m_data;
+	StorageType* m_buffer;
 	std::shared_ptr<FileOutputStream> m_file;
+	std::shared_ptr<BlockWriter> m_writer;
 	const int m_blockSize;
 	const uint64 m_offset;
     size_t m_finalFlushSamples;
@@ -0,0 +1,208 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "Int16Converter.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <immintrin.h>
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+ #include <arm_neon.h>
+#endif
+
+#define INT16_MAX_VALUE 32767.0
+
+void Int16Converter::convertScalar(const float* source, int16* dest, int numSamples, float scale, int destStride)
+{
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float scaled = source[i] * scale;
+        dest[i * destStride] = (int16) roundToInt(jlimit(-INT16_MAX_VALUE, INT16_MAX_VALUE, INT16_MAX_VALUE * scaled));
+    }
+}
+
+#if JUCE_USE_SSE_INTRINSICS
+
+/* Stores 8 packed int16s, either contiguously or one lane at a time */
+#define STORE_INT16X8(dest, stride, packed) \
+    if (stride == 1) \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), packed); \
+    else \
+    { \
+        dest[0]          = (int16) _mm_extract_epi16(packed, 0); \
+        dest[stride]     = (int16) _mm_extract_epi16(packed, 1); \
+        dest[2 * stride] = (int16) _mm_extract_epi16(packed, 2); \
+        dest[3 * stride] = (int16) _mm_extract_epi16(packed, 3); \
+        dest[4 * stride] = (int16) _mm_extract_epi16(packed, 4); \
+        dest[5 * stride] = (int16) _mm_extract_epi16(packed, 5); \
+        dest[6 * stride] = (int16) _mm_extract_epi16(packed, 6); \
+        dest[7 * stride] = (int16) _mm_extract_epi16(packed, 7); \
+    }
+
+/* Scales 2 doubles, replaces NaN with 0, saturates and rounds (using the default round-to-nearest-even mode) */
+static inline __m128i scaleAndRound(__m128d v, __m128d maxVal, __m128d minVal)
+{
+    v = _mm_mul_pd(v, maxVal);
+    v = _mm_and_pd(v, _mm_cmpord_pd(v, v));
+    v = _mm_min_pd(_mm_max_pd(v, minVal), maxVal);
+    return _mm_cvtpd_epi32(v);
+}
+
+static inline __m128i convert4(__m128 scaled, __m128d maxVal, __m128d minVal)
+{
+    __m128i lo = scaleAndRound(_mm_cvtps_pd(scaled), maxVal, minVal);
+    __m128i hi = scaleAndRound(_mm_cvtps_pd(_mm_movehl_ps(scaled, scaled)), maxVal, minVal);
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+static int convertSSE2(const float* source, int16* dest, int numSamples, float scale, int destStride)
+{
+    const __m128 gain = _mm_set1_ps(scale);
+    const __m128d maxVal = _mm_set1_pd(INT16_MAX_VALUE);
+    const __m128d minVal = _mm_set1_pd(-INT16_MAX_VALUE);
+
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        __m128i a = convert4(_mm_mul_ps(_mm_loadu_ps(source + i), gain), maxVal, minVal);
+        __m128i b = convert4(_mm_mul_ps(_mm_loadu_ps(source + i + 4), gain), maxVal, minVal);
+
+        __m128i packed = _mm_packs_epi32(a, b);
+        int16* out = dest + i * destStride;
+
+        STORE_INT16X8(out, destStride, packed);
+    }
+
+    return i;
+}
+
+#if JUCE_GCC || JUCE_CLANG
+ #define AVX_TARGET __attribute__((target("avx")))
+#else
+ #define AVX_TARGET
+#endif
+
+AVX_TARGET static inline __m128i scaleAndRoundAVX(__m256d v, __m256d maxVal, __m256d minVal)
+{
+    v = _mm256_mul_pd(v, maxVal);
+    v = _mm256_and_pd(v, _mm256_cmp_pd(v, v, _CMP_ORD_Q));
+    v = _mm256_min_pd(_mm256_max_pd(v, minVal), maxVal);
+    return _mm256_cvtpd_epi32(v);
+}
+
+AVX_TARGET static int convertAVX(const float* source, int16* dest, int numSamples, float scale, int destStride)
+{
+    const __m256 gain = _mm256_set1_ps(scale);
+    const __m256d maxVal = _mm256_set1_pd(INT16_MAX_VALUE);
+    const __m256d minVal = _mm256_set1_pd(-INT16_MAX_VALUE);
+
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(source + i), gain);
+
+        __m128i a = scaleAndRoundAVX(_mm256_cvtps_pd(_mm256_castps256_ps128(scaled)), maxVal, minVal);
+        __m128i b = scaleAndRoundAVX(_mm256_cvtps_pd(_mm256_extractf128_ps(scaled, 1)), maxVal, minVal);
+
+        __m128i packed = _mm_packs_epi32(a, b);
+        int16* out = dest + i * destStride;
+
+        STORE_INT16X8(out, destStride, packed);
+    }
+
+    _mm256_zeroupper();
+
+    return i;
+}
+
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+
+static inline int32x2_t scaleAndRound(float64x2_t v, float64x2_t maxVal, float64x2_t minVal)
+{
+    v = vmulq_f64(v, maxVal);
+    v = vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(v), vceqq_f64(v, v)));
+    v = vminq_f64(vmaxq_f64(v, minVal), maxVal);
+    return vmovn_s64(vcvtnq_s64_f64(v));
+}
+
+static int convertNEON(const float* source, int16* dest, int numSamples, float scale, int destStride)
+{
+    const float64x2_t maxVal = vdupq_n_f64(INT16_MAX_VALUE);
+    const float64x2_t minVal = vdupq_n_f64(-INT16_MAX_VALUE);
+
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        float32x4_t scaled = vmulq_n_f32(vld1q_f32(source + i), scale);
+
+        int32x4_t ints = vcombine_s32(scaleAndRound(vcvt_f64_f32(vget_low_f32(scaled)), maxVal, minVal),
+                                      scaleAndRound(vcvt_high_f64_f32(scaled), maxVal, minVal));
+
+        int16x4_t packed = vqmovn_s32(ints);
+
+        if (destStride == 1)
+        {
+            vst1_s16(dest + i, packed);
+        }
+        else
+        {
+            int16* out = dest + i * destStride;
+            vst1_lane_s16(out, packed, 0);
+            vst1_lane_s16(out + destStride, packed, 1);
+            vst1_lane_s16(out + 2 * destStride, packed, 2);
+            vst1_lane_s16(out + 3 * destStride, packed, 3);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+void Int16Converter::convert(const float* source,
+                             int16* dest,
+                             int numSamples,
+                             float scale,
+                             int destStride)
+{
+    int converted = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+    static const bool useAVX = SystemStats::hasAVX();
+
+    if (useAVX)
+        converted = convertAVX(source, dest, numSamples, scale, destStride);
+    else
+        converted = convertSSE2(source, dest, numSamples, scale, destStride);
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+    converted = convertNEON(source, dest, numSamples, scale, destStride);
+#endif
+
+    convertScalar(source + converted,
+                  dest + converted * destStride,
+                  numSamples - converted,
+                  scale,
+                  destStride);
+}
@@ -0,0 +1,63 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef INT16CONVERTER_H
+#define INT16CONVERTER_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+
+#include "../../PluginManager/PluginClass.h"
+
+/**
+
+    Converts float samples to scaled int16 samples in a single pass
+
+    The output is identical to FloatVectorOperations::copyWithMultiply()
+    followed by AudioDataConverters::convertFloatToInt16LE(): samples are
+    multiplied by the scale factor, multiplied by 0x7fff, rounded to the
+    nearest integer and saturated to +/-0x7fff (NaN is written as 0).
+
+    Uses AVX or SSE2 on x86 and NEON on 64-bit ARM, with a scalar fallback.
+    The destination can be strided, so samples can be written directly into
+    an interleaved (channel-major) block.
+
+ */
+
+class PLUGIN_API Int16Converter
+{
+public:
+
+    /** Converts numSamples floats, writing every destStride-th int16 */
+    static void convert(const float* source,
+                        int16* dest,
+                        int numSamples,
+                        float scale,
+                        int destStride = 1);
+
+private:
+
+    static void convertScalar(const float* source, int16* dest, int numSamples, float scale, int destStride);
+
+};
+
+#endif // INT16CONVERTER_H
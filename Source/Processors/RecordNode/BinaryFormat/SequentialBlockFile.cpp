@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "SequentialBlockFile.h"
+#include "Int16Converter.h"
 
 SequentialBlockFile::SequentialBlockFile(int nChannels, int samplesPerBlock) :
 m_file(nullptr),
@@ -39,6 +40,9 @@ SequentialBlockFile::~SequentialBlockFile()
 {
 	//Ensure that all remaining blocks are flushed in order. Keep the last one
 	int n = m_memBlocks.size();
+	if (n == 0)
+		return;
+
 	for (int i = 0; i < n - 1; i++)
 	{
 		m_memBlocks.remove(0);
@@ -48,7 +52,7 @@ SequentialBlockFile::~SequentialBlockFile()
 	m_memBlocks[0]->partialFlush(m_lastBlockFill * m_nChannels);
 }
 
-bool SequentialBlockFile::openFile(String filename)
+bool SequentialBlockFile::openFile(String filename, bool useDirectIO)
 {
 	File file(filename);
 	Result res = file.create();
@@ -60,22 +64,139 @@ bool SequentialBlockFile::openFile(String filename)
 		LOGD("Re-creating file: ", filename);
 	}
 
-	m_file = file.createOutputStream(streamBufferSize);
-	if (!m_file)
+	if (useDirectIO && DirectBlockWriter::isSupported())
 	{
-		LOGD("Unable to create output stream!");
-		return false;
+		auto directWriter = std::make_shared<DirectBlockWriter>(m_blockSize * sizeof(int16));
+
+		if (directWriter->openFile(file))
+			m_blockWriter = directWriter;
 	}
 
+	if (!m_blockWriter)
+	{
+		m_file = file.createOutputStream(streamBufferSize);
+		if (!m_file)
+		{
+			LOGD("Unable to create output stream!");
+			return false;
+		}
+	}
+
+	FileBlock* block = createBlock(0);
+	if (block == nullptr)
+		return false;
+
 	LOGDD("Added new FileBlock");
-	m_memBlocks.add(new FileBlock(m_file, m_blockSize, 0));
+	m_memBlocks.add(block);
+	return true;
+}
+
+bool SequentialBlockFile::openFile(std::shared_ptr<BlockWriter> writer)
+{
+	if (!writer)
+		return false;
+
+	m_blockWriter = writer;
+
+	FileBlock* block = createBlock(0);
+	if (block == nullptr)
+		return false;
+
+	m_memBlocks.add(block);
 	return true;
 }
 
+bool SequentialBlockFile::hasWriteError() const
+{
+	if (m_blockWriter)
+		return m_blockWriter->hasWriteError();
+
+	return m_file != nullptr && m_file->getStatus().failed();
+}
+
+FileBlock* SequentialBlockFile::createBlock(uint64 offset)
+{
+	if (m_blockWriter)
+	{
+		std::unique_ptr<FileBlock> block = std::make_unique<FileBlock>(m_blockWriter, m_blockSize, offset);
+
+		if (!block->isValid())
+		{
+			LOGE("SequentialBlockFile: unable to allocate a block of ", m_blockSize * sizeof(int16), " bytes");
+			return nullptr;
+		}
+
+		return block.release();
+	}
+
+	return new FileBlock(m_file, m_blockSize, offset);
+}
+
 bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data, int nSamples)
 {
+	return writeBlocks(startPos, nSamples, channel, [=](int16* blockPtr, int dataIdx, int samplesToWrite)
+	{
+		for (int i = 0; i < samplesToWrite; i++)
+		{
+			*(blockPtr + channel + i*m_nChannels) = *(data + dataIdx + i);
+		}
+	});
+}
+
+bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, const float* data, float scale, int nSamples)
+{
+	return writeBlocks(startPos, nSamples, channel, [=](int16* blockPtr, int dataIdx, int samplesToWrite)
+	{
+		Int16Converter::convert(data + dataIdx, blockPtr + channel, samplesToWrite, scale, m_nChannels);
+	});
+}
+
+bool SequentialBlockFile::writeChannels(uint64 startPos, const float* const* data, const float* scales, int nSamples)
+{
+	return writeBlocks(startPos, nSamples, -1, [=](int16* blockPtr, int dataIdx, int samplesToWrite)
+	{
+		interleaveChannels(blockPtr, data, scales, dataIdx, samplesToWrite);
+	});
+}
 
-	if (!m_file)
+void SequentialBlockFile::interleaveChannels(int16* dest, const float* const* data, const float* scales, int dataIdx, int nSamples)
+{
+	/* Convert a tile of channels into a small contiguous buffer that stays in L1, then
+	   write it out row by row, so that each output cache line is only touched once */
+	int16 tile[TRANSPOSE_TILE_CHANNELS][TRANSPOSE_TILE_SAMPLES];
+
+	for (int firstSample = 0; firstSample < nSamples; firstSample += TRANSPOSE_TILE_SAMPLES)
+	{
+		int tileSamples = jmin(TRANSPOSE_TILE_SAMPLES, nSamples - firstSample);
+
+		for (int firstChannel = 0; firstChannel < m_nChannels; firstChannel += TRANSPOSE_TILE_CHANNELS)
+		{
+			int tileChannels = jmin(TRANSPOSE_TILE_CHANNELS, m_nChannels - firstChannel);
+
+			for (int ch = 0; ch < tileChannels; ch++)
+			{
+				Int16Converter::convert(data[firstChannel + ch] + dataIdx + firstSample,
+					tile[ch],
+					tileSamples,
+					scales[firstChannel + ch]);
+			}
+
+			for (int i = 0; i < tileSamples; i++)
+			{
+				int16* row = dest + size_t(firstSample + i) * m_nChannels + firstChannel;
+
+				for (int ch = 0; ch < tileChannels; ch++)
+					row[ch] = tile[ch][i];
+			}
+		}
+	}
+}
+
+template <typename SegmentWriter>
+bool SequentialBlockFile::writeBlocks(uint64 startPos, int nSamples, int channel, SegmentWriter&& writeSegment)
+{
+
+	if (!m_file && !m_blockWriter)
 	{
 		printf("[RN]SequentialBlockFile::writeChannel returned false: (!m_file)\n");
 		return false;
@@ -83,7 +204,10 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
 
 	int bIndex = m_memBlocks.size() - 1;
 	if ((bIndex < 0) || (m_memBlocks[bIndex]->getOffset() + m_samplesPerBlock) < (startPos + nSamples))
-		allocateBlocks(startPos, nSamples);
+	{
+		if (!allocateBlocks(startPos, nSamples))
+			return false;
+	}
 
 	for (bIndex = m_memBlocks.size() - 1; bIndex >= 0; bIndex--)
 	{
@@ -109,12 +233,8 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
         int16* blockPtr = m_memBlocks[bIndex]->getData();
 		int samplesToWrite = jmin((nSamples - writtenSamples), (m_samplesPerBlock - startIdx));
 		
-        for (int i = 0; i < samplesToWrite; i++)
-		{
-
-			*(blockPtr + startMemPos + channel + i*m_nChannels) = *(data + dataIdx);
-			dataIdx++;
-		}
+        writeSegment(blockPtr + startMemPos, dataIdx, samplesToWrite);
+		dataIdx += samplesToWrite;
 		writtenSamples += samplesToWrite;
 
 		//Update the last block fill index
@@ -128,11 +248,21 @@ bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data
 		startMemPos = 0;
 		bIndex++;
 	}
-	m_currentBlock.set(channel, bIndex - 1); //store the last block a channel was written in
+
+	//store the last block a channel was written in
+	if (channel >= 0)
+	{
+		m_currentBlock.set(channel, bIndex - 1);
+	}
+	else
+	{
+		for (int i = 0; i < m_nChannels; i++)
+			m_currentBlock.set(i, bIndex - 1);
+	}
 	return true;
 }
 
-void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
+bool SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
 {
 	//First deallocate full blocks
 	//Search for the earliest unused block;
@@ -159,9 +289,13 @@ void SequentialBlockFile::allocateBlocks(uint64 startIndex, int numSamples)
 
 	for (int i = 0; i < newBlocks; i++)
 	{
+		FileBlock* block = createBlock(lastOffset + m_samplesPerBlock);
+		if (block == nullptr)
+			return false;
+
 		lastOffset += m_samplesPerBlock;
-		m_memBlocks.add(new FileBlock(m_file, m_blockSize, lastOffset));
+		m_memBlocks.add(block);
+		m_lastBlockFill = 0; //we've added a new block, so the last one will be empty
 	}
-	if (newBlocks > 0)
-		m_lastBlockFill = 0; //we've added some new blocks, so the last one will be empty
+	return true;
 }
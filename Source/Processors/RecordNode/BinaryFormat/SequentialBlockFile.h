@@ -25,12 +25,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SEQUENTIALBLOCKFILE_H
 
 #include "FileMemoryBlock.h"
+#include "DirectBlockWriter.h"
 #include "../../../Utils/Utils.h"
 
 #include "../../PluginManager/PluginClass.h"
 
 typedef FileMemoryBlock<int16> FileBlock;
 
+/** Tile size used when interleaving all channels of a stream at once (16-bit samples, 4 kB) */
+#define TRANSPOSE_TILE_CHANNELS 32
+#define TRANSPOSE_TILE_SAMPLES 64
+
 /**
  
     Writes data to a flat binary file of int16s
@@ -59,14 +64,31 @@ public:
     /** Destructor */
 	~SequentialBlockFile();
 
-    /** Opens the file at the requested path */
-	bool openFile(String filename);
+    /** Opens the file at the requested path. If useDirectIO is true and the platform
+        supports it, blocks are written asynchronously and bypass the page cache */
+	bool openFile(String filename, bool useDirectIO = false);
+
+    /** Sends all blocks to a writer that has already been opened, e.g. one that compresses them */
+	bool openFile(std::shared_ptr<BlockWriter> writer);
     
     /** Writes nSamples of data for a particular channel */
 	bool writeChannel(uint64 startPos, int channel, int16* data, int nSamples);
 
+    /** Scales nSamples of float data and writes them for a particular channel,
+        converting directly into the file blocks (see Int16Converter) */
+	bool writeChannel(uint64 startPos, int channel, const float* data, float scale, int nSamples);
+
+    /** Scales and writes nSamples for all channels at once, starting from the same position.
+        data and scales must have one entry per channel. Samples are interleaved with a tiled
+        transpose, which is much more cache-friendly than writing one channel at a time. */
+	bool writeChannels(uint64 startPos, const float* const* data, const float* scales, int nSamples);
+
+    /** Returns true if any block could not be written to the file */
+	bool hasWriteError() const;
+
 private:
 	std::shared_ptr<FileOutputStream> m_file;
+	std::shared_ptr<BlockWriter> m_blockWriter;
 	const int m_nChannels;
 	const int m_samplesPerBlock;
 	const int m_blockSize;
@@ -74,8 +96,20 @@ private:
 	Array<int> m_currentBlock;
 	size_t m_lastBlockFill;
 
-    /** Allocates data for a startIndex / numSamples combination */
-	void allocateBlocks(uint64 startIndex, int numSamples);
+    /** Allocates data for a startIndex / numSamples combination; returns false if a block can't be allocated */
+	bool allocateBlocks(uint64 startIndex, int numSamples);
+
+    /** Finds (or allocates) the blocks for a startPos / nSamples combination and calls
+        writeSegment(blockPtr, dataIdx, samplesToWrite) for each of them. A channel
+        index of -1 means that all channels have been written. */
+	template <typename SegmentWriter>
+	bool writeBlocks(uint64 startPos, int nSamples, int channel, SegmentWriter&& writeSegment);
+
+    /** Converts and interleaves all channels into a block */
+	void interleaveChannels(int16* dest, const float* const* data, const float* scales, int dataIdx, int nSamples);
+
+    /** Creates a new memory block at the given sample offset, or returns nullptr if its memory can't be allocated */
+	FileBlock* createBlock(uint64 offset);
 
 	/** Compile-time params */
 	const int streamBufferSize{ 0 };
@@ -0,0 +1,159 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "TimestampSegments.h"
+
+TimestampSegmentWriter::TimestampSegmentWriter(String path, double sampleRate) :
+    m_segmentOpen(false),
+    m_startSample(0),
+    m_startTime(0),
+    m_step(0),
+    m_length(0),
+    m_nominalStep(sampleRate > 0 ? 1.0 / sampleRate : 0)
+{
+    Array<NpyType> types;
+    types.add(NpyType("sample_number", BaseType::INT64, 1));
+    types.add(NpyType("timestamp", BaseType::DOUBLE, 1));
+    types.add(NpyType("sample_rate", BaseType::DOUBLE, 1));
+    types.add(NpyType("length", BaseType::INT64, 1));
+
+    m_file = std::make_unique<NpyFile>(path, types);
+}
+
+TimestampSegmentWriter::~TimestampSegmentWriter()
+{
+    closeSegment();
+}
+
+bool TimestampSegmentWriter::isOnSegment(double timestamp, int64 offset) const
+{
+    return std::abs(timestamp - (m_startTime + double(offset) * m_step)) <= std::abs(m_step) * TIMESTAMP_SEGMENT_TOLERANCE;
+}
+
+void TimestampSegmentWriter::writeSamples(int64 firstSampleNumber, const double* timestamps, int numSamples)
+{
+    int i = 0;
+
+    /* Extend the open segment as far as possible */
+    if (m_segmentOpen && firstSampleNumber == m_startSample + m_length)
+    {
+        /* A segment that ended its block after one sample has no measured step yet,
+           and any second sample lies on the line through the first */
+        if (m_length == 1 && numSamples > 0)
+        {
+            m_step = timestamps[0] - m_startTime;
+            m_length++;
+            i++;
+        }
+
+        while (i < numSamples && isOnSegment(timestamps[i], m_length))
+        {
+            m_length++;
+            i++;
+        }
+    }
+
+    while (i < numSamples)
+    {
+        closeSegment();
+
+        m_segmentOpen = true;
+        m_startSample = firstSampleNumber + i;
+        m_startTime = timestamps[i];
+        m_length = 1;
+        m_step = m_nominalStep;
+
+        if (i + 1 < numSamples)
+            m_step = timestamps[i + 1] - timestamps[i];
+
+        int end = i + 1;
+
+        while (end < numSamples && isOnSegment(timestamps[end], end - i))
+            end++;
+
+        /* The chord over the whole run is a much better estimate of the step
+           than the difference between two neighbouring timestamps */
+        if (end - i > 2)
+            m_step = (timestamps[end - 1] - timestamps[i]) / double(end - 1 - i);
+
+        m_length = end - i;
+        i = end;
+    }
+}
+
+void TimestampSegmentWriter::closeSegment()
+{
+    if (!m_segmentOpen)
+        return;
+
+    TimestampSegment segment;
+    segment.sampleNumber = m_startSample;
+    segment.timestamp = m_startTime;
+    segment.sampleRate = m_step != 0 ? 1.0 / m_step : 0;
+    segment.length = m_length;
+
+    m_file->writeData(&segment, sizeof(TimestampSegment));
+    m_file->increaseRecordCount();
+
+    m_segmentOpen = false;
+}
+
+TimestampSegmentReader::TimestampSegmentReader() :
+    m_numSamples(0)
+{
+}
+
+bool TimestampSegmentReader::openFile(const File& file)
+{
+    m_segments.clear();
+    m_numSamples = 0;
+
+    std::unique_ptr<FileInputStream> stream = file.createInputStream();
+
+    if (!stream)
+        return false;
+
+    /* \x93NUMPY, 2 version bytes, then the length of the header dictionary */
+    char magic[6];
+    if (stream->read(magic, 6) != 6 || memcmp(magic, "\x93NUMPY", 6) != 0)
+        return false;
+
+    int majorVersion = stream->readByte();
+    stream->readByte();
+
+    int64 headerLength = majorVersion == 1 ? (int64) (uint16) stream->readShort() : (int64) (uint32) stream->readInt();
+    stream->skipNextBytes(headerLength);
+
+    TimestampSegment segment;
+
+    while (stream->read(&segment, sizeof(TimestampSegment)) == sizeof(TimestampSegment))
+    {
+        if (segment.length <= 0)
+            return false;
+
+        m_segments.add(segment);
+        m_numSamples += segment.length;
+    }
+
+    return m_segments.size() > 0;
+}
@@ -0,0 +1,123 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef TIMESTAMPSEGMENTS_H
+#define TIMESTAMPSEGMENTS_H
+
+#include "NpyFile.h"
+
+/** Maximum deviation of a timestamp from its segment, as a fraction of the sample period */
+#define TIMESTAMP_SEGMENT_TOLERANCE 1e-3
+
+/** One run of contiguous samples with evenly spaced timestamps */
+struct TimestampSegment
+{
+    int64 sampleNumber;
+    double timestamp;
+    double sampleRate;
+    int64 length;
+};
+
+/**
+
+    Stores the sample numbers and timestamps of a continuous stream as
+    piecewise-linear segments, instead of one int64 and one double per sample
+
+    Each record of "timestamp_segments.npy" holds the first sample number,
+    the timestamp of that sample, the sample rate, and the number of samples
+    in the segment. A new segment only starts when there is a gap in the
+    sample numbers, or when a timestamp deviates from the current segment
+    by more than TIMESTAMP_SEGMENT_TOLERANCE sample periods (i.e. when the
+    sync changes).
+
+    A segment is written to disk once it is complete, and the last one
+    when the writer is destroyed.
+
+ */
+
+class PLUGIN_API TimestampSegmentWriter
+{
+public:
+
+    /** Creates the segment file at the requested path. The nominal sample rate is
+        stored for segments that are too short to measure their own rate */
+    TimestampSegmentWriter(String path, double sampleRate);
+
+    /** Writes the last open segment */
+    ~TimestampSegmentWriter();
+
+    /** Adds numSamples contiguous samples, starting at firstSampleNumber */
+    void writeSamples(int64 firstSampleNumber, const double* timestamps, int numSamples);
+
+private:
+
+    /** Returns true if a timestamp lies on the open segment at the given sample offset */
+    bool isOnSegment(double timestamp, int64 offset) const;
+
+    /** Writes the open segment to disk */
+    void closeSegment();
+
+    std::unique_ptr<NpyFile> m_file;
+
+    bool m_segmentOpen;
+    int64 m_startSample;
+    double m_startTime;
+    double m_step;
+    int64 m_length;
+
+    double m_nominalStep;
+};
+
+/**
+
+    Reads the segment table of a "timestamp_segments.npy" file written by
+    TimestampSegmentWriter
+
+ */
+
+class PLUGIN_API TimestampSegmentReader
+{
+public:
+
+    /** Constructor */
+    TimestampSegmentReader();
+
+    /** Loads the segments from a file. Returns false if the file is not valid */
+    bool openFile(const File& file);
+
+    /** Returns the total number of samples covered by all segments */
+    int64 getNumSamples() const { return m_numSamples; }
+
+    /** Returns the number of segments */
+    int getNumSegments() const { return m_segments.size(); }
+
+    /** Returns one of the segments, in file order */
+    const TimestampSegment& getSegment(int index) const { return m_segments.getReference(index); }
+
+private:
+
+    Array<TimestampSegment> m_segments;
+    int64 m_numSamples;
+};
+
+#endif // TIMESTAMPSEGMENTS_H
@@ -0,0 +1,403 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "ChunkCodec.h"
+
+#if JUCE_MSVC
+#include <intrin.h>
+#endif
+
+/** Number of residuals sharing a Rice parameter */
+#define ENCODER_PARTITION_SIZE 256
+
+/** Order 3 residuals of int16 data fit in 20 bits once zigzag-mapped */
+#define MAX_RICE_PARAMETER 20
+
+#define METHOD_BITS 3
+#define METHOD_VERBATIM 4
+#define RICE_PARAMETER_BITS 5
+#define MAX_PREDICTOR_ORDER 3
+
+namespace
+{
+    /** Writes MSB-first into a byte buffer */
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8* dest) : m_start(dest), m_dest(dest), m_acc(0), m_count(0) { }
+
+        /** Writes the lowest numBits bits of value (numBits <= 32) */
+        inline void write(uint32 value, int numBits)
+        {
+            m_acc = (m_acc << numBits) | value;
+            m_count += numBits;
+
+            if (m_count >= 32)
+            {
+                m_count -= 32;
+                uint32 word = uint32(m_acc >> m_count);
+                m_dest[0] = uint8(word >> 24);
+                m_dest[1] = uint8(word >> 16);
+                m_dest[2] = uint8(word >> 8);
+                m_dest[3] = uint8(word);
+                m_dest += 4;
+            }
+        }
+
+        /** Writes value >> k as a run of zeros terminated by a one, followed by the low k bits */
+        inline void writeRice(uint32 value, int k)
+        {
+            uint32 q = value >> k;
+
+            if (q + 1 + k <= 32)
+            {
+                write((1u << k) | (value & ((1u << k) - 1)), q + 1 + k);
+                return;
+            }
+
+            for (; q >= 32; q -= 32)
+                write(0, 32);
+
+            write(1, q + 1);
+            write(value & ((1u << k) - 1), k);
+        }
+
+        /** Pads the last byte with zeros and returns the number of bytes written */
+        size_t flush()
+        {
+            while (m_count > 0)
+            {
+                int bits = jmin(8, m_count);
+                m_count -= bits;
+                *m_dest++ = uint8((m_acc >> m_count) << (8 - bits));
+            }
+
+            return m_dest - m_start;
+        }
+
+    private:
+        uint8* m_start;
+        uint8* m_dest;
+        uint64 m_acc;
+        int m_count;
+    };
+
+    /** Reads MSB-first from a byte buffer; reading past the end sets an error flag */
+    class BitReader
+    {
+    public:
+        BitReader(const uint8* source, size_t numBytes) : m_source(source), m_end(source + numBytes), m_acc(0), m_count(0), m_overrun(false) { }
+
+        inline void refill()
+        {
+            while (m_count <= 56 && m_source < m_end)
+            {
+                m_acc |= uint64(*m_source++) << (56 - m_count);
+                m_count += 8;
+            }
+        }
+
+        /** Reads numBits bits (1 <= numBits <= 32) */
+        inline uint32 read(int numBits)
+        {
+            if (m_count < numBits)
+            {
+                refill();
+
+                if (m_count < numBits)
+                {
+                    m_overrun = true;
+                    m_count = numBits;
+                }
+            }
+
+            uint32 value = uint32(m_acc >> (64 - numBits));
+            m_acc <<= numBits;
+            m_count -= numBits;
+            return value;
+        }
+
+        /** Counts zeros up to (and consumes) the next one */
+        inline uint32 readUnary()
+        {
+            uint32 q = 0;
+
+            while (true)
+            {
+                if (m_count < 32)
+                    refill();
+
+                if (m_acc == 0)
+                {
+                    q += m_count;
+                    m_count = 0;
+
+                    if (m_source >= m_end)
+                    {
+                        m_overrun = true;
+                        return 0;
+                    }
+
+                    continue;
+                }
+
+                int zeros = countLeadingZeros(m_acc);
+                q += zeros;
+                m_acc <<= zeros;
+                m_acc <<= 1;
+                m_count -= zeros + 1;
+                return q;
+            }
+        }
+
+        inline uint32 readRice(int k)
+        {
+            uint32 q = readUnary();
+            return k > 0 ? (q << k) | read(k) : q;
+        }
+
+        bool hasOverrun() const { return m_overrun; }
+
+    private:
+
+        static inline int countLeadingZeros(uint64 value)
+        {
+#if JUCE_MSVC
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return 63 - int(index);
+#else
+            return __builtin_clzll(value);
+#endif
+        }
+
+        const uint8* m_source;
+        const uint8* m_end;
+        uint64 m_acc;
+        int m_count;
+        bool m_overrun;
+    };
+
+    inline uint32 zigzag(int32 value)
+    {
+        return (uint32(value) << 1) ^ uint32(value >> 31);
+    }
+
+    inline int32 unzigzag(uint32 value)
+    {
+        return int32(value >> 1) ^ -int32(value & 1);
+    }
+
+    template <int order>
+    inline int32 predict(const int32* x, int i)
+    {
+        switch (order)
+        {
+        case 0: return 0;
+        case 1: return x[i - 1];
+        case 2: return 2 * x[i - 1] - x[i - 2];
+        default: return 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3];
+        }
+    }
+
+    template <int order>
+    void computeResiduals(const int32* x, int numSamples, uint32* residuals)
+    {
+        for (int i = order; i < numSamples; i++)
+            residuals[i - order] = zigzag(x[i] - predict<order>(x, i));
+    }
+
+    template <int order>
+    bool decodeChannel(BitReader& reader, int16* dest, int numChannels, int numSamples, int32* x)
+    {
+        for (int i = 0; i < order; i++)
+        {
+            x[i] = int16(reader.read(16));
+            dest[i * numChannels] = int16(x[i]);
+        }
+
+        for (int start = order; start < numSamples; start += ENCODER_PARTITION_SIZE)
+        {
+            int k = reader.read(RICE_PARAMETER_BITS);
+
+            if (k > MAX_RICE_PARAMETER)
+                return false;
+
+            int end = jmin(numSamples, start + ENCODER_PARTITION_SIZE);
+
+            for (int i = start; i < end; i++)
+            {
+                x[i] = predict<order>(x, i) + unzigzag(reader.readRice(k));
+                dest[i * numChannels] = int16(x[i]);
+            }
+        }
+
+        return !reader.hasOverrun();
+    }
+}
+
+size_t ChunkCodec::getMaxEncodedSize(int numChannels, int numSamples)
+{
+    return (size_t(numChannels) * (METHOD_BITS + 16 * size_t(numSamples)) + 7) / 8 + 8;
+}
+
+size_t ChunkCodec::encode(const int16* source, int numChannels, int numSamples, uint8* dest)
+{
+    BitWriter writer(dest);
+
+    HeapBlock<int32> samples(numSamples);
+    HeapBlock<uint32> residuals(numSamples);
+    Array<int> riceParameters;
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        for (int i = 0; i < numSamples; i++)
+            samples[i] = source[size_t(i) * numChannels + ch];
+
+        /* Choose the predictor with the smallest absolute residuals */
+        int64 sums[MAX_PREDICTOR_ORDER + 1] = { 0, 0, 0, 0 };
+
+        for (int i = MAX_PREDICTOR_ORDER; i < numSamples; i++)
+        {
+            int32 r0 = samples[i];
+            int32 r1 = r0 - samples[i - 1];
+            int32 r2 = r1 - (samples[i - 1] - samples[i - 2]);
+            int32 r3 = r2 - (samples[i - 1] - 2 * samples[i - 2] + samples[i - 3]);
+
+            sums[0] += std::abs(r0);
+            sums[1] += std::abs(r1);
+            sums[2] += std::abs(r2);
+            sums[3] += std::abs(r3);
+        }
+
+        int order = 0;
+
+        for (int o = 1; o <= MAX_PREDICTOR_ORDER; o++)
+            if (sums[o] < sums[order])
+                order = o;
+
+        order = jmin(order, numSamples);
+
+        switch (order)
+        {
+        case 0: computeResiduals<0>(samples, numSamples, residuals); break;
+        case 1: computeResiduals<1>(samples, numSamples, residuals); break;
+        case 2: computeResiduals<2>(samples, numSamples, residuals); break;
+        default: computeResiduals<3>(samples, numSamples, residuals); break;
+        }
+
+        /* Pick a Rice parameter for each partition. sum(u >> k) <= (sum(u) >> k), so
+           the estimate is an upper bound on the coded size */
+        int numResiduals = numSamples - order;
+        uint64 codedBits = METHOD_BITS + 16 * order;
+
+        riceParameters.clearQuick();
+
+        for (int start = 0; start < numResiduals; start += ENCODER_PARTITION_SIZE)
+        {
+            int count = jmin(ENCODER_PARTITION_SIZE, numResiduals - start);
+            uint64 sum = 0;
+
+            for (int i = start; i < start + count; i++)
+                sum += residuals[i];
+
+            int bestK = 0;
+            uint64 bestBits = ~uint64(0);
+
+            for (int k = 0; k <= MAX_RICE_PARAMETER; k++)
+            {
+                uint64 bits = uint64(count) * (k + 1) + (sum >> k);
+
+                if (bits < bestBits)
+                {
+                    bestBits = bits;
+                    bestK = k;
+                }
+            }
+
+            riceParameters.add(bestK);
+            codedBits += RICE_PARAMETER_BITS + bestBits;
+        }
+
+        if (codedBits >= METHOD_BITS + 16 * uint64(numSamples))
+        {
+            writer.write(METHOD_VERBATIM, METHOD_BITS);
+
+            for (int i = 0; i < numSamples; i++)
+                writer.write(uint16(samples[i]), 16);
+
+            continue;
+        }
+
+        writer.write(order, METHOD_BITS);
+
+        for (int i = 0; i < order; i++)
+            writer.write(uint16(samples[i]), 16);
+
+        for (int p = 0; p < riceParameters.size(); p++)
+        {
+            int k = riceParameters[p];
+            int start = p * ENCODER_PARTITION_SIZE;
+            int end = jmin(numResiduals, start + ENCODER_PARTITION_SIZE);
+
+            writer.write(k, RICE_PARAMETER_BITS);
+
+            for (int i = start; i < end; i++)
+                writer.writeRice(residuals[i], k);
+        }
+    }
+
+    return writer.flush();
+}
+
+bool ChunkCodec::decode(const uint8* source, size_t numBytes, int16* dest, int numChannels, int numSamples)
+{
+    BitReader reader(source, numBytes);
+    HeapBlock<int32> samples(numSamples);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        int method = reader.read(METHOD_BITS);
+        bool ok;
+
+        switch (method)
+        {
+        case 0: ok = decodeChannel<0>(reader, dest + ch, numChannels, numSamples, samples); break;
+        case 1: ok = decodeChannel<1>(reader, dest + ch, numChannels, numSamples, samples); break;
+        case 2: ok = decodeChannel<2>(reader, dest + ch, numChannels, numSamples, samples); break;
+        case 3: ok = decodeChannel<3>(reader, dest + ch, numChannels, numSamples, samples); break;
+        case METHOD_VERBATIM:
+            for (int i = 0; i < numSamples; i++)
+                dest[size_t(i) * numChannels + ch] = int16(reader.read(16));
+            ok = !reader.hasOverrun();
+            break;
+        default:
+            ok = false;
+        }
+
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef CHUNKCODEC_H
+#define CHUNKCODEC_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+#include "../../PluginManager/PluginClass.h"
+
+/**
+
+    Lossless codec for one chunk of interleaved int16 samples
+
+    Each channel of the chunk is coded independently, in the spirit of FLAC:
+
+    1. The best of four fixed polynomial predictors (order 0 to 3) is chosen,
+       and the first "order" samples are stored verbatim.
+    2. The prediction residuals are zigzag-mapped to unsigned values and split
+       into partitions of ENCODER_PARTITION_SIZE samples.
+    3. Each partition is Rice coded with its own parameter k.
+
+    If prediction does not help, the channel is stored verbatim, so a chunk
+    never takes more than getMaxEncodedSize() bytes. Chunks do not depend on
+    each other, so they can be decoded in any order.
+
+ */
+
+class PLUGIN_API ChunkCodec
+{
+public:
+
+    /** Returns the maximum number of bytes that encode() can produce */
+    static size_t getMaxEncodedSize(int numChannels, int numSamples);
+
+    /** Compresses numSamples of interleaved data. dest must hold getMaxEncodedSize() bytes.
+        Returns the number of bytes written. */
+    static size_t encode(const int16* source, int numChannels, int numSamples, uint8* dest);
+
+    /** Decompresses a chunk into interleaved samples. Returns false if the data is corrupt. */
+    static bool decode(const uint8* source, size_t numBytes, int16* dest, int numChannels, int numSamples);
+};
+
+#endif // CHUNKCODEC_H
@@ -0,0 +1,190 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "CompressedBlockWriter.h"
+#include "ChunkCodec.h"
+#include "../../../Utils/Utils.h"
+
+struct CompressedBlockWriter::PendingChunk
+{
+    int16* samples;
+    int numSamples;
+    HeapBlock<uint8> encoded;
+    size_t numBytes;
+    WaitableEvent done;
+};
+
+CompressedBlockWriter::CompressedBlockWriter(ThreadPool* pool, int numChannels, int samplesPerChunk, int maxChunksInFlight) :
+    m_pool(pool),
+    m_numChannels(numChannels),
+    m_samplesPerChunk(samplesPerChunk),
+    m_blockSizeBytes(size_t(numChannels) * samplesPerChunk * sizeof(int16)),
+    m_maxChunksInFlight(jmax(1, maxChunksInFlight)),
+    m_writeError(false)
+{
+}
+
+CompressedBlockWriter::~CompressedBlockWriter()
+{
+    while (!m_pendingChunks.empty())
+        writeFinishedChunks(true);
+
+    if (m_file)
+    {
+        writeIndex();
+        m_file->flush();
+    }
+
+    for (auto block : m_freeBlocks)
+        free(block);
+}
+
+bool CompressedBlockWriter::openFile(const File& file)
+{
+    file.deleteFile();
+
+    if (file.create().wasOk())
+        m_file = file.createOutputStream();
+
+    if (!m_file)
+    {
+        LOGE("CompressedBlockWriter: unable to open ", file.getFullPathName());
+        return false;
+    }
+
+    m_file->write(COMPRESSED_FILE_MAGIC, 8);
+    m_file->writeInt(COMPRESSED_FILE_VERSION);
+    m_file->writeInt(m_numChannels);
+    m_file->writeInt(m_samplesPerChunk);
+    m_file->writeRepeatedByte(0, COMPRESSED_HEADER_SIZE - 20);
+
+    return true;
+}
+
+void* CompressedBlockWriter::allocateBlock()
+{
+    if (!m_freeBlocks.empty())
+    {
+        void* block = m_freeBlocks.back();
+        m_freeBlocks.pop_back();
+
+        memset(block, 0, m_blockSizeBytes);
+        return block;
+    }
+
+    return calloc(1, m_blockSizeBytes);
+}
+
+void CompressedBlockWriter::writeBlock(void* block, size_t numBytes)
+{
+    jassert(numBytes <= m_blockSizeBytes);
+
+    int numSamples = int(numBytes / (m_numChannels * sizeof(int16)));
+
+    if (!m_file || numSamples == 0)
+    {
+        m_freeBlocks.push_back(block);
+        return;
+    }
+
+    writeFinishedChunks(false);
+
+    while ((int) m_pendingChunks.size() >= m_maxChunksInFlight)
+        writeFinishedChunks(true);
+
+    std::unique_ptr<PendingChunk> chunk;
+
+    if (!m_freeChunks.empty())
+    {
+        chunk = std::move(m_freeChunks.back());
+        m_freeChunks.pop_back();
+    }
+    else
+    {
+        chunk = std::make_unique<PendingChunk>();
+        chunk->encoded.malloc(ChunkCodec::getMaxEncodedSize(m_numChannels, m_samplesPerChunk));
+    }
+
+    chunk->samples = static_cast<int16*>(block);
+    chunk->numSamples = numSamples;
+    chunk->numBytes = 0;
+
+    PendingChunk* job = chunk.get();
+    int numChannels = m_numChannels;
+
+    m_pool->addJob([job, numChannels]
+    {
+        job->numBytes = ChunkCodec::encode(job->samples, numChannels, job->numSamples, job->encoded);
+        job->done.signal();
+    });
+
+    m_pendingChunks.push_back(std::move(chunk));
+}
+
+void CompressedBlockWriter::writeFinishedChunks(bool wait)
+{
+    while (!m_pendingChunks.empty())
+    {
+        PendingChunk* chunk = m_pendingChunks.front().get();
+
+        if (!chunk->done.wait(wait ? -1 : 0))
+            return;
+
+        m_chunkOffsets.add(m_file->getPosition());
+        m_chunkSamples.add(chunk->numSamples);
+        m_chunkBytes.add(int(chunk->numBytes));
+
+        m_file->writeInt(COMPRESSED_CHUNK_MAGIC);
+        m_file->writeInt(chunk->numSamples);
+        m_file->writeInt(int(chunk->numBytes));
+
+        if (!m_file->write(chunk->encoded, chunk->numBytes) && !m_writeError)
+        {
+            LOGE("CompressedBlockWriter: write failed: ", m_file->getStatus().getErrorMessage());
+            m_writeError = true;
+        }
+
+        m_freeBlocks.push_back(chunk->samples);
+        m_freeChunks.push_back(std::move(m_pendingChunks.front()));
+        m_pendingChunks.pop_front();
+
+        /* Only wait for a single chunk to complete */
+        wait = false;
+    }
+}
+
+void CompressedBlockWriter::writeIndex()
+{
+    int64 indexOffset = m_file->getPosition();
+
+    for (int i = 0; i < m_chunkOffsets.size(); i++)
+    {
+        m_file->writeInt64(m_chunkOffsets[i]);
+        m_file->writeInt(m_chunkSamples[i]);
+        m_file->writeInt(m_chunkBytes[i]);
+    }
+
+    m_file->writeInt64(indexOffset);
+    m_file->writeInt64(m_chunkOffsets.size());
+    m_file->write(COMPRESSED_INDEX_MAGIC, 8);
+}
@@ -0,0 +1,120 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef COMPRESSEDBLOCKWRITER_H
+#define COMPRESSEDBLOCKWRITER_H
+
+#include "../BinaryFormat/BlockWriter.h"
+
+#include <deque>
+#include <vector>
+
+/**
+    Layout of a compressed continuous file ("continuous.oec"). All values are little-endian.
+
+    Header:  "OECHUNK1", int32 version, int32 numChannels, int32 samplesPerChunk, 12 reserved bytes
+    Chunk:   int32 CHUNK_MAGIC, int32 numSamples, int32 numBytes, followed by numBytes of ChunkCodec data
+    Index:   for each chunk, int64 offset of its header, int32 numSamples, int32 numBytes
+    Footer:  int64 offset of the index, int64 number of chunks, "OEINDEX1"
+
+    Every chunk but the last holds samplesPerChunk samples. The index is written when
+    the file is closed; if it is missing, readers can rebuild it from the chunk headers.
+ */
+#define COMPRESSED_FILE_MAGIC "OECHUNK1"
+#define COMPRESSED_INDEX_MAGIC "OEINDEX1"
+#define COMPRESSED_FILE_VERSION 1
+#define COMPRESSED_HEADER_SIZE 32
+#define COMPRESSED_CHUNK_MAGIC 0x4b43454f
+#define COMPRESSED_CHUNK_HEADER_SIZE 12
+#define COMPRESSED_INDEX_ENTRY_SIZE 16
+#define COMPRESSED_FOOTER_SIZE 24
+
+/**
+
+    Compresses the blocks of a SequentialBlockFile on worker threads and appends
+    them to a chunked file, one chunk per block
+
+    Each block is handed to a ThreadPool as soon as it is retired. Finished chunks
+    are written in order by the thread that calls writeBlock(), so file I/O stays on
+    the record thread. If compression falls behind, writeBlock() waits once
+    maxChunksInFlight blocks are pending, and the data queue absorbs the delay.
+
+    Not thread safe; each writer must be used by a single thread at a time,
+    but any number of writers can share the same pool.
+
+ */
+
+class CompressedBlockWriter : public BlockWriter
+{
+public:
+
+    /** Creates a writer for blocks of samplesPerChunk interleaved samples */
+    CompressedBlockWriter(ThreadPool* pool, int numChannels, int samplesPerChunk, int maxChunksInFlight = 8);
+
+    /** Waits for all pending chunks, writes the chunk index and closes the file */
+    ~CompressedBlockWriter() override;
+
+    /** Creates (or truncates) the file at the requested path and writes the header */
+    bool openFile(const File& file);
+
+    /** Returns a zeroed block of samplesPerChunk interleaved samples */
+    void* allocateBlock() override;
+
+    /** Queues a block for compression and takes ownership of it */
+    void writeBlock(void* block, size_t numBytes) override;
+
+    /** Returns true if a compressed chunk could not be written */
+    bool hasWriteError() const override { return m_writeError; }
+
+private:
+
+    struct PendingChunk;
+
+    /** Writes compressed chunks in order; if wait is true, blocks until the oldest chunk is done */
+    void writeFinishedChunks(bool wait);
+
+    /** Appends the chunk index and the footer */
+    void writeIndex();
+
+    ThreadPool* m_pool;
+    std::unique_ptr<FileOutputStream> m_file;
+
+    const int m_numChannels;
+    const int m_samplesPerChunk;
+    const size_t m_blockSizeBytes;
+    const int m_maxChunksInFlight;
+
+    std::deque<std::unique_ptr<PendingChunk>> m_pendingChunks;
+    std::vector<std::unique_ptr<PendingChunk>> m_freeChunks;
+    std::vector<void*> m_freeBlocks;
+
+    Array<int64> m_chunkOffsets;
+    Array<int> m_chunkSamples;
+    Array<int> m_chunkBytes;
+
+    bool m_writeError;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedBlockWriter);
+};
+
+#endif // COMPRESSEDBLOCKWRITER_H
@@ -0,0 +1,200 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "CompressedChunkReader.h"
+#include "CompressedBlockWriter.h"
+#include "ChunkCodec.h"
+#include "../../../Utils/Utils.h"
+
+CompressedChunkReader::CompressedChunkReader() :
+    m_numChannels(0),
+    m_samplesPerChunk(0),
+    m_numSamples(0),
+    m_decodedChunk(-1)
+{
+}
+
+bool CompressedChunkReader::openFile(const File& file)
+{
+    m_stream = file.createInputStream();
+
+    if (!m_stream || m_stream->getTotalLength() < COMPRESSED_HEADER_SIZE)
+        return false;
+
+    char magic[8];
+    m_stream->read(magic, 8);
+
+    if (memcmp(magic, COMPRESSED_FILE_MAGIC, 8) != 0 || m_stream->readInt() != COMPRESSED_FILE_VERSION)
+    {
+        LOGE("CompressedChunkReader: ", file.getFullPathName(), " is not a compressed continuous file");
+        return false;
+    }
+
+    m_numChannels = m_stream->readInt();
+    m_samplesPerChunk = m_stream->readInt();
+
+    if (m_numChannels <= 0 || m_samplesPerChunk <= 0)
+        return false;
+
+    m_chunkOffsets.clear();
+    m_chunkSamples.clear();
+    m_chunkBytes.clear();
+    m_numSamples = 0;
+
+    if (!readIndex())
+    {
+        LOGD("CompressedChunkReader: no chunk index in ", file.getFullPathName(), ", scanning chunks");
+        scanChunks();
+    }
+
+    m_decoded.malloc(size_t(m_numChannels) * m_samplesPerChunk);
+    m_decodedChunk = -1;
+
+    return true;
+}
+
+bool CompressedChunkReader::readIndex()
+{
+    int64 length = m_stream->getTotalLength();
+
+    if (length < COMPRESSED_HEADER_SIZE + COMPRESSED_FOOTER_SIZE)
+        return false;
+
+    m_stream->setPosition(length - COMPRESSED_FOOTER_SIZE);
+
+    int64 indexOffset = m_stream->readInt64();
+    int64 numChunks = m_stream->readInt64();
+
+    char magic[8];
+    m_stream->read(magic, 8);
+
+    if (memcmp(magic, COMPRESSED_INDEX_MAGIC, 8) != 0
+        || indexOffset < COMPRESSED_HEADER_SIZE
+        || indexOffset + numChunks * COMPRESSED_INDEX_ENTRY_SIZE != length - COMPRESSED_FOOTER_SIZE)
+        return false;
+
+    m_stream->setPosition(indexOffset);
+
+    for (int64 i = 0; i < numChunks; i++)
+    {
+        int64 offset = m_stream->readInt64();
+        int numSamples = m_stream->readInt();
+        int numBytes = m_stream->readInt();
+
+        if (!addChunk(offset, numSamples, numBytes))
+            return false;
+    }
+
+    return true;
+}
+
+void CompressedChunkReader::scanChunks()
+{
+    m_chunkOffsets.clear();
+    m_chunkSamples.clear();
+    m_chunkBytes.clear();
+    m_numSamples = 0;
+
+    int64 length = m_stream->getTotalLength();
+    int64 offset = COMPRESSED_HEADER_SIZE;
+
+    while (offset + COMPRESSED_CHUNK_HEADER_SIZE <= length)
+    {
+        m_stream->setPosition(offset);
+
+        if (m_stream->readInt() != COMPRESSED_CHUNK_MAGIC)
+            break;
+
+        int numSamples = m_stream->readInt();
+        int numBytes = m_stream->readInt();
+
+        /* The last chunk may have been cut short */
+        if (offset + COMPRESSED_CHUNK_HEADER_SIZE + numBytes > length || !addChunk(offset, numSamples, numBytes))
+            break;
+
+        offset += COMPRESSED_CHUNK_HEADER_SIZE + numBytes;
+    }
+}
+
+bool CompressedChunkReader::addChunk(int64 offset, int numSamples, int numBytes)
+{
+    /* Only the last chunk can be partially filled */
+    if (numSamples <= 0 || numSamples > m_samplesPerChunk || numBytes < 0
+        || (m_chunkSamples.size() > 0 && m_chunkSamples.getLast() != m_samplesPerChunk))
+        return false;
+
+    m_chunkOffsets.add(offset);
+    m_chunkSamples.add(numSamples);
+    m_chunkBytes.add(numBytes);
+    m_numSamples += numSamples;
+
+    return true;
+}
+
+bool CompressedChunkReader::loadChunk(int index)
+{
+    if (index == m_decodedChunk)
+        return true;
+
+    m_decodedChunk = -1;
+
+    int numBytes = m_chunkBytes[index];
+    m_encoded.ensureSize(numBytes);
+
+    m_stream->setPosition(m_chunkOffsets[index] + COMPRESSED_CHUNK_HEADER_SIZE);
+
+    if (m_stream->read(m_encoded.getData(), numBytes) != numBytes
+        || !ChunkCodec::decode(static_cast<const uint8*>(m_encoded.getData()), numBytes, m_decoded, m_numChannels, m_chunkSamples[index]))
+    {
+        LOGE("CompressedChunkReader: chunk ", index, " is corrupt");
+        return false;
+    }
+
+    m_decodedChunk = index;
+    return true;
+}
+
+int CompressedChunkReader::readSamples(int64 startSample, int16* dest, int numSamples)
+{
+    int samplesRead = 0;
+
+    while (samplesRead < numSamples && startSample < m_numSamples)
+    {
+        int chunk = int(startSample / m_samplesPerChunk);
+        int offset = int(startSample % m_samplesPerChunk);
+
+        if (!loadChunk(chunk))
+            break;
+
+        int count = jmin(numSamples - samplesRead, m_chunkSamples[chunk] - offset);
+
+        memcpy(dest + size_t(samplesRead) * m_numChannels,
+            m_decoded + size_t(offset) * m_numChannels,
+            size_t(count) * m_numChannels * sizeof(int16));
+
+        samplesRead += count;
+        startSample += count;
+    }
+
+    return samplesRead;
+}
@@ -0,0 +1,91 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef COMPRESSEDCHUNKREADER_H
+#define COMPRESSEDCHUNKREADER_H
+
+#include "../../../../JuceLibraryCode/JuceHeader.h"
+#include "../../PluginManager/PluginClass.h"
+
+/**
+
+    Random access to the samples of a compressed continuous file
+    written by CompressedBlockWriter
+
+    The chunk index is loaded when the file is opened (or rebuilt from the
+    chunk headers if the recording was not closed cleanly), so seeking only
+    requires decoding the chunk that contains the requested sample.
+
+ */
+
+class PLUGIN_API CompressedChunkReader
+{
+public:
+
+    /** Constructor */
+    CompressedChunkReader();
+
+    /** Opens a file and loads its chunk index. Returns false if the file is not valid */
+    bool openFile(const File& file);
+
+    /** Returns the number of interleaved channels */
+    int getNumChannels() const { return m_numChannels; }
+
+    /** Returns the total number of samples per channel */
+    int64 getNumSamples() const { return m_numSamples; }
+
+    /** Reads up to numSamples interleaved samples starting at startSample. Returns the number of samples read */
+    int readSamples(int64 startSample, int16* dest, int numSamples);
+
+private:
+
+    /** Loads the index from the end of the file */
+    bool readIndex();
+
+    /** Rebuilds the index by walking the chunk headers */
+    void scanChunks();
+
+    /** Adds a chunk to the index; returns false if it is not a valid continuation */
+    bool addChunk(int64 offset, int numSamples, int numBytes);
+
+    /** Decodes a chunk into m_decoded, unless it is already there */
+    bool loadChunk(int index);
+
+    std::unique_ptr<FileInputStream> m_stream;
+
+    int m_numChannels;
+    int m_samplesPerChunk;
+    int64 m_numSamples;
+
+    Array<int64> m_chunkOffsets;
+    Array<int> m_chunkSamples;
+    Array<int> m_chunkBytes;
+
+    HeapBlock<int16> m_decoded;
+    MemoryBlock m_encoded;
+    int m_decodedChunk;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressedChunkReader);
+};
+
+#endif // COMPRESSEDCHUNKREADER_H
@@ -0,0 +1,83 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "CompressedRecording.h"
+#include "CompressedBlockWriter.h"
+
+CompressedRecording::CompressedRecording() :
+	m_numCompressionThreads(1)
+{
+}
+
+CompressedRecording::~CompressedRecording() {}
+
+String CompressedRecording::getEngineId() const
+{
+	return "COMPRESSED";
+}
+
+void CompressedRecording::openFiles(File rootFolder, int experimentNumber, int recordingNumber)
+{
+	if (!m_compressionPool || m_compressionPool->getNumThreads() != m_numCompressionThreads)
+	{
+		m_compressionPool = std::make_unique<ThreadPool>(m_numCompressionThreads);
+	}
+
+	BinaryRecording::openFiles(rootFolder, experimentNumber, recordingNumber);
+}
+
+SequentialBlockFile* CompressedRecording::createContinuousFile(const String& folder, int numChannels)
+{
+	auto writer = std::make_shared<CompressedBlockWriter>(m_compressionPool.get(), numChannels, samplesPerBlock);
+
+	if (!writer->openFile(File(folder + "continuous.oec")))
+		return nullptr;
+
+	ScopedPointer<SequentialBlockFile> bFile = new SequentialBlockFile(numChannels, samplesPerBlock);
+
+	if (bFile->openFile(writer))
+		return bFile.release();
+
+	return nullptr;
+}
+
+RecordEngineManager* CompressedRecording::getEngineManager()
+{
+	RecordEngineManager* man = new RecordEngineManager("COMPRESSED", "Compressed binary",
+		&(engineFactory<CompressedRecording>));
+	EngineParameter* param;
+	param = new EngineParameter(EngineParameter::BOOL, 0, "Record TTL full words", true);
+	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::BOOL, 2, "Store sample numbers and timestamps as segments", false);
+	man->addParameter(param);
+	param = new EngineParameter(EngineParameter::INT, 3, "Compression threads",
+		jmax(1, SystemStats::getNumCpus() / 2), 1, 32);
+	man->addParameter(param);
+	return man;
+}
+
+void CompressedRecording::setParameter(EngineParameter& parameter)
+{
+	BinaryRecording::setParameter(parameter);
+	intParameter(3, m_numCompressionThreads);
+}
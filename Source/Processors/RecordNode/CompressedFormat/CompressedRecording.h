@@ -0,0 +1,79 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef COMPRESSEDRECORDING_H
+#define COMPRESSEDRECORDING_H
+
+#include "../BinaryFormat/BinaryRecording.h"
+
+/**
+
+    Record Engine that stores continuous data with lossless compression
+
+    The folder layout is identical to the Binary format, except that the
+    continuous data of each stream is written to "continuous.oec" instead of
+    "continuous.dat". Each block of 4096 samples becomes an independently
+    decodable chunk (see ChunkCodec), and a chunk index at the end of the file
+    allows readers to seek without decompressing the whole recording.
+
+    Compression runs on a pool of worker threads shared by all streams.
+    Events, spikes and timestamps are written exactly as in the Binary format.
+
+ */
+
+class CompressedRecording : public BinaryRecording
+{
+public:
+
+	/** Constructor */
+	CompressedRecording();
+
+	/** Destructor */
+	~CompressedRecording();
+
+	/** Returns the unique identifier of this RecordEngine */
+	String getEngineId() const override;
+
+	/** Launches the manager for this Record Engine, and instantiates any parameters */
+	static RecordEngineManager* getEngineManager();
+
+	/** Starts the compression threads and opens files at the start of recording */
+	void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
+
+	/** Sets an engine parameter (TTL words, timestamp segments and number of compression threads) */
+	void setParameter(EngineParameter& parameter) override;
+
+protected:
+
+	/** Creates a SequentialBlockFile that compresses its blocks into continuous.oec */
+	SequentialBlockFile* createContinuousFile(const String& folder, int numChannels) override;
+
+private:
+
+	std::unique_ptr<ThreadPool> m_compressionPool;
+
+	int m_numCompressionThreads;
+
+};
+
+#endif
@@ -23,13 +23,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "DataQueue.h"
 
+/** FIFO samples per timestamp block slot. The ring only fills up before the FIFO when a stream
+	delivers fewer samples than this per process() call; blocks dropped then are counted and reported */
+#define MIN_SAMPLES_PER_TIMESTAMP_BLOCK 16
+
 DataQueue::DataQueue(int blockSize, int nBlocks) :
 	m_buffer(0, blockSize*nBlocks),
 	m_numChans(0),
 	m_blockSize(blockSize),
 	m_readInProgress(false),
 	m_numBlocks(nBlocks),
-	m_maxSize(blockSize*nBlocks)
+	m_maxSize(blockSize*nBlocks),
+	m_baseBlocks(nBlocks),
+	m_historySize(0),
+	m_highWaterMark(0.0f)
 {}
 
 DataQueue::~DataQueue()
@@ -40,20 +47,29 @@ int DataQueue::getBlockSize()
 	return m_blockSize;
 }
 
-void DataQueue::setTimestampStreamCount(int nStreams)
+void DataQueue::setTimestampStreamCount(int nStreams, const Array<int>& channelStreams)
 {
 	if (m_readInProgress)
 		return;
 
-	m_FTSFifos.clear();
-	m_readFTSSamples.clear();
-	m_numFTSChans = nStreams;
+	m_timestampStreams.clear();
+	m_channelStreams = channelStreams;
 
 	for (int i = 0; i < nStreams; ++i)
 	{
-		m_FTSFifos.add(new AbstractFifo(m_maxSize));
+		TimestampStream* stream = new TimestampStream();
+		stream->capacity = jmax(1, m_maxSize / MIN_SAMPLES_PER_TIMESTAMP_BLOCK);
+		stream->blocks.malloc(stream->capacity);
+		stream->firstChannel = channelStreams.indexOf(i);
+		stream->numBlocks = 0;
+		stream->firstNeededBlock = 0;
+		stream->droppedBlocks = 0;
+		stream->reportedDroppedBlocks = 0;
+		stream->samplesWritten = 0;
+		stream->pendingStart = 0;
+		stream->pendingStep = 0;
+		m_timestampStreams.add(stream);
 	}
-	m_FTSBuffer.setSize(nStreams, m_maxSize);
 }
 
 void DataQueue::setChannelCount(int nChans)
@@ -66,6 +82,7 @@ void DataQueue::setChannelCount(int nChans)
 	m_numChans = nChans;
 	m_sampleNumbers.clear();
 	m_lastReadSampleNumbers.clear();
+	m_channelSamplesRead.clear();
 
 	for (int i = 0; i < nChans; ++i)
 	{
@@ -74,6 +91,7 @@ void DataQueue::setChannelCount(int nChans)
 		m_sampleNumbers.add(new Array<int64>());
 		m_sampleNumbers.getLast()->insertMultiple(0, 0, m_numBlocks);
 		m_lastReadSampleNumbers.add(0);
+		m_channelSamplesRead.add(0);
 	}
 	m_buffer.setSize(nChans, m_maxSize);
 
@@ -84,6 +102,9 @@ void DataQueue::resize(int nBlocks)
 	if (m_readInProgress)
 		return;
 
+	m_baseBlocks = nBlocks;
+	nBlocks += (m_historySize + m_blockSize - 1) / m_blockSize;
+
 	int size = m_blockSize*nBlocks;
 	m_maxSize = size;
 	m_numBlocks = nBlocks;
@@ -95,16 +116,59 @@ void DataQueue::resize(int nBlocks)
 		m_readSamples.set(i, 0);
 		m_sampleNumbers[i]->resize(nBlocks);
 		m_lastReadSampleNumbers.set(i, 0);
+		m_channelSamplesRead.set(i, 0);
 	}
 
-	for (int i = 0; i < m_numFTSChans; ++i)
+	for (auto stream : m_timestampStreams)
 	{
-		m_readFTSSamples.set(i,0);
-		m_FTSFifos[i]->setTotalSize(size);
-		m_FTSFifos[i]->reset();
+		stream->capacity = jmax(1, size / MIN_SAMPLES_PER_TIMESTAMP_BLOCK);
+		stream->blocks.malloc(stream->capacity);
+		stream->numBlocks = 0;
+		stream->firstNeededBlock = 0;
+		stream->droppedBlocks = 0;
+		stream->reportedDroppedBlocks = 0;
+		stream->samplesWritten = 0;
 	}
+
 	m_buffer.setSize(m_numChans, size);
-	m_FTSBuffer.setSize(m_numFTSChans, size);
+}
+
+void DataQueue::setHistorySize(int numSamples)
+{
+	if (m_readInProgress || numSamples == m_historySize)
+		return;
+
+	m_historySize = numSamples;
+	resize(m_baseBlocks);
+}
+
+float DataQueue::getUsage(int channel) const
+{
+	const AbstractFifo* fifo = m_fifos[channel];
+
+	int used = jmax(0, fifo->getNumReady() - m_historySize);
+
+	return (float)used / (float)(fifo->getTotalSize() - m_historySize);
+}
+
+float DataQueue::getUsage() const
+{
+	float usage = 0.0f;
+
+	for (int chan = 0; chan < m_numChans; ++chan)
+		usage = jmax(usage, getUsage(chan));
+
+	return usage;
+}
+
+float DataQueue::getHighWaterMark() const
+{
+	return m_highWaterMark.load(std::memory_order_relaxed);
+}
+
+void DataQueue::resetHighWaterMark()
+{
+	m_highWaterMark.store(0.0f, std::memory_order_relaxed);
 }
 
 void DataQueue::fillSampleNumbers(int channel, int index, int size, int64 sampleNumber)
@@ -148,43 +212,53 @@ void DataQueue::fillSampleNumbers(int channel, int index, int size, int64 sample
 	//	std::cout << "DataQueue::latestSampleNumber: " << latestSampleNumber << std::endl;
 }
 
-float DataQueue::writeSynchronizedTimestamps(double start, double step, int destChannel, int64 nSamples)
+float DataQueue::writeSynchronizedTimestamps(double start, double step, int destStream, int64 nSamples)
 {
+	TimestampStream* stream = m_timestampStreams[destStream];
 
-	int index1, size1, index2, size2;
+	/* Streams without recorded channels have nothing to timestamp */
+	if (stream->firstChannel < 0)
+		return 0.0f;
 
-	m_FTSFifos[destChannel]->prepareToWrite(nSamples, index1, size1, index2, size2);
+	stream->pendingStart = start;
+	stream->pendingStep = step;
 
-	//LOGD("nFTSChannels=", m_FTSFifos.size(), " destChannel=", destChannel, " index1: ", index1, " size1=", size1, " size2=", size2);
+	/* The channels of this block haven't been written yet, so count them in */
+	const AbstractFifo* fifo = m_fifos[stream->firstChannel];
 
-	if ((size1 + size2) < nSamples)
-	{
-		LOGE(__FUNCTION__, " Recording Data Queue Overflow: sz1: ", size1, " sz2: ", size2, " nSamples: ", nSamples);
-	}
+	int numReady = jmin(fifo->getTotalSize() - 1, fifo->getNumReady() + int(nSamples));
+	int used = jmax(0, numReady - m_historySize);
 
-	//LOGD("DataQueue::writeSynchronizedTimestampChannel: ", start);
-	//std::cout << destChannel << " " << nSamples << " " << start << " " << start + (double)(size1 * step) + double(size2 * step) << std::endl;
+	return (float)used / (float)(fifo->getTotalSize() - m_historySize);
+}
+
+void DataQueue::addTimestampBlock(TimestampStream* stream, int numSamples)
+{
+	if (numSamples == 0)
+		return;
+
+	int64 index = stream->numBlocks.load(std::memory_order_relaxed);
 
-	for (int i = 0; i < size1; i++)
+	/* Publish the block once the reader is done with its slot. Otherwise the block is dropped and
+	   counted, and the previous block's timestamps are extrapolated over its samples */
+	if (index - stream->capacity < stream->firstNeededBlock.load(std::memory_order_acquire))
 	{
-		m_FTSBuffer.setSample(destChannel, index1+i, start+(double)i*step);
-	}
+		TimestampBlock& block = stream->blocks[index % stream->capacity];
+		block.firstSample = stream->samplesWritten;
+		block.numSamples = numSamples;
+		block.start = stream->pendingStart;
+		block.step = stream->pendingStep;
 
-	if (size2 > 0)
+		stream->numBlocks.store(index + 1, std::memory_order_release);
+	}
+	else
 	{
-		for (int i = 0; i < size2; i++)
-		{
-			m_FTSBuffer.setSample(destChannel, index2 + i, start+(double)(size1*step) + double(i*step));
-		}
+		stream->droppedBlocks.fetch_add(1, std::memory_order_relaxed);
 	}
 
-	m_FTSFifos[destChannel]->finishedWrite(size1 + size2);
-
-	return 1.0f - (float)m_FTSFifos[destChannel]->getFreeSpace() / (float)m_FTSFifos[destChannel]->getTotalSize();
-
+	stream->samplesWritten += numSamples;
 }
 
-
 float DataQueue::writeChannel(const AudioBuffer<float>& buffer, 
 	int srcChannel, int destChannel, int nSamples, int64 sampleNumber)
 {
@@ -221,7 +295,17 @@ float DataQueue::writeChannel(const AudioBuffer<float>& buffer,
 	}
 	m_fifos[destChannel]->finishedWrite(size1 + size2);
 
-	return 1.0f - (float)m_fifos[destChannel]->getFreeSpace() / (float)m_fifos[destChannel]->getTotalSize();
+	TimestampStream* stream = m_timestampStreams[m_channelStreams[destChannel]];
+
+	if (stream->firstChannel == destChannel)
+		addTimestampBlock(stream, size1 + size2);
+
+	float usage = getUsage(destChannel);
+
+	if (usage > m_highWaterMark.load(std::memory_order_relaxed))
+		m_highWaterMark.store(usage, std::memory_order_relaxed);
+
+	return usage;
 }
 
 /*
@@ -236,13 +320,7 @@ const AudioBuffer<float>& DataQueue::getContinuousDataBufferReference() const
 	return m_buffer;
 }
 
-const SynchronizedTimestampBuffer& DataQueue::getTimestampBufferReference() const
-{
-	return m_FTSBuffer;
-}
-
 bool DataQueue::startRead(Array<CircularBufferIndexes>& dataIndexes, 
-		Array<CircularBufferIndexes>& ftsIndexes, 
 		Array<int64>& sampleNumbers, int nMax)
 {
 
@@ -252,7 +330,6 @@ bool DataQueue::startRead(Array<CircularBufferIndexes>& dataIndexes,
 
 	m_readInProgress = true;
 	dataIndexes.clear();
-	ftsIndexes.clear();
 	sampleNumbers.clear();
 
 	for (int chan = 0; chan < m_numChans; ++chan)
@@ -295,22 +372,92 @@ bool DataQueue::startRead(Array<CircularBufferIndexes>& dataIndexes,
 		m_lastReadSampleNumbers.set(chan, sampleNum + idx.size1 + idx.size2);
 	}
 
-	for (int chan = 0; chan < m_numFTSChans; ++chan)
+	//std::cout << "  " << std::endl;
+
+	return true;
+}
+
+void DataQueue::getTimestamps(int channel, int offset, int numSamples, double* dest) const
+{
+	const TimestampStream* stream = m_timestampStreams[m_channelStreams[channel]];
+
+	int64 first = stream->firstNeededBlock.load(std::memory_order_relaxed);
+	int64 last = stream->numBlocks.load(std::memory_order_acquire) - 1;
+
+	if (last < first)
 	{
-		CircularBufferIndexes idx;
-		int readyToRead = m_FTSFifos[chan]->getNumReady();
-		int samplesToRead = ((readyToRead > nMax) && (nMax > 0)) ? nMax : readyToRead;
+		for (int i = 0; i < numSamples; i++)
+			dest[i] = 0;
+		return;
+	}
 
-		m_FTSFifos[chan]->prepareToRead(samplesToRead, idx.index1, idx.size1, idx.index2, idx.size2);
-		//if (chan == 0)
-		//	LOGD("idx1: ", idx.index1, " | s1: ", idx.size1, " | idx2: ", idx.index2, " | s2: ", idx.size2);
-		ftsIndexes.add(idx);
-		m_readFTSSamples.set(chan, idx.size1 + idx.size2);
+	int64 position = m_channelSamplesRead[channel] + offset;
+
+	/* Find the last block that starts at or before the first requested sample */
+	int64 low = first;
+	int64 high = last;
+
+	while (low < high)
+	{
+		int64 mid = (low + high + 1) / 2;
+
+		if (stream->blocks[mid % stream->capacity].firstSample <= position)
+			low = mid;
+		else
+			high = mid - 1;
 	}
 
-	//std::cout << "  " << std::endl;
+	int64 index = low;
+	const TimestampBlock* block = &stream->blocks[index % stream->capacity];
 
-	return true;
+	for (int i = 0; i < numSamples; i++, position++)
+	{
+		while (index < last && stream->blocks[(index + 1) % stream->capacity].firstSample <= position)
+			block = &stream->blocks[++index % stream->capacity];
+
+		dest[i] = block->start + double(position - block->firstSample) * block->step;
+	}
+}
+
+void DataQueue::releaseTimestampBlocks()
+{
+	for (int s = 0; s < m_timestampStreams.size(); ++s)
+	{
+		TimestampStream* stream = m_timestampStreams[s];
+
+		if (stream->firstChannel < 0)
+			continue;
+
+		int64 minRead = m_channelSamplesRead[stream->firstChannel];
+
+		for (int chan = stream->firstChannel + 1; chan < m_numChans && m_channelStreams[chan] == s; ++chan)
+			minRead = jmin(minRead, m_channelSamplesRead[chan]);
+
+		int64 first = stream->firstNeededBlock.load(std::memory_order_relaxed);
+		int64 last = stream->numBlocks.load(std::memory_order_acquire) - 1;
+
+		while (first < last && stream->blocks[(first + 1) % stream->capacity].firstSample <= minRead)
+			first++;
+
+		stream->firstNeededBlock.store(first, std::memory_order_release);
+
+		int64 dropped = stream->droppedBlocks.load(std::memory_order_relaxed);
+
+		if (dropped > stream->reportedDroppedBlocks)
+		{
+			LOGE("DataQueue: ", dropped - stream->reportedDroppedBlocks, " timestamp blocks of stream ", s,
+				" dropped (", dropped, " total); their timestamps were extrapolated from the previous block");
+			stream->reportedDroppedBlocks = dropped;
+		}
+	}
+}
+
+void DataQueue::keepSamples(int channel, int numSamples)
+{
+	numSamples = jmin(numSamples, m_readSamples[channel]);
+
+	m_readSamples.set(channel, m_readSamples[channel] - numSamples);
+	m_lastReadSampleNumbers.set(channel, m_lastReadSampleNumbers[channel] - numSamples);
 }
 
 void DataQueue::stopRead()
@@ -321,14 +468,11 @@ void DataQueue::stopRead()
 	for (int i = 0; i < m_numChans; ++i)
 	{
 		m_fifos[i]->finishedRead(m_readSamples[i]);
+		m_channelSamplesRead.set(i, m_channelSamplesRead[i] + m_readSamples[i]);
 		m_readSamples.set(i, 0);
 	}
 
-	for (int i = 0; i < m_numFTSChans; ++i)
-	{
-		m_FTSFifos[i]->finishedRead(m_readFTSSamples[i]);
-		m_readFTSSamples.set(i, 0);
-	}
+	releaseTimestampBlocks();
 
 	m_readInProgress = false;
 }
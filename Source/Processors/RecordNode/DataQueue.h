@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <JuceHeader.h>
 #include "../../Utils/Utils.h"
 
+#include <atomic>
+
 class Synchronizer;
 
 struct CircularBufferIndexes
@@ -37,6 +39,15 @@ struct CircularBufferIndexes
 	int size2;
 };
 
+/** Timestamps of one block of samples written to the queue: timestamp(i) = start + i * step */
+struct TimestampBlock
+{
+	int64 firstSample; // position of the first sample, counted from the start of the recording
+	int numSamples;
+	double start;
+	double step;
+};
+
 /**
  *
  * Buffers data from the Record Node prior to disk writing
@@ -56,12 +67,17 @@ public:
 	/** Sets the number of continuous channel buffers needed */
 	void setChannelCount(int nChans);
 
-	/** Sets the number of timestamp buffers needed */
-	void setTimestampStreamCount(int nStreams);
+	/** Sets the number of streams, and the stream index of each recorded channel */
+	void setTimestampStreamCount(int nStreams, const Array<int>& channelStreams);
 
 	/** Changes the number of blocks in the queue */
 	void resize(int nBlocks);
 
+	/** Adds room for numSamples of history per channel on top of the regular queue size.
+		Samples kept with keepSamples() don't count towards the usage reported to the writer,
+		up to this size. */
+	void setHistorySize(int numSamples);
+
 	/** Returns an array of sample numbers for a given block*/
 	void getSampleNumbersForBlock(int idx, Array<int64>& sampleNumbers) const;
 
@@ -70,11 +86,21 @@ public:
 	/** Writes an array of data for one channel */
 	float writeChannel(const AudioBuffer<float>& buffer, int srcChannel, int destChannel, int nSamples, int64 sampleNumbers);
 
-	/** Writes an array of timestamps for one stream */
-	float writeSynchronizedTimestamps(double start, double step, int destChannel, int64 nSamples);
+	/** Sets the timestamps of the next block of one stream. Only (start, step) is stored, and it is
+		attached to the block when the first channel of the stream is written. Returns the usage of
+		the stream's FIFO once the block's nSamples samples have been written. */
+	float writeSynchronizedTimestamps(double start, double step, int destStream, int64 nSamples);
 
 	/** Start reading data for one channel */
-	bool startRead(Array<CircularBufferIndexes>& dataIndexes, Array<CircularBufferIndexes>& ftsIndexes, Array<int64>& sampleNumbers, int nMax);
+	bool startRead(Array<CircularBufferIndexes>& dataIndexes, Array<int64>& sampleNumbers, int nMax);
+
+	/** Computes the timestamps of numSamples samples of a channel, starting at an offset
+		within the current read. Can be called for different streams in parallel. */
+	void getTimestamps(int channel, int offset, int numSamples, double* dest) const;
+
+	/** Leaves the last numSamples of a channel's current read in the queue, so that
+		they are returned again by the next startRead(). Must be called before stopRead(). */
+	void keepSamples(int channel, int numSamples);
 
 	/** Called when data read is finished */
 	void stopRead();
@@ -82,36 +108,72 @@ public:
 	/** Returns a reference to the continuous data buffer */
 	const AudioBuffer<float>& getContinuousDataBufferReference() const;
 
-	/** Returns a reference to the timestamp buffer */
-	const SynchronizedTimestampBuffer& getTimestampBufferReference() const;
-
 	/** Returns the current block size*/
 	int getBlockSize();
 
+	/** Returns the fraction of the fullest channel FIFO in use, not counting the history */
+	float getUsage() const;
+
+	/** Returns the highest usage seen by the writer since the last resetHighWaterMark() */
+	float getHighWaterMark() const;
+
+	/** Resets the high-water mark */
+	void resetHighWaterMark();
+
 private:
 
 	/** Fills the sample number buffer for a given channel */
 	void fillSampleNumbers(int channel, int index, int size, int64 sampleNumbers);
 
+	/** Returns the fraction of a channel's FIFO in use, not counting the history */
+	float getUsage(int channel) const;
+
+	/** Timestamp blocks of one stream, in a single-producer / single-consumer ring */
+	struct TimestampStream
+	{
+		HeapBlock<TimestampBlock> blocks;
+		int capacity;
+		int firstChannel;
+
+		std::atomic<int64> numBlocks; // blocks published by the writer
+		std::atomic<int64> firstNeededBlock; // oldest block the reader may still use
+		std::atomic<int64> droppedBlocks; // blocks skipped because the ring was full
+
+		int64 reportedDroppedBlocks; // reader only
+
+		int64 samplesWritten; // writer only
+		double pendingStart; // writer only
+		double pendingStep; // writer only
+	};
+
+	/** Publishes a block for a stream, after its first channel has been written */
+	void addTimestampBlock(TimestampStream* stream, int numSamples);
+
+	/** Lets the writer reuse the blocks that have been read by all channels of every stream */
+	void releaseTimestampBlocks();
+
 	int lastIdx;
 
 	OwnedArray<AbstractFifo> m_fifos;
-	OwnedArray<AbstractFifo> m_FTSFifos;
 
 	AudioSampleBuffer m_buffer;
-	SynchronizedTimestampBuffer m_FTSBuffer;
+
+	OwnedArray<TimestampStream> m_timestampStreams;
+	Array<int> m_channelStreams;
+	Array<int64> m_channelSamplesRead;
 
 	Array<int> m_readSamples;
-	Array<int> m_readFTSSamples;
 	OwnedArray<Array<int64>> m_sampleNumbers;
 	Array<int64> m_lastReadSampleNumbers;
 
 	int m_numChans;
-	int m_numFTSChans;
 	int m_blockSize;
 	bool m_readInProgress;
 	int m_numBlocks;
 	int m_maxSize;
+	int m_baseBlocks;
+	int m_historySize;
+	std::atomic<float> m_highWaterMark;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataQueue);
 };
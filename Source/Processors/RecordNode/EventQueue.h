@@ -27,108 +27,278 @@
 #include <JuceHeader.h>
 
 #include <vector>
+#include <atomic>
 
 #include "../Events/Spike.h"
 
-template <class MsgContainer>
-class AsyncEventMessage :
-	public ReferenceCountedObject
+/**
+	A read-only view of an event or spike stored in an EventQueue.
+
+	Points directly into the queue's slab; it remains valid until
+	the reader calls EventQueue::releaseEvents().
+*/
+class EventView
 {
 public:
-	AsyncEventMessage(const MsgContainer& m, int64 t, int extra) : 
-		ReferenceCountedObject(),
-		m_data(m),
+	EventView() : m_data(nullptr), m_size(0), m_timestamp(0), m_extra(0) {}
+
+	EventView(const uint8* data, size_t size, int64 t, int extra) :
+		m_data(data),
+		m_size(size),
 		m_timestamp(t),
 		m_extra(extra)
 	{}
 
-	~AsyncEventMessage() {};
+	/** Returns a pointer to the serialized event or spike */
+	const uint8* getRawData() const { return m_data; }
+
+	/** Returns the size of the serialized event or spike, in bytes */
+	size_t getRawDataSize() const { return m_size; }
 
-	const MsgContainer& getData() const { return m_data;  }
 	const int64& getTimestamp() const { return m_timestamp; }
-	const int& getExtra() const { return m_extra;  }
+	const int& getExtra() const { return m_extra; }
 
 private:
-	const MsgContainer m_data;
-	const int64 m_timestamp;
-	const int m_extra;
-
+	const uint8* m_data;
+	size_t m_size;
+	int64 m_timestamp;
+	int m_extra;
 };
 
+/** Serialization helpers used by EventQueue::addEvent */
+inline size_t getSerializedEventSize(const EventPacket& packet)
+{
+	return packet.getRawDataSize();
+}
+
+inline void serializeEvent(const EventPacket& packet, uint8* dest, size_t size)
+{
+	memcpy(dest, packet.getRawData(), size);
+}
+
+inline size_t getSerializedEventSize(const Spike& spike)
+{
+	const SpikeChannel* chan = spike.getChannelInfo();
+
+	return SPIKE_BASE_SIZE + chan->getNumChannels() * sizeof(float) + chan->getDataSize() + chan->getTotalEventMetadataSize();
+}
+
+inline void serializeEvent(const Spike& spike, uint8* dest, size_t size)
+{
+	spike.serialize(dest, size);
+}
+
+inline size_t getSerializedEventSize(const TTLEventView& event)
+{
+	return event.getRawDataSize();
+}
+
+inline void serializeEvent(const TTLEventView& event, uint8* dest, size_t size)
+{
+	memcpy(dest, event.getRawData(), size);
+}
+
+inline size_t getSerializedEventSize(const SpikeView& spike)
+{
+	return spike.getRawDataSize();
+}
+
+inline void serializeEvent(const SpikeView& spike, uint8* dest, size_t size)
+{
+	memcpy(dest, spike.getRawData(), size);
+}
+
+/**
+	Single-producer, single-consumer queue of serialized events or spikes.
+
+	Events are serialized straight into a preallocated slab of fixed-size
+	slots, so adding an event never allocates. An event larger than a slot
+	spans several consecutive slots. If the queue is full, the event is
+	dropped and counted; the reader can retrieve the number of dropped
+	events with getNumDroppedEvents().
+*/
 template <class EventClass>
 class EventQueue
 {
 public:
-	typedef AsyncEventMessage<EventClass> EventContainer;
-	typedef ReferenceCountedObjectPtr<EventContainer> EventClassPtr;
 
+	/** Creates a queue holding up to size events of up to DEFAULT_SLOT_SIZE bytes each */
 	EventQueue(int size) :
-		m_fifo(size)
+		m_numSlots(size),
+		m_slotSize(DEFAULT_SLOT_SIZE)
 	{
-		m_data.resize(size);
+		allocate();
 	}
 
 	~EventQueue()
 	{}
 
+	/** Returns the number of events waiting to be read */
 	int getRemainingEvents() const
 	{
-		return m_fifo.getNumReady();
+		return int(m_numEventsWritten.load(std::memory_order_acquire) - m_numEventsRead.load(std::memory_order_relaxed));
 	}
 
+	/** Discards all queued events and clears the drop counter. Must not be called while the queue is in use. */
 	void reset()
 	{
-		m_data.clear();
-		m_data.resize(m_fifo.getTotalSize());
+		m_writeSlot = 0;
+		m_readSlot = 0;
+		m_pendingReadSlot = 0;
+		m_numEventsWritten = 0;
+		m_numEventsRead = 0;
+		m_numDropped = 0;
 	}
 
+	/** Changes the number of slots. Must not be called while the queue is in use. */
 	void resize(int size)
 	{
-		m_data.clear();
-		m_fifo.setTotalSize(size);
-		m_data.resize(size);
+		m_numSlots = size;
+		allocate();
+	}
+
+	/** Sets the size of a slot to fit the largest expected event. Must not be called while the queue is in use. */
+	void setSlotSize(size_t maxEventSize)
+	{
+		size_t slotSize = (sizeof(SlotHeader) + maxEventSize + SLOT_ALIGNMENT - 1) & ~size_t(SLOT_ALIGNMENT - 1);
+
+		if (slotSize == m_slotSize)
+			return;
+
+		m_slotSize = slotSize;
+		allocate();
 	}
 
-	void addEvent(const EventClass& ev, int64 t, int extra = 0)
+	/** Copies an event into the queue. Called from the audio thread; never allocates or blocks.
+		Besides EventClass itself, ev can be any type with getSerializedEventSize() and
+		serializeEvent() overloads producing the same packet layout (e.g. a SpikeView). */
+	template <class SourceType>
+	void addEvent(const SourceType& ev, int64 t, int extra = 0)
 	{
-		int pos1, size1, pos2, size2;
-		size1 = 0;
-		m_fifo.prepareToWrite(1, pos1, size1, pos2, size2);
+		size_t size = getSerializedEventSize(ev);
+		int64 slotsNeeded = (sizeof(SlotHeader) + size + m_slotSize - 1) / m_slotSize;
 
-		/* This means there is a buffer overrun. Instead of overwritting the existing data and risking a collision of both threads
-			we just skip the incoming samples. TODO: use this to notify of the overrun and act consequently   */
-		if (size1 > 0)
+		int64 writeSlot = m_writeSlot.load(std::memory_order_relaxed);
+		int64 freeSlots = m_numSlots - (writeSlot - m_readSlot.load(std::memory_order_acquire));
+
+		/* Events never wrap around the end of the slab; the remaining slots are skipped instead */
+		int64 position = writeSlot % m_numSlots;
+		int64 padding = (position + slotsNeeded > m_numSlots) ? m_numSlots - position : 0;
+
+		if (slotsNeeded > m_numSlots || padding + slotsNeeded > freeSlots)
 		{
-			m_data[pos1] = new EventContainer(ev, t, extra);
-			m_fifo.finishedWrite(1);
+			/* Buffer overrun: the record thread is not keeping up. Instead of overwritting unread data
+			   we drop the incoming event and count it, so that the loss can be reported. */
+			m_numDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
 		}
+
+		if (padding > 0)
+		{
+			SlotHeader* header = getHeader(position);
+			header->size = 0;
+			header->numSlots = int(padding);
+			writeSlot += padding;
+			position = 0;
+		}
+
+		SlotHeader* header = getHeader(position);
+		header->timestamp = t;
+		header->extra = extra;
+		header->size = int(size);
+		header->numSlots = int(slotsNeeded);
+
+		serializeEvent(ev, reinterpret_cast<uint8*>(header + 1), size);
+
+		m_writeSlot.store(writeSlot + slotsNeeded, std::memory_order_release);
+		m_numEventsWritten.fetch_add(1, std::memory_order_release);
 	}
 
-	int getEvents(std::vector<EventClassPtr>& vec, int max)
+	/** Fills vec with views of up to max queued events (all of them if max is 0).
+		The views stay valid until releaseEvents() is called. */
+	int getEvents(std::vector<EventView>& vec, int max)
 	{
-		int pos1, size1, pos2, size2;
-		int numAvailable = m_fifo.getNumReady();
-		int numToRead = ((max < numAvailable) && (max > 0)) ? max : numAvailable;
-		m_fifo.prepareToRead(numToRead, pos1, size1, pos2, size2);
-		vec.resize(numToRead);
-		for (int i = 0; i < size1; ++i)
+		int64 writeSlot = m_writeSlot.load(std::memory_order_acquire);
+		int64 readSlot = m_pendingReadSlot;
+
+		vec.clear();
+
+		while (readSlot < writeSlot && (max <= 0 || int(vec.size()) < max))
 		{
-			vec[i] = m_data[pos1 + i];
+			const SlotHeader* header = getHeader(readSlot % m_numSlots);
+
+			if (header->size > 0)
+				vec.emplace_back(reinterpret_cast<const uint8*>(header + 1), header->size, header->timestamp, header->extra);
+
+			readSlot += header->numSlots;
 		}
-		if (size2 > 0)
+
+		m_pendingReadSlot = readSlot;
+
+		return int(vec.size());
+	}
+
+	/** Returns the slots of all events retrieved by getEvents() to the writer */
+	void releaseEvents()
+	{
+		int64 released = 0;
+
+		for (int64 slot = m_readSlot.load(std::memory_order_relaxed); slot < m_pendingReadSlot;)
 		{
-			for (int i = 0; i < size2; ++i)
-			{
-				vec[size1 + i] = m_data[pos2 + i];
-			}
+			const SlotHeader* header = getHeader(slot % m_numSlots);
+
+			if (header->size > 0)
+				released++;
+
+			slot += header->numSlots;
 		}
-		m_fifo.finishedRead(numToRead);
-		return numToRead;
+
+		m_numEventsRead.fetch_add(released, std::memory_order_relaxed);
+		m_readSlot.store(m_pendingReadSlot, std::memory_order_release);
+	}
+
+	/** Returns the number of events dropped because the queue was full since the last reset() */
+	int64 getNumDroppedEvents() const
+	{
+		return m_numDropped.load(std::memory_order_relaxed);
 	}
 
 private:
-	std::vector<EventClassPtr> m_data;
-	AbstractFifo m_fifo;
+
+	static const size_t DEFAULT_SLOT_SIZE = 64;
+	static const size_t SLOT_ALIGNMENT = 8;
+
+	struct SlotHeader
+	{
+		int64 timestamp;
+		int extra;
+		int size;
+		int numSlots;
+		int reserved;
+	};
+
+	SlotHeader* getHeader(int64 slot) const
+	{
+		return reinterpret_cast<SlotHeader*>(m_slab.getData() + slot * m_slotSize);
+	}
+
+	void allocate()
+	{
+		m_slab.allocate(size_t(m_numSlots) * m_slotSize, true);
+		reset();
+	}
+
+	HeapBlock<uint8> m_slab;
+	int64 m_numSlots;
+	size_t m_slotSize;
+
+	std::atomic<int64> m_writeSlot{ 0 };
+	std::atomic<int64> m_readSlot{ 0 };
+	int64 m_pendingReadSlot{ 0 };
+
+	std::atomic<int64> m_numEventsWritten{ 0 };
+	std::atomic<int64> m_numEventsRead{ 0 };
+	std::atomic<int64> m_numDropped{ 0 };
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventQueue);
 };
@@ -136,8 +306,6 @@ private:
 //Once the probe system is implemented, this will be normalized
 typedef EventQueue<EventPacket> EventMsgQueue;
 typedef EventQueue<Spike> SpikeMsgQueue;
-typedef ReferenceCountedObjectPtr<AsyncEventMessage<EventPacket>> EventMessagePtr;
-typedef ReferenceCountedObjectPtr<AsyncEventMessage<Spike>> SpikeMessagePtr;
 
 #endif  // EVENTQUEUE_H_INCLUDED
 
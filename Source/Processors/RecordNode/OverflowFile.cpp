@@ -0,0 +1,186 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "OverflowFile.h"
+
+OverflowFile::OverflowFile(const File& directory) :
+	m_writePosition(0),
+	m_readPosition(0)
+{
+	if (!directory.exists())
+		directory.createDirectory();
+
+	m_file = directory.getNonexistentChildFile("open-ephys-overflow", ".tmp", false);
+
+	if (!reset())
+		LOGE("OverflowFile: unable to create ", m_file.getFullPathName());
+}
+
+OverflowFile::~OverflowFile()
+{
+	m_input.reset();
+	m_output.reset();
+	m_file.deleteFile();
+}
+
+bool OverflowFile::reset()
+{
+	m_input.reset();
+	m_output.reset();
+
+	m_file.deleteFile();
+	m_writePosition = 0;
+	m_readPosition = 0;
+
+	/* Unbuffered, so that the file never holds less than m_writePosition says it does */
+	m_output = std::make_unique<FileOutputStream>(m_file, 0);
+
+	if (m_output->failedToOpen())
+	{
+		m_output.reset();
+		return false;
+	}
+
+	m_input = std::make_unique<FileInputStream>(m_file);
+
+	if (m_input->failedToOpen())
+	{
+		m_input.reset();
+		m_output.reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool OverflowFile::isOpen() const
+{
+	return m_output != nullptr;
+}
+
+String OverflowFile::getPath() const
+{
+	return m_file.getFullPathName();
+}
+
+bool OverflowFile::writeRecord(int firstChannel,
+	int numChannels,
+	int numSamples,
+	const int64* sampleNumbers,
+	const double* timestamps,
+	const float* const* data)
+{
+	if (m_output == nullptr)
+		return false;
+
+	RecordHeader header;
+	header.firstChannel = firstChannel;
+	header.numChannels = numChannels;
+	header.numSamples = numSamples;
+	header.reserved = 0;
+
+	bool ok = m_output->write(&header, sizeof(RecordHeader));
+	ok = ok && m_output->write(sampleNumbers, numChannels * sizeof(int64));
+	ok = ok && m_output->write(timestamps, numSamples * sizeof(double));
+
+	for (int i = 0; i < numChannels && ok; i++)
+		ok = m_output->write(data[i], numSamples * sizeof(float));
+
+	if (!ok)
+	{
+		LOGE("OverflowFile: write to ", m_file.getFullPathName(), " failed");
+
+		/* Drop whatever part of the record made it to disk */
+		if (!m_output->setPosition(m_writePosition) || m_output->truncate().failed())
+			LOGE("OverflowFile: unable to remove a partial record from ", m_file.getFullPathName());
+
+		return false;
+	}
+
+	m_writePosition += sizeof(RecordHeader) + numChannels * sizeof(int64) + numSamples * (sizeof(double) + numChannels * sizeof(float));
+
+	return true;
+}
+
+bool OverflowFile::hasData() const
+{
+	return m_readPosition < m_writePosition;
+}
+
+int64 OverflowFile::getPendingBytes() const
+{
+	return m_writePosition - m_readPosition;
+}
+
+bool OverflowFile::readRecord(int& firstChannel,
+	int& numChannels,
+	int& numSamples,
+	Array<int64>& sampleNumbers,
+	HeapBlock<double>& timestamps,
+	AudioBuffer<float>& data)
+{
+	if (!hasData())
+		return false;
+
+	RecordHeader header;
+
+	if (m_input->read(&header, sizeof(RecordHeader)) != sizeof(RecordHeader))
+		return false;
+
+	if (header.numChannels <= 0 || header.numSamples < 0)
+		return false;
+
+	firstChannel = header.firstChannel;
+	numChannels = header.numChannels;
+	numSamples = header.numSamples;
+
+	sampleNumbers.resize(numChannels);
+	timestamps.realloc(numSamples);
+
+	if (data.getNumChannels() < numChannels || data.getNumSamples() < numSamples)
+		data.setSize(jmax(numChannels, data.getNumChannels()), jmax(numSamples, data.getNumSamples()));
+
+	const int sampleNumberBytes = numChannels * sizeof(int64);
+	const int timestampBytes = numSamples * sizeof(double);
+	const int channelBytes = numSamples * sizeof(float);
+
+	if (m_input->read(sampleNumbers.getRawDataPointer(), sampleNumberBytes) != sampleNumberBytes)
+		return false;
+
+	if (m_input->read(timestamps.getData(), timestampBytes) != timestampBytes)
+		return false;
+
+	for (int i = 0; i < numChannels; i++)
+	{
+		if (m_input->read(data.getWritePointer(i), channelBytes) != channelBytes)
+			return false;
+	}
+
+	m_readPosition = m_input->getPosition();
+
+	/* Reclaim the scratch space once everything has been read back */
+	if (m_readPosition >= m_writePosition)
+		reset();
+
+	return true;
+}
@@ -0,0 +1,104 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef OVERFLOWFILE_H_INCLUDED
+#define OVERFLOWFILE_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../../Utils/Utils.h"
+
+/**
+	Temporary file used by the RecordThread to hold continuous data
+	that the record engine cannot keep up with.
+
+	When the DataQueue fills up, its contents are appended to this file
+	(ideally on a fast scratch drive) as raw records, each one holding
+	a range of channels with their sample numbers, timestamps and samples.
+	The records are read back in the same order and passed to the record
+	engine once it catches up. The file is truncated whenever it has been
+	read completely, and deleted when the object is destroyed.
+*/
+class OverflowFile
+{
+public:
+
+	/** Creates an overflow file in a scratch directory */
+	OverflowFile(const File& directory);
+
+	/** Destructor; deletes the file */
+	~OverflowFile();
+
+	/** Returns true if the file could be created */
+	bool isOpen() const;
+
+	/** Appends numSamples samples for numChannels consecutive write channels.
+		If this fails, the partial record is removed and the file is left as it was. */
+	bool writeRecord(int firstChannel,
+		int numChannels,
+		int numSamples,
+		const int64* sampleNumbers,
+		const double* timestamps,
+		const float* const* data);
+
+	/** Returns true if some records have not been read back yet */
+	bool hasData() const;
+
+	/** Returns the number of bytes waiting to be read back */
+	int64 getPendingBytes() const;
+
+	/** Reads the next record; the buffers are resized as needed.
+		Returns false if the record is missing or incomplete. */
+	bool readRecord(int& firstChannel,
+		int& numChannels,
+		int& numSamples,
+		Array<int64>& sampleNumbers,
+		HeapBlock<double>& timestamps,
+		AudioBuffer<float>& data);
+
+	/** Returns the path of the file */
+	String getPath() const;
+
+private:
+
+	struct RecordHeader
+	{
+		int32 firstChannel;
+		int32 numChannels;
+		int32 numSamples;
+		int32 reserved;
+	};
+
+	/** Opens an empty file */
+	bool reset();
+
+	File m_file;
+	std::unique_ptr<FileOutputStream> m_output;
+	std::unique_ptr<FileInputStream> m_input;
+
+	int64 m_writePosition;
+	int64 m_readPosition;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OverflowFile);
+};
+
+#endif  // OVERFLOWFILE_H_INCLUDED
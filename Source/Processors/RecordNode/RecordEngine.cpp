@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "EngineConfigWindow.h"
 #include "BinaryFormat/BinaryRecording.h"
+#include "CompressedFormat/CompressedRecording.h"
 
 RecordEngine::RecordEngine()
 	: manager(nullptr), recordNode(nullptr)
@@ -88,6 +89,22 @@ void RecordEngine::updateLatestSampleNumbers(const Array<int64>& num, int channe
 
 }
 
+void RecordEngine::writeContinuousStreamData(int firstWriteChannel,
+	int numChannels,
+	const float* const* dataBuffers,
+	const double* timestampBuffer,
+	int size)
+{
+	for (int i = 0; i < numChannels; i++)
+	{
+		writeContinuousData(firstWriteChannel + i,
+			getGlobalIndex(firstWriteChannel + i),
+			dataBuffers[i],
+			timestampBuffer,
+			size);
+	}
+}
+
 void RecordEngine::setChannelMap(const Array<int>& globalChans,
                                  const Array<int>& localChans)
 {
@@ -239,7 +256,7 @@ void RecordEngineManager::addParameter(EngineParameter* param)
 
 int RecordEngineManager::getNumOfBuiltInEngines()
 {
-	return 1;
+	return 2;
 }
 
 RecordEngineManager* RecordEngineManager::createBuiltInEngineManager(int index)
@@ -248,6 +265,8 @@ RecordEngineManager* RecordEngineManager::createBuiltInEngineManager(int index)
 	{
 	case 0:
 		return BinaryRecording::getEngineManager();
+	case 1:
+		return CompressedRecording::getEngineManager();
 
 	default:
 		return nullptr;
@@ -269,6 +288,10 @@ RecordEngine* RecordEngineManager::instantiateEngine()
 	{
 		return new BinaryRecording();
 	}
+	else if (id == "COMPRESSED")
+	{
+		return new CompressedRecording();
+	}
 
 	return nullptr;
 }
@@ -112,6 +112,25 @@ public:
 	/** Called by configureEngine() */
 	virtual void setParameter(EngineParameter& parameter) { }
 
+	/** Write continuous data for a contiguous range of recorded channels belonging to the same stream,
+		all starting at the same sample. The default implementation calls writeContinuousData()
+		for each channel; engines that interleave channels can override it to write them all at once. */
+	virtual void writeContinuousStreamData(int firstWriteChannel,
+					 int numChannels,
+					 const float* const* dataBuffers,
+					 const double* timestampBuffer,
+					 int size);
+
+	/** Returns true if writeContinuousData() can be called concurrently for channels
+		belonging to different data streams. Channels within a stream are always
+		written sequentially, and events and spikes are always written from the
+		RecordThread itself. */
+	virtual bool supportsParallelWrites() const { return false; }
+
+	/** Returns true if data could not be written to disk. Checked by the RecordThread
+		after every write, which then asks the Record Node to stop recording. */
+	virtual bool hasWriteError() const { return false; }
+
 	// ------------------------------------------------------------
 	//                    OTHER METHODS
 	// ------------------------------------------------------------
@@ -43,15 +43,23 @@ void EventMonitor::displayStatus()
 
 RecordNode::RecordNode()
 	: GenericProcessor("Record Node"),
+	parallelWrites(true),
+	triggeredRecording(false),
+	preTriggerSeconds(2.0f),
+	postTriggerSeconds(2.0f),
+	triggerLine(1),
+	overflowDirectory(String()),
 	newDirectoryNeeded(true),
-	setFirstBlock(false),
 	samplesWritten(0),
-	experimentNumber(1), // 1-based indexing
-	recordingNumber(0), // 0-based indexing
+	numDataStreams(0),
 	isRecording(false),
 	hasRecorded(false),
 	settingsNeeded(false),
-	numDataStreams(0)
+	experimentNumber(1), // 1-based indexing
+	recordingNumber(0), // 0-based indexing
+	triggerActive(false),
+	overflowActive(false),
+	setFirstBlock(false)
 {
 
 	//Get the current audio device's buffer size and use as data queue block size
@@ -63,6 +71,7 @@ RecordNode::RecordNode()
 	dataQueue = std::make_unique<DataQueue>(bufferSize, DATA_BUFFER_NBLOCKS);
 	eventQueue = std::make_unique<EventMsgQueue>(EVENT_BUFFER_NEVENTS);
 	spikeQueue = std::make_unique<SpikeMsgQueue>(SPIKE_BUFFER_NSPIKES);
+	recordTrigger = std::make_unique<RecordTrigger>();
 
 	isSyncReady = true;
 
@@ -106,6 +115,11 @@ String RecordNode::handleConfigMessage(String msg)
 	/*
 	Available messages:
 	- engine=<engine_name> -- changes the record engine
+	- parallel_writes=<0|1> -- writes each data stream on its own thread
+	- triggered_recording=<0|1> -- only writes windows around triggers (TTL line or "TRIGGER" broadcast message)
+	- pre_trigger=<seconds> / post_trigger=<seconds> -- length of the windows before and after each trigger
+	- trigger_line=<line> -- TTL line (1-based, 0 for none) that triggers a window on its rising edge
+	- overflow_directory=<path|none> -- scratch directory on a disk (not a RAM-backed tmpfs) used when the recording disk falls behind; "none" (the default) stops recording instead
 	- SELECT <stream_index> NONE / ALL / <channels> -- selects which channels to record, e.g.:
 		"SELECT 0 NONE" -- deselect all channels for stream 0
 		"SELECT 1 1 2 3 4 5 6 7 8" -- select channels 1-8 for stream 1
@@ -150,6 +164,65 @@ String RecordNode::handleConfigMessage(String msg)
 		}
 	}
 
+	if (tokens[0] == "parallel_writes")
+	{
+		if (tokens.size() == 2)
+		{
+			setParallelWrites(tokens[1].getIntValue() != 0);
+			return "Record Node: parallel writes " + String(parallelWrites ? "enabled" : "disabled");
+		}
+		else
+		{
+			return "Record Node: invalid parallel_writes key";
+		}
+	}
+
+	if (tokens[0] == "triggered_recording" || tokens[0] == "pre_trigger" || tokens[0] == "post_trigger")
+	{
+		if (tokens.size() == 2)
+		{
+			if (tokens[0] == "triggered_recording")
+				setTriggeredRecording(tokens[1].getIntValue() != 0, preTriggerSeconds, postTriggerSeconds);
+			else if (tokens[0] == "pre_trigger")
+				setTriggeredRecording(triggeredRecording, tokens[1].getFloatValue(), postTriggerSeconds);
+			else
+				setTriggeredRecording(triggeredRecording, preTriggerSeconds, tokens[1].getFloatValue());
+
+			return "Record Node: pre-trigger recording " + String(triggeredRecording ? "enabled" : "disabled")
+				+ " (" + String(preTriggerSeconds) + " s before, " + String(postTriggerSeconds) + " s after each trigger)";
+		}
+		else
+		{
+			return "Record Node: invalid " + tokens[0] + " key";
+		}
+	}
+
+	if (tokens[0] == "trigger_line")
+	{
+		if (tokens.size() == 2)
+		{
+			setTriggerLine(tokens[1].getIntValue());
+			return "Record Node: trigger line set to " + String(triggerLine);
+		}
+		else
+		{
+			return "Record Node: invalid trigger_line key";
+		}
+	}
+
+	if (tokens[0] == "overflow_directory")
+	{
+		if (tokens.size() == 2)
+		{
+			setOverflowDirectory(tokens[1]);
+			return "Record Node: overflow directory set to " + (overflowDirectory.isEmpty() ? String("none") : overflowDirectory);
+		}
+		else
+		{
+			return "Record Node: invalid overflow_directory key";
+		}
+	}
+
 	tokens.clear();
 	tokens.addTokens(msg, " ", "");
 
@@ -226,6 +299,18 @@ String RecordNode::handleConfigMessage(String msg)
 void RecordNode::handleBroadcastMessage(String msg)
 {
 
+	/* "TRIGGER" starts a window at the start of this block; "TRIGGER <stream id> <sample number>" at a given sample */
+	if (triggerActive && isRecording && msg.startsWith("TRIGGER"))
+	{
+		StringArray tokens;
+		tokens.addTokens(msg, " ", "");
+
+		if (tokens.size() == 3 && getDataStream(uint16(tokens[1].getIntValue())) != nullptr)
+			addTrigger(uint16(tokens[1].getIntValue()), tokens[2].getLargeIntValue());
+		else
+			addTrigger(synchronizer.mainStreamId, getFirstSampleNumberForBlock(synchronizer.mainStreamId));
+	}
+
     if (recordEvents && isRecording)
     {
 
@@ -682,9 +767,59 @@ void RecordNode::startRecording()
 
 	recordThread->setChannelMap(channelMap);
 	recordThread->setTimestampChannelMap(timestampChannelMap);
+	recordThread->setParallelWrites(parallelWrites);
+
+	triggerActive = triggeredRecording;
+
+	if (triggerActive)
+	{
+		Array<uint16> streamIds;
+		Array<float> sampleRates;
+
+		for (auto stream : dataStreams)
+		{
+			streamIds.add(stream->getStreamId());
+			sampleRates.add(stream->getSampleRate());
+		}
+
+		int mainStream = streamIds.indexOf(synchronizer.mainStreamId);
+
+		recordTrigger->configure(streamIds, sampleRates, timestampChannelMap, mainStream, preTriggerSeconds, postTriggerSeconds);
+
+		triggerSampleNumbers.clearQuick();
+		triggerSampleNumbers.insertMultiple(0, 0, dataStreams.size());
+
+		LOGC("Record Node ", getNodeId(), ": pre-trigger recording, ", preTriggerSeconds, " s before and ", postTriggerSeconds, " s after each trigger");
+	}
+
+	dataQueue->setHistorySize(triggerActive ? recordTrigger->getMaxPreTriggerSamples() : 0);
+	recordThread->setRecordTrigger(triggerActive ? recordTrigger.get() : nullptr);
+	overflowActive = isOverflowEnabled();
+	recordThread->setOverflowDirectory(overflowActive ? File(overflowDirectory) : File());
 
 	dataQueue->setChannelCount(numRecordedChannels);
-	dataQueue->setTimestampStreamCount(dataStreams.size());
+	dataQueue->setTimestampStreamCount(dataStreams.size(), timestampChannelMap);
+
+	/* Size the event queue slots to fit the largest TTL or binary event and the largest spike;
+	   text events are variable-length and span several slots if needed */
+	size_t maxEventSize = 0;
+
+	for (auto eventChannel : eventChannels)
+	{
+		if (eventChannel->getType() != EventChannel::TEXT)
+			maxEventSize = jmax(maxEventSize, eventChannel->getDataSize() + eventChannel->getTotalEventMetadataSize() + EVENT_BASE_SIZE);
+	}
+
+	size_t maxSpikeSize = 0;
+
+	for (auto spikeChannel : spikeChannels)
+	{
+		maxSpikeSize = jmax(maxSpikeSize, SPIKE_BASE_SIZE + spikeChannel->getNumChannels() * sizeof(float)
+			+ spikeChannel->getDataSize() + spikeChannel->getTotalEventMetadataSize());
+	}
+
+	eventQueue->setSlotSize(maxEventSize);
+	spikeQueue->setSlotSize(maxSpikeSize);
 
 	recordThread->setQueuePointers(dataQueue.get(), eventQueue.get(), spikeQueue.get());
 	recordThread->setFirstBlockFlag(false);
@@ -740,25 +875,76 @@ void RecordNode::setRecordSpikes(bool recordSpikes)
 	this->recordSpikes = recordSpikes;
 }
 
-void RecordNode::handleTTLEvent(TTLEventPtr event)
+void RecordNode::setParallelWrites(bool parallelWrites)
+{
+	this->parallelWrites = parallelWrites;
+}
+
+void RecordNode::setTriggeredRecording(bool enabled, float preTriggerSeconds, float postTriggerSeconds)
 {
+	this->triggeredRecording = enabled;
+	this->preTriggerSeconds = jmax(0.0f, preTriggerSeconds);
+	this->postTriggerSeconds = jmax(0.0f, postTriggerSeconds);
+}
 
-	eventMonitor->receivedEvents++;
+void RecordNode::setTriggerLine(int line)
+{
+	this->triggerLine = jmax(0, line);
+}
+
+void RecordNode::setOverflowDirectory(const String& path)
+{
+	if (path.isEmpty() || path == "none")
+		overflowDirectory = String();
+	else
+		overflowDirectory = path;
+}
 
-	int64 sampleNumber = event->getSampleNumber();
+bool RecordNode::isOverflowEnabled() const
+{
+	/* The pre-trigger history has to stay in the DataQueue, so it can't be moved to disk */
+	return overflowDirectory.isNotEmpty() && !triggerActive && File(overflowDirectory).isDirectory();
+}
 
-	synchronizer.addEvent(event->getStreamId(), event->getLine(), sampleNumber);
+void RecordNode::addTrigger(uint16 streamId, int64 sampleNumber)
+{
+	DataStream* triggerStream = getDataStream(streamId);
 
-	if (recordEvents && isRecording)
+	/* Map the trigger onto every stream relative to the current block, using the nominal sample rates */
+	double offset = double(sampleNumber - getFirstSampleNumberForBlock(streamId)) / triggerStream->getSampleRate();
+
+	for (int i = 0; i < dataStreams.size(); ++i)
 	{
+		const uint16 id = dataStreams[i]->getStreamId();
 
-		size_t size = event->getChannelInfo()->getDataSize() + event->getChannelInfo()->getTotalEventMetadataSize() + EVENT_BASE_SIZE;
+		if (id == streamId)
+			triggerSampleNumbers.set(i, sampleNumber);
+		else
+			triggerSampleNumbers.set(i, getFirstSampleNumberForBlock(id) + int64(std::round(offset * dataStreams[i]->getSampleRate())));
+	}
+
+	recordTrigger->addTrigger(triggerSampleNumbers);
+}
+
+void RecordNode::handleTTLEventView(const TTLEventView& event)
+{
+
+	eventMonitor->receivedEvents++;
+
+	int64 sampleNumber = event.getSampleNumber();
 
-		HeapBlock<char> buffer(size);
-        event->setTimestampInSeconds(synchronizer.convertSampleNumberToTimestamp(event->getStreamId(), sampleNumber));
-		event->serialize(buffer, size);
+	synchronizer.addEvent(event.getStreamId(), event.getLine(), sampleNumber);
 
-		eventQueue->addEvent(EventPacket(buffer, size), sampleNumber);
+	if (triggerActive && isRecording && event.getLine() == triggerLine - 1 && event.getState())
+		addTrigger(event.getStreamId(), sampleNumber);
+
+	if (recordEvents && isRecording)
+	{
+		/* Like handleEvent(), stamp the synchronized time into the packet and queue it as-is */
+		TTLEventView stampedEvent(event);
+		stampedEvent.setTimestampInSeconds(synchronizer.convertSampleNumberToTimestamp(event.getStreamId(), sampleNumber));
+
+		eventQueue->addEvent(stampedEvent, sampleNumber);
 
 		eventMonitor->bufferedEvents++;
 
@@ -785,16 +971,16 @@ void RecordNode::handleEvent(const EventChannel* eventInfo, const EventPacket& p
 }
 
 // only called if recordSpikes is true
-void RecordNode::handleSpike(SpikePtr spike)
+void RecordNode::handleSpikeView(SpikeView& spike)
 {
 
 	eventMonitor->receivedSpikes++;
 
 	if (recordSpikes)
 	{
-        spike->setTimestampInSeconds(synchronizer.convertSampleNumberToTimestamp(spike->getStreamId(),
-                                                                    spike->getSampleNumber()));
-		writeSpike(spike, spike->getChannelInfo());
+        spike.setTimestampInSeconds(synchronizer.convertSampleNumberToTimestamp(spike.getStreamId(),
+                                                                    spike.getSampleNumber()));
+		writeSpike(spike, spike.getChannelInfo());
 		eventMonitor->bufferedSpikes++;
 	}
 
@@ -856,6 +1042,9 @@ void RecordNode::process(AudioBuffer<float>& buffer)
 
 		bool fifoAlmostFull = false;
 
+		/* With an overflow file the record thread empties the queue well before this point */
+		const float fifoLimit = overflowActive ? 0.98f : 0.9f;
+
 		int streamIndex = -1;
 		int channelIndex = -1;
 
@@ -866,9 +1055,11 @@ void RecordNode::process(AudioBuffer<float>& buffer)
 
 			const uint16 streamId = stream->getStreamId();
 
-            uint32 numSamples = getNumSamplesInBlock(streamId);
+			const BlockInfo& block = getBlockInfo(streamId);
 
-			int64 sampleNumber = getFirstSampleNumberForBlock(streamId);
+			uint32 numSamples = block.numSamples;
+
+			int64 sampleNumber = block.firstSampleNumber;
 
 			if (numSamples > 0)
 			{
@@ -904,7 +1095,10 @@ void RecordNode::process(AudioBuffer<float>& buffer)
 				}
 			}
 
-			if (fifoUsage[streamId] > 0.9)
+			if (triggerActive && numSamples > 0)
+				recordTrigger->setLatestSampleNumber(streamIndex, sampleNumber + numSamples);
+
+			if (fifoUsage[streamId] > fifoLimit)
 				fifoAlmostFull = true;
 
 			samplesWritten += numSamples;
@@ -923,25 +1117,40 @@ void RecordNode::process(AudioBuffer<float>& buffer)
 
 			CoreServices::setRecordingStatus(false);
 		}
+		else if (recordThread->getAndClearWriteError())
+		{
+
+			AlertWindow::showMessageBoxAsync(AlertWindow::AlertIconType::WarningIcon,
+				"Record Write Error",
+				"Data could not be written to disk. Stopping recording to prevent data loss. \n\n"
+				"Check that the recording drive is connected and has free space.",
+				"OK");
+
+			CoreServices::setRecordingStatus(false);
+		}
 
 		if (!setFirstBlock)
 		{
 			recordThread->setFirstBlockFlag(true);
 			setFirstBlock = true;
 		}
+		else
+		{
+			recordThread->notifyDataAvailable();
+		}
 
 	}
 
 }
 
 // called in RecordNode::handleSpike
-void RecordNode::writeSpike(const Spike *spike, const SpikeChannel *spikeElectrode)
+void RecordNode::writeSpike(const SpikeView& spike, const SpikeChannel *spikeElectrode)
 {
 
     int electrodeIndex = getIndexOfMatchingChannel(spikeElectrode);
 
     if (electrodeIndex >= 0)
-        spikeQueue->addEvent(*spike, spike->getSampleNumber(), electrodeIndex);
+        spikeQueue->addEvent(spike, spike.getSampleNumber(), electrodeIndex);
 
 }
 
@@ -1004,6 +1213,12 @@ void RecordNode::saveCustomParametersToXml(XmlElement* xml)
     xml->setAttribute("engine", recordEngine->getEngineId());
     xml->setAttribute ("recordEvents", recordEvents);
     xml->setAttribute ("recordSpikes", recordSpikes);
+    xml->setAttribute ("parallelWrites", parallelWrites);
+    xml->setAttribute ("triggeredRecording", triggeredRecording);
+    xml->setAttribute ("preTriggerSeconds", preTriggerSeconds);
+    xml->setAttribute ("postTriggerSeconds", postTriggerSeconds);
+    xml->setAttribute ("triggerLine", triggerLine);
+    xml->setAttribute ("overflowDirectory", overflowDirectory.isEmpty() ? String("none") : overflowDirectory);
     xml->setAttribute("fifoMonitorsVisible", recordNodeEditor->fifoDrawerButton->getToggleState());
 
     //Save channel states:
@@ -1073,6 +1288,13 @@ void RecordNode::loadCustomParametersFromXml(XmlElement* xml)
 
     recordEvents = xml->getBoolAttribute("recordEvents", true);
     recordSpikes = xml->getBoolAttribute("recordSpikes", true);
+    parallelWrites = xml->getBoolAttribute("parallelWrites", true);
+
+    setTriggeredRecording(xml->getBoolAttribute("triggeredRecording", false),
+                          xml->getDoubleAttribute("preTriggerSeconds", 2.0),
+                          xml->getDoubleAttribute("postTriggerSeconds", 2.0));
+    setTriggerLine(xml->getIntAttribute("triggerLine", 1));
+    setOverflowDirectory(xml->getStringAttribute("overflowDirectory", "none"));
 
 
     Array<int> matchingIndexes;
@@ -154,6 +154,21 @@ public:
 	/** Turns spike recording on or off*/
 	void setRecordSpikes(bool);
 
+	/** Turns parallel (one writer per stream) continuous data writing on or off*/
+	void setParallelWrites(bool);
+
+	/** Turns the pre-trigger recording mode on or off, and sets the length of the windows recorded around each trigger*/
+	void setTriggeredRecording(bool enabled, float preTriggerSeconds, float postTriggerSeconds);
+
+	/** Sets the TTL line (1-based, or 0 for none) whose rising edges trigger a window in pre-trigger mode*/
+	void setTriggerLine(int line);
+
+	/** Sets the scratch directory that absorbs data when the disk falls behind, or "none" to stop recording instead*/
+	void setOverflowDirectory(const String& path);
+
+	/** Returns true if data can be diverted to the overflow directory in the current recording*/
+	bool isOverflowEnabled() const;
+
 	/** Sets the parent directory for this Record Node (can be different from default directory) */
 	void setDataDirectory(File);
 
@@ -170,7 +185,7 @@ public:
 	const String &getLastSettingsXml() const;
 
   /** Called by handleEvent() */
-  void writeSpike(const Spike *spike, const SpikeChannel *spikeElectrode);
+  void writeSpike(const SpikeView& spike, const SpikeChannel *spikeElectrode);
 
   /** Called by the ControlPanel to determine the amount of space
       left in the current dataDirectory.
@@ -197,6 +212,16 @@ public:
   /** Variables to track whether or not particular channels are recorded*/
 	bool recordEvents;
 	bool recordSpikes;
+	bool parallelWrites;
+
+	/** Pre-trigger recording mode settings*/
+	bool triggeredRecording;
+	float preTriggerSeconds;
+	float postTriggerSeconds;
+	int triggerLine;
+
+	/** Scratch directory for the overflow file (empty if disabled)*/
+	String overflowDirectory;
 	std::map<uint16, std::vector<bool>> recordContinuousChannels;
 
 	bool newDirectoryNeeded;
@@ -240,10 +265,10 @@ private:
 	void handleEvent(const EventChannel* channel, const EventPacket& eventPacket);
 
 	/** Forwards TTL events to the EventQueue */
-	void handleTTLEvent(TTLEventPtr event) override;
+	void handleTTLEventView(const TTLEventView& event) override;
 
 	/** Writes incoming spikes to disk */
-	void handleSpike(SpikePtr spike) override;
+	void handleSpikeView(SpikeView& spike) override;
 
 	/** Handles incoming timestamp sync messages */
 	virtual void handleTimestampSyncTexts(const EventPacket& packet);
@@ -267,6 +292,16 @@ private:
 	std::unique_ptr<EventMsgQueue> eventQueue;
     std::unique_ptr<SpikeMsgQueue> spikeQueue;
 
+	/** Adds a pre-trigger window at a sample number of one stream, mapped onto every other stream*/
+	void addTrigger(uint16 streamId, int64 sampleNumber);
+
+	std::unique_ptr<RecordTrigger> recordTrigger;
+	Array<int64> triggerSampleNumbers;
+	bool triggerActive;
+
+	/** True if the current recording can divert data to the overflow directory*/
+	bool overflowActive;
+
     int spikeElectrodeIndex;
 
     Array<bool> validBlocks;
@@ -559,7 +559,7 @@ void FifoMonitor::timerCallback()
 			setFillPercentage(1.0f - ratio);
 
 		if (!recordingTimeLeftInSeconds)
-			setTooltip(String(bytesFree / pow(2, 30)) + " GB available");
+			diskSpaceMessage = String(bytesFree / pow(2, 30)) + " GB available";
 
 		float currentTime = Time::getMillisecondCounterHiRes();
 
@@ -591,9 +591,25 @@ void FifoMonitor::timerCallback()
 				String msg = String(bytesFree / pow(2, 30)) + " GB available\n";
 				msg += String(int(recordingTimeLeftInSeconds / 60.0f)) + " minutes remaining\n";
 				msg += "Data rate: " + String(dataRate * 1000 / pow(2, 20), 2) + " MB/s";
-				setTooltip(msg);
+				diskSpaceMessage = msg;
 			}
 		}
+
+		String msg = diskSpaceMessage;
+
+		/* Data diverted to the overflow file means the disk can't keep up */
+		int64 overflowPeakBytes = recordNode->recordThread->getOverflowPeakBytes();
+
+		if (overflowPeakBytes > 0)
+		{
+			msg += "\nOverflow file: " + String(recordNode->recordThread->getOverflowPendingBytes() / pow(2, 20), 1) + " MB pending";
+			msg += " (peak " + String(overflowPeakBytes / pow(2, 20), 1) + " MB)";
+		}
+
+		if (recordNode->getRecordingStatus())
+			msg += "\nHighest data queue usage: " + String(int(recordNode->recordThread->getDataQueueHighWaterMark() * 100)) + "%";
+
+		setTooltip(msg);
 	}
 	else /* Stream monitor */
 	{
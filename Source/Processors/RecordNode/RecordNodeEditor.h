@@ -102,6 +102,7 @@ private :
 	float lastFreeSpace;
 	float lastUpdateTime;
 	float recordingTimeLeftInSeconds;
+	String diskSpaceMessage;
 	
 };
 
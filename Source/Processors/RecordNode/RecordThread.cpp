@@ -23,14 +23,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "RecordThread.h"
 #include "RecordNode.h"
+#include "../../Utils/TraceRecorder.h"
+
+#include "taskflow/taskflow.hpp"
 
 //#define EVERY_ENGINE for(int eng = 0; eng < m_engineArray.size(); eng++) m_engineArray[eng]
 #define EVERY_ENGINE m_engine;
 
 RecordThread::RecordThread(RecordNode* parentNode, RecordEngine* engine) :
 	Thread("Record Thread"),
-	m_engine(engine),
 	recordNode(parentNode),
+	m_engine(engine),
+	m_dataQueue(nullptr),
+	m_eventQueue(nullptr),
+	m_spikeQueue(nullptr),
+	m_trigger(nullptr),
+	m_overflowBytes(0),
+	m_overflowPendingBytes(0),
+	m_overflowPeakBytes(0),
+	m_writeError(false),
+	m_writeErrorReported(false),
+	m_droppedEvents(0),
+	m_droppedSpikes(0),
+	m_parallelWrites(true),
 	m_receivedFirstBlock(false),
 	m_cleanExit(true)
 	//samplesWritten(0)
@@ -46,6 +61,43 @@ void RecordThread::setEngine(RecordEngine* engine)
     m_engine = engine;
 }
 
+void RecordThread::setOverflowDirectory(const File& directory)
+{
+	m_overflowDirectory = directory;
+}
+
+int64 RecordThread::getOverflowPendingBytes() const
+{
+	return m_overflowPendingBytes.load(std::memory_order_relaxed);
+}
+
+int64 RecordThread::getOverflowPeakBytes() const
+{
+	return m_overflowPeakBytes.load(std::memory_order_relaxed);
+}
+
+bool RecordThread::getAndClearWriteError()
+{
+	return m_writeError.exchange(false);
+}
+
+float RecordThread::getDataQueueHighWaterMark() const
+{
+	return m_dataQueue != nullptr ? m_dataQueue->getHighWaterMark() : 0.0f;
+}
+
+void RecordThread::setRecordTrigger(RecordTrigger* trigger)
+{
+	m_trigger = trigger;
+}
+
+void RecordThread::setParallelWrites(bool state)
+{
+	if (isThreadRunning())
+		return;
+	m_parallelWrites = state;
+}
+
 
 void RecordThread::setFileComponents(File rootFolder, int experimentNumber, int recordingNumber)
 {
@@ -87,16 +139,35 @@ void RecordThread::setQueuePointers(DataQueue* data, EventMsgQueue* events, Spik
 void RecordThread::setFirstBlockFlag(bool state)
 {
 	m_receivedFirstBlock = state;
-	this->notify();
+	m_dataNotifier.notify();
+}
+
+void RecordThread::notifyDataAvailable()
+{
+	m_dataNotifier.notify();
+}
+
+bool RecordThread::hasDataToWrite() const
+{
+	return m_dataQueue->getUsage() > 0.0f
+		|| m_eventQueue->getRemainingEvents() > 0
+		|| m_spikeQueue->getRemainingEvents() > 0
+		|| (m_overflow != nullptr && m_overflow->hasData());
 }
 
 void RecordThread::run()
 {
 	const AudioBuffer<float>& dataBuffer = m_dataQueue->getContinuousDataBufferReference();
-	const SynchronizedTimestampBuffer& ftsBuffer = m_dataQueue->getTimestampBufferReference();
 
 	spikesReceived = 0;
 	spikesWritten = 0;
+	m_dataQueue->resetHighWaterMark();
+	m_overflowPendingBytes = 0;
+	m_overflowPeakBytes = 0;
+	m_writeError = false;
+	m_writeErrorReported = false;
+	m_droppedEvents = m_eventQueue->getNumDroppedEvents();
+	m_droppedSpikes = m_spikeQueue->getNumDroppedEvents();
 
 	bool closeEarly = true;
 
@@ -108,22 +179,30 @@ void RecordThread::run()
 	m_engine->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
 
 	//2-Wait until the first block has arrived, so we can align the timestamps
-	bool isWaiting = false;
 	while (!m_receivedFirstBlock && !threadShouldExit())
-	{
-		if (!isWaiting)
-		{
-			isWaiting = true;
-		}
-		wait(1);
-	}
+		m_dataNotifier.waitUntil([this] { return m_receivedFirstBlock.load(); }, MAX_IDLE_WAIT_MS);
 
 	m_dataQueue->getSampleNumbersForBlock(0, sampleNumbers);
 	m_engine->updateLatestSampleNumbers(sampleNumbers);
 
+	createWriteTasks(dataBuffer);
+
 	//3-Normal loop
 	while (!threadShouldExit())
-		writeData(dataBuffer, ftsBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES);
+	{
+		writeData(dataBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES);
+
+		/* The Record Node stops the recording; the error is only passed on once */
+		if (!m_writeErrorReported && m_engine->hasWriteError())
+		{
+			LOGE("RecordThread: the record engine failed to write to disk");
+			m_writeErrorReported = true;
+			m_writeError = true;
+		}
+
+		/* Sleep until the Record Node has queued more data */
+		m_dataNotifier.waitUntil([this] { return hasDataToWrite(); }, MAX_IDLE_WAIT_MS);
+	}
 
 
 	//LOGD(__FUNCTION__, " Exiting record thread");
@@ -134,11 +213,26 @@ void RecordThread::run()
 	if (!closeEarly)
 	{
 		// flush the buffers
-		writeData(dataBuffer, ftsBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES, true);
+		writeData(dataBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES, true);
 
 		//5-Close files
 		m_engine->closeFiles();
 	}
+
+	m_writeTasks.reset();
+	m_executor.reset();
+
+	m_pendingEvents.clear();
+	m_pendingSpikes.clear();
+
+	m_overflow.reset();
+	m_overflowPendingBytes = 0;
+
+	LOGC("RecordThread: data queue high-water mark ", int(m_dataQueue->getHighWaterMark() * 100), "%");
+
+	if (m_overflowPeakBytes > 0)
+		LOGC("RecordThread: overflow file high-water mark ", m_overflowPeakBytes / (1024 * 1024), " MB");
+
 	m_cleanExit = true;
 	m_receivedFirstBlock = false;
 
@@ -147,126 +241,569 @@ void RecordThread::run()
 }
 
 void RecordThread::writeData(const AudioBuffer<float>& dataBuffer,
-										 const SynchronizedTimestampBuffer& timestampBuffer,
 										 int maxSamples,
 										 int maxEvents,
 									     int maxSpikes,
 									     bool lastBlock)
 {
+	TraceSpan span("RecordThread::writeData");
 
-	Array<int64> sampleNumbers;
-	Array<CircularBufferIndexes> dataBufferIdxs;
-	Array<CircularBufferIndexes> timestampBufferIdxs;
-	m_dataQueue->startRead(dataBufferIdxs, timestampBufferIdxs, sampleNumbers, maxSamples);
-	m_engine->updateLatestSampleNumbers(sampleNumbers);
+	if (m_trigger == nullptr && shouldUseOverflow() && spillToOverflow(dataBuffer))
+	{
+		/* The engine is behind: the queue has been emptied into the overflow file, which is written back in order */
+		writeOverflowData(lastBlock);
+	}
+	else
+	{
+		if (m_trigger != nullptr)
+		{
+			/* The queue keeps the pre-trigger history, so read everything and let the trigger windows decide */
+			m_trigger->updateLatestSampleNumbers();
+			m_dataQueue->startRead(m_dataBufferIdxs, m_sampleNumbers, 0);
+			m_trigger->updateWindows();
+			selectTriggeredSamples(maxSamples);
+		}
+		else
+		{
+			m_dataQueue->startRead(m_dataBufferIdxs, m_sampleNumbers, maxSamples);
+		}
 
-	/* Copy data to record engine */
-	for (int chan = 0; chan < m_numChannels; ++chan)
+		m_engine->updateLatestSampleNumbers(m_sampleNumbers);
+
+		/* Copy data to record engine */
+		if (m_writeTasks != nullptr)
+		{
+			/* Each stream is written by its own worker; wait for all of them before touching the queue */
+			m_executor->run(*m_writeTasks).wait();
+		}
+		else
+		{
+			for (int stream = 0; stream < m_streamChannelRanges.size(); ++stream)
+				writeContinuousStream(stream, dataBuffer);
+		}
+
+		m_dataQueue->stopRead();
+	}
+
+	if (m_trigger != nullptr)
+		writePendingEvents(lastBlock);
+
+	int nEvents = m_eventQueue->getEvents(m_events, maxEvents);
+
+	for (int ev = 0; ev < nEvents; ++ev)
+	{
+
+		const EventPacket event(m_events[ev].getRawData(), int(m_events[ev].getRawDataSize()));
+
+		if (m_trigger != nullptr && SystemEvent::getBaseType(event) != EventBase::Type::SYSTEM_EVENT)
+		{
+			int stream = m_trigger->getStreamIndex(EventBase::getStreamId(event));
+			RecordTrigger::EventAction action = m_trigger->getEventAction(stream, m_events[ev].getTimestamp());
+
+			if (action == RecordTrigger::DEFER_EVENT && !lastBlock)
+				m_pendingEvents.add(new PendingEvent(m_events[ev], stream));
+
+			if (action != RecordTrigger::WRITE_EVENT)
+				continue;
+		}
+
+		writeEvent(event);
+	}
+
+	m_eventQueue->releaseEvents();
+
+	int nSpikes = m_spikeQueue->getEvents(m_spikes, BLOCK_MAX_WRITE_SPIKES);
+
+	for (int sp = 0; sp < nSpikes; ++sp)
+	{
+
+		spikesReceived++;
+
+		int spikeIndex = m_spikes[sp].getExtra();
+		const SpikeChannel* chan = recordNode->getSpikeChannel(spikeIndex);
+
+		if (chan == nullptr)
+			continue;
+
+		if (m_trigger != nullptr)
+		{
+			int stream = m_trigger->getStreamIndex(chan->getStreamId());
+			RecordTrigger::EventAction action = m_trigger->getEventAction(stream, m_spikes[sp].getTimestamp());
+
+			if (action == RecordTrigger::DEFER_EVENT && !lastBlock)
+				m_pendingSpikes.add(new PendingEvent(m_spikes[sp], stream));
+
+			if (action != RecordTrigger::WRITE_EVENT)
+				continue;
+		}
+
+		writeSpike(spikeIndex, chan, m_spikes[sp].getRawData());
+	}
+
+	m_spikeQueue->releaseEvents();
+
+	reportDroppedEvents();
+}
+
+void RecordThread::writeEvent(const EventPacket& event)
+{
+	if (SystemEvent::getBaseType(event) == EventBase::Type::SYSTEM_EVENT)
+	{
+		m_engine->writeTimestampSyncText(SystemEvent::getStreamId(event), SystemEvent::getSampleNumber(event), 0.0f, SystemEvent::getSyncText(event));
+	}
+	else
 	{
+		int processorId = EventBase::getProcessorId(event);
+		int streamId = EventBase::getStreamId(event);
+		int channelIdx = EventBase::getChannelIndex(event);
+
+		const EventChannel* chan = recordNode->getEventChannel(processorId, streamId, channelIdx);
+		int eventIndex = recordNode->getIndexOfMatchingChannel(chan);
+
+		m_engine->writeEvent(eventIndex, event);
+	}
+}
 
-		if (dataBufferIdxs[chan].size1 > 0)
+void RecordThread::writeSpike(int spikeIndex, const SpikeChannel* chan, const uint8* data)
+{
+	SpikePtr spike = Spike::deserialize(data, chan);
+
+	if (spike != nullptr)
+	{
+		spikesWritten++;
+
+		m_engine->writeSpike(spikeIndex, spike);
+	}
+}
+
+void RecordThread::selectTriggeredSamples(int maxSamples)
+{
+	for (auto range : m_streamChannelRanges)
+	{
+		int stream = m_timestampBufferChannelArray[range.getStart()];
+
+		for (int chan = range.getStart(); chan < range.getEnd(); ++chan)
 		{
-			const double* r = timestampBuffer.getReadPointer(m_timestampBufferChannelArray[chan],
-				dataBufferIdxs[chan].index1);
+			const CircularBufferIndexes idx = m_dataBufferIdxs[chan];
+			int numSamples = idx.size1 + idx.size2;
+			int skip, write;
+
+			int consumed = m_trigger->selectSamples(stream, m_sampleNumbers[chan], numSamples, maxSamples, skip, write);
+
+			/* Narrow the read window down to the samples to be written */
+			CircularBufferIndexes selected;
+			int start1 = jmin(skip, idx.size1);
+			int start2 = skip - start1;
 
-			m_engine->writeContinuousData(
-				chan,					 // write channel (index among all recorded channels)
-				m_channelArray[chan],	 // real channel (index within processor)
-				dataBuffer.getReadPointer(chan, dataBufferIdxs[chan].index1), // pointer to float
-				r, // pointer to float
-				dataBufferIdxs[chan].size1); // integer
+			selected.index1 = idx.index1 + start1;
+			selected.size1 = jmin(write, idx.size1 - start1);
+			selected.index2 = idx.index2 + start2;
+			selected.size2 = write - selected.size1;
 
-			/*if (chan == 0)
+			if (selected.size1 == 0)
 			{
+				selected.index1 = selected.index2;
+				selected.size1 = selected.size2;
+				selected.size2 = 0;
+			}
+
+			m_dataBufferIdxs.set(chan, selected);
+			m_sampleNumbers.set(chan, m_sampleNumbers[chan] + skip);
+			m_readOffsets.set(chan, skip);
+
+			m_dataQueue->keepSamples(chan, numSamples - consumed);
+		}
+	}
+}
+
+void RecordThread::writePendingEvents(bool lastBlock)
+{
+	for (int i = 0; i < m_pendingEvents.size(); ++i)
+	{
+		PendingEvent* pending = m_pendingEvents[i];
+		RecordTrigger::EventAction action = m_trigger->getEventAction(pending->stream, pending->sampleNumber);
+
+		if (action == RecordTrigger::DEFER_EVENT && !lastBlock)
+			continue;
+
+		if (action == RecordTrigger::WRITE_EVENT)
+			writeEvent(EventPacket(pending->data.getData(), int(pending->data.getSize())));
+
+		m_pendingEvents.remove(i--);
+	}
 
-				std::cout << chan << " " << m_channelArray[chan] <<
-					" " << dataBufferIdxs[chan].index1 <<
-					" " << dataBufferIdxs[chan].size1 <<
-					" " << dataBufferIdxs[chan].index2 <<
-					" " << dataBufferIdxs[chan].size2
-					<< " "
-					<< *r << std::endl;
+	for (int i = 0; i < m_pendingSpikes.size(); ++i)
+	{
+		PendingEvent* pending = m_pendingSpikes[i];
+		RecordTrigger::EventAction action = m_trigger->getEventAction(pending->stream, pending->sampleNumber);
 
-				std::cout << chan << " " << m_timestampBufferChannelArray[chan] <<
-					" " << timestampBufferIdxs[m_timestampBufferChannelArray[chan]].index1 <<
-					" " << timestampBufferIdxs[m_timestampBufferChannelArray[chan]].size1 <<
-					" " << timestampBufferIdxs[m_timestampBufferChannelArray[chan]].index2 <<
-					" " << timestampBufferIdxs[m_timestampBufferChannelArray[chan]].size2
-					<< " "
-					<< *r << std::endl;
-			}*/
+		if (action == RecordTrigger::DEFER_EVENT && !lastBlock)
+			continue;
 
+		if (action == RecordTrigger::WRITE_EVENT)
+		{
+			const SpikeChannel* chan = recordNode->getSpikeChannel(pending->extra);
+
+			if (chan != nullptr)
+				writeSpike(pending->extra, chan, static_cast<const uint8*>(pending->data.getData()));
+		}
 
-			//samplesWritten += dataBufferIdxs[chan].size1;
+		m_pendingSpikes.remove(i--);
+	}
+}
+
+bool RecordThread::shouldUseOverflow() const
+{
+	/* Spilled data always goes back first, even after spilling has been turned off */
+	if (m_overflow != nullptr && m_overflow->hasData())
+		return true;
 
-			if (dataBufferIdxs[chan].size2 > 0)
+	if (m_overflowDirectory == File())
+		return false;
+
+	return m_dataQueue->getUsage() > OVERFLOW_THRESHOLD;
+}
+
+bool RecordThread::spillToOverflow(const AudioBuffer<float>& dataBuffer)
+{
+	/* Spilling was turned off after a write error; leave new data in the queue until the file is drained */
+	if (m_overflowDirectory == File())
+		return m_overflow != nullptr && m_overflow->hasData();
+
+	if (m_overflow == nullptr)
+	{
+		m_overflow = std::make_unique<OverflowFile>(m_overflowDirectory);
+
+		if (!m_overflow->isOpen())
+		{
+			LOGE("RecordThread: unable to create an overflow file in ", m_overflowDirectory.getFullPathName());
+			m_overflow.reset();
+			m_overflowDirectory = File();
+			return false;
+		}
+	}
+
+	if (!m_overflow->hasData())
+	{
+		LOGC("RecordThread: data queue ", int(m_dataQueue->getUsage() * 100), "% full, writing to overflow file ", m_overflow->getPath());
+		m_overflowBytes = 0;
+	}
+
+	int64 pendingBytes = m_overflow->getPendingBytes();
+
+	m_dataQueue->startRead(m_dataBufferIdxs, m_sampleNumbers, 0);
+
+	bool ok = true;
+
+	for (int stream = 0; stream < m_streamChannelRanges.size(); ++stream)
+	{
+		const Range<int> channels = m_streamChannelRanges[stream];
+		const int first = channels.getStart();
+		const CircularBufferIndexes& idx = m_dataBufferIdxs.getReference(first);
+
+		if (!ok)
+		{
+			/* Nothing more goes to the file; these samples are read again from the queue */
+			for (int chan = first; chan < channels.getEnd(); ++chan)
 			{
-				sampleNumbers.set(chan, sampleNumbers[chan] + dataBufferIdxs[chan].size1);
+				const CircularBufferIndexes& chanIdx = m_dataBufferIdxs.getReference(chan);
+				m_dataQueue->keepSamples(chan, chanIdx.size1 + chanIdx.size2);
+			}
+
+			continue;
+		}
+
+		bool lockstep = true;
 
-				m_engine->updateLatestSampleNumbers(sampleNumbers, chan);
+		for (int chan = first + 1; chan < channels.getEnd(); ++chan)
+		{
+			const CircularBufferIndexes& other = m_dataBufferIdxs.getReference(chan);
 
-				m_engine->writeContinuousData(
-					chan, 					// write channel (index among all recorded channels)
-					m_channelArray[chan],	// real channel (index within processor)
-					dataBuffer.getReadPointer(chan, dataBufferIdxs[chan].index2), // pointer to float
-					timestampBuffer.getReadPointer(m_timestampBufferChannelArray[chan],
-						dataBufferIdxs[chan].index2), // pointer to float
-					dataBufferIdxs[chan].size2); // integer
+			if (other.index1 != idx.index1 || other.size1 != idx.size1 || other.index2 != idx.index2 || other.size2 != idx.size2)
+				lockstep = false;
+		}
 
-				//samplesWritten += dataBufferIdxs[chan].size2;
+		if (lockstep)
+		{
+			ok = spillChannels(stream, first, channels.getLength(), dataBuffer);
+		}
+		else
+		{
+			for (int chan = first; chan < channels.getEnd(); ++chan)
+			{
+				if (ok)
+				{
+					ok = spillChannels(stream, chan, 1, dataBuffer);
+				}
+				else
+				{
+					const CircularBufferIndexes& chanIdx = m_dataBufferIdxs.getReference(chan);
+					m_dataQueue->keepSamples(chan, chanIdx.size1 + chanIdx.size2);
+				}
 			}
 		}
 	}
 
 	m_dataQueue->stopRead();
 
-	std::vector<EventMessagePtr> events;
-	int nEvents = m_eventQueue->getEvents(events, maxEvents);
+	m_overflowBytes += m_overflow->getPendingBytes() - pendingBytes;
 
-	for (int ev = 0; ev < nEvents; ++ev)
+	updateOverflowUsage();
+
+	if (!ok)
 	{
+		LOGE("RecordThread: unable to write to the overflow file ", m_overflow->getPath(),
+			", writing directly to the record engine once the ", m_overflowBytes / (1024 * 1024), " MB already spilled are written");
+		m_overflowDirectory = File();
 
-		const MidiMessage& event = events[ev]->getData();
+		return m_overflow->hasData();
+	}
+
+	return true;
+}
+
+bool RecordThread::spillChannels(int stream, int firstChannel, int numChannels, const AudioBuffer<float>& dataBuffer)
+{
+	const CircularBufferIndexes& idx = m_dataBufferIdxs.getReference(firstChannel);
+	double* timestamps = m_timestamps.getWritePointer(stream);
+
+	const int starts[2] = { idx.index1, idx.index2 };
+	const int sizes[2] = { idx.size1, idx.size2 };
+	int offset = 0;
 
-		if (SystemEvent::getBaseType(event) == EventBase::Type::SYSTEM_EVENT)
+	for (int part = 0; part < 2; part++)
+	{
+		for (int pos = 0; pos < sizes[part]; pos += BLOCK_MAX_WRITE_SAMPLES)
 		{
-			String syncText = SystemEvent::getSyncText(event);
-			m_engine->writeTimestampSyncText(SystemEvent::getStreamId(event), SystemEvent::getSampleNumber(event), 0.0f, SystemEvent::getSyncText(event));
+			int numSamples = jmin(BLOCK_MAX_WRITE_SAMPLES, sizes[part] - pos);
+
+			m_dataQueue->getTimestamps(firstChannel, offset, numSamples, timestamps);
+
+			for (int chan = firstChannel; chan < firstChannel + numChannels; ++chan)
+			{
+				m_channelPointers.set(chan, dataBuffer.getReadPointer(chan, starts[part] + pos));
+				m_overflowSampleNumbers.set(chan, m_sampleNumbers[chan] + offset);
+			}
+
+			if (!m_overflow->writeRecord(firstChannel,
+				numChannels,
+				numSamples,
+				m_overflowSampleNumbers.getRawDataPointer() + firstChannel,
+				timestamps,
+				m_channelPointers.getRawDataPointer() + firstChannel))
+			{
+				/* Leave the samples that didn't reach the file in the queue */
+				for (int chan = firstChannel; chan < firstChannel + numChannels; ++chan)
+					m_dataQueue->keepSamples(chan, idx.size1 + idx.size2 - offset);
+
+				return false;
+			}
+
+			offset += numSamples;
 		}
-		else
-		{
-			int processorId = EventBase::getProcessorId(event);
-			int streamId = EventBase::getStreamId(event);
-			int channelIdx = EventBase::getChannelIndex(event);
+	}
+
+	return true;
+}
+
+void RecordThread::writeOverflowData(bool lastBlock)
+{
+	/* Write one record per stream at a time, so the queue is checked again soon; drain everything when closing */
+	int numRecords = lastBlock ? std::numeric_limits<int>::max() : jmax(1, m_streamChannelRanges.size());
+
+	int firstChannel, numChannels, numSamples;
 
-			const EventChannel* chan = recordNode->getEventChannel(processorId, streamId, channelIdx);
-			int eventIndex = recordNode->getIndexOfMatchingChannel(chan);
+	for (int i = 0; i < numRecords && m_overflow->hasData(); i++)
+	{
+		if (!m_overflow->readRecord(firstChannel, numChannels, numSamples,
+			m_overflowRecordSampleNumbers, m_overflowTimestamps, m_overflowData))
+		{
+			LOGE("RecordThread: unable to read back the overflow file ", m_overflow->getPath());
+			m_overflow.reset();
+			return;
+		}
 
-			m_engine->writeEvent(eventIndex, event);
+		for (int chan = 0; chan < numChannels; ++chan)
+		{
+			m_sampleNumbers.set(firstChannel + chan, m_overflowRecordSampleNumbers[chan]);
+			m_engine->updateLatestSampleNumbers(m_sampleNumbers, firstChannel + chan);
+			m_channelPointers.set(firstChannel + chan, m_overflowData.getReadPointer(chan));
 		}
+
+		m_engine->writeContinuousStreamData(firstChannel,
+			numChannels,
+			m_channelPointers.getRawDataPointer() + firstChannel,
+			m_overflowTimestamps.getData(),
+			numSamples);
 	}
 
-	std::vector<SpikeMessagePtr> spikes;
-	int nSpikes = m_spikeQueue->getEvents(spikes, BLOCK_MAX_WRITE_SPIKES);
+	updateOverflowUsage();
 
-	for (int sp = 0; sp < nSpikes; ++sp)
+	if (!m_overflow->hasData())
+		LOGC("RecordThread: caught up with the overflow file after ", m_overflowBytes / (1024 * 1024), " MB");
+}
+
+void RecordThread::updateOverflowUsage()
+{
+	int64 pendingBytes = m_overflow != nullptr ? m_overflow->getPendingBytes() : 0;
+
+	m_overflowPendingBytes.store(pendingBytes, std::memory_order_relaxed);
+
+	if (pendingBytes > m_overflowPeakBytes.load(std::memory_order_relaxed))
+		m_overflowPeakBytes.store(pendingBytes, std::memory_order_relaxed);
+}
+
+void RecordThread::reportDroppedEvents()
+{
+	int64 droppedEvents = m_eventQueue->getNumDroppedEvents();
+	int64 droppedSpikes = m_spikeQueue->getNumDroppedEvents();
+
+	if (droppedEvents != m_droppedEvents)
 	{
+		LOGE("RecordThread: event buffer overrun, ", droppedEvents - m_droppedEvents, " events were not recorded (", droppedEvents, " total)");
+		m_droppedEvents = droppedEvents;
+	}
 
-		spikesReceived++;
+	if (droppedSpikes != m_droppedSpikes)
+	{
+		LOGE("RecordThread: spike buffer overrun, ", droppedSpikes - m_droppedSpikes, " spikes were not recorded (", droppedSpikes, " total)");
+		m_droppedSpikes = droppedSpikes;
+	}
+}
+
+
+void RecordThread::writeContinuousChannel(int chan,
+	const AudioBuffer<float>& dataBuffer,
+	double* timestamps)
+{
+	const CircularBufferIndexes& idx = m_dataBufferIdxs.getReference(chan);
+
+	if (idx.size1 == 0)
+		return;
+
+	m_dataQueue->getTimestamps(chan, m_readOffsets[chan], idx.size1 + idx.size2, timestamps);
+
+	m_engine->writeContinuousData(
+		chan,					 // write channel (index among all recorded channels)
+		m_channelArray[chan],	 // real channel (index within processor)
+		dataBuffer.getReadPointer(chan, idx.index1), // pointer to float
+		timestamps, // pointer to double
+		idx.size1); // integer
+
+	if (idx.size2 > 0)
+	{
+		m_sampleNumbers.set(chan, m_sampleNumbers[chan] + idx.size1);
+
+		m_engine->updateLatestSampleNumbers(m_sampleNumbers, chan);
+
+		m_engine->writeContinuousData(
+			chan, 					// write channel (index among all recorded channels)
+			m_channelArray[chan],	// real channel (index within processor)
+			dataBuffer.getReadPointer(chan, idx.index2), // pointer to float
+			timestamps + idx.size1, // pointer to double
+			idx.size2); // integer
+	}
+}
 
-		if (spikes[sp] != nullptr)
+void RecordThread::writeContinuousStream(int stream,
+	const AudioBuffer<float>& dataBuffer)
+{
+	const Range<int> channels = m_streamChannelRanges[stream];
+	const int first = channels.getStart();
+	double* timestamps = m_timestamps.getWritePointer(stream);
+	const CircularBufferIndexes& idx = m_dataBufferIdxs.getReference(first);
+
+	/* Channel FIFOs are written in lockstep, so their read windows normally match */
+	for (int chan = first + 1; chan < channels.getEnd(); ++chan)
+	{
+		const CircularBufferIndexes& other = m_dataBufferIdxs.getReference(chan);
+
+		if (other.index1 != idx.index1 || other.size1 != idx.size1 || other.index2 != idx.index2 || other.size2 != idx.size2)
 		{
+			for (chan = first; chan < channels.getEnd(); ++chan)
+				writeContinuousChannel(chan, dataBuffer, timestamps);
+			return;
+		}
+	}
+
+	if (idx.size1 == 0)
+		return;
+
+	/* All channels of the stream share the same timestamps, computed from the queue's block metadata */
+	m_dataQueue->getTimestamps(first, m_readOffsets[first], idx.size1 + idx.size2, timestamps);
 
-			const Spike& spike = spikes[sp]->getData();
-			const SpikeChannel* chan = spike.getChannelInfo();
-			int spikeIndex = recordNode->getIndexOfMatchingChannel(chan);
-			spikesWritten++;
+	for (int chan = first; chan < channels.getEnd(); ++chan)
+		m_channelPointers.set(chan, dataBuffer.getReadPointer(chan, idx.index1));
 
-			m_engine->writeSpike(spikeIndex, &spikes[sp]->getData());
+	m_engine->writeContinuousStreamData(
+		first,
+		channels.getLength(),
+		m_channelPointers.getRawDataPointer() + first,
+		timestamps,
+		idx.size1);
+
+	if (idx.size2 > 0)
+	{
+		for (int chan = first; chan < channels.getEnd(); ++chan)
+		{
+			m_sampleNumbers.set(chan, m_sampleNumbers[chan] + idx.size1);
+			m_engine->updateLatestSampleNumbers(m_sampleNumbers, chan);
+			m_channelPointers.set(chan, dataBuffer.getReadPointer(chan, idx.index2));
 		}
+
+		m_engine->writeContinuousStreamData(
+			first,
+			channels.getLength(),
+			m_channelPointers.getRawDataPointer() + first,
+			timestamps + idx.size1,
+			idx.size2);
 	}
 }
 
+void RecordThread::createWriteTasks(const AudioBuffer<float>& dataBuffer)
+{
+	m_writeTasks.reset();
+	m_executor.reset();
+	m_streamChannelRanges.clear();
+
+	m_channelPointers.clearQuick();
+	m_channelPointers.insertMultiple(0, nullptr, m_numChannels);
+
+	m_readOffsets.clearQuick();
+	m_readOffsets.insertMultiple(0, 0, m_numChannels);
+
+	m_overflowSampleNumbers.clearQuick();
+	m_overflowSampleNumbers.insertMultiple(0, 0, m_numChannels);
+
+	/* Recorded channels are ordered by stream, so each stream is a contiguous range of write channels */
+	for (int chan = 0; chan < m_numChannels; ++chan)
+	{
+		if (chan == 0 || m_timestampBufferChannelArray[chan] != m_timestampBufferChannelArray[chan - 1])
+			m_streamChannelRanges.add(Range<int>(chan, chan + 1));
+		else
+			m_streamChannelRanges.getReference(m_streamChannelRanges.size() - 1).setEnd(chan + 1);
+	}
+
+	m_timestamps.setSize(m_streamChannelRanges.size(), BLOCK_MAX_WRITE_SAMPLES);
+
+	int numWorkers = jmin(m_streamChannelRanges.size(), SystemStats::getNumCpus());
+
+	if (!m_parallelWrites || !m_engine->supportsParallelWrites() || numWorkers < 2)
+		return;
+
+	LOGD("RecordThread: writing ", m_streamChannelRanges.size(), " streams with ", numWorkers, " workers");
+
+	m_executor = std::make_unique<tf::Executor>(numWorkers);
+	m_writeTasks = std::make_unique<tf::Taskflow>();
+
+	for (int stream = 0; stream < m_streamChannelRanges.size(); ++stream)
+	{
+		m_writeTasks->emplace([this, stream, &dataBuffer]()
+		{
+			writeContinuousStream(stream, dataBuffer);
+		});
+	}
+}
 
 void RecordThread::forceCloseFiles()
 {
@@ -27,15 +27,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "BinaryFormat/BinaryRecording.h"
 #include "EventQueue.h"
 #include "DataQueue.h"
+#include "RecordTrigger.h"
+#include "OverflowFile.h"
 #include "../../Utils/Utils.h"
+#include "../../Utils/FillLevelNotifier.h"
 #include <atomic>
 
 #define BLOCK_MAX_WRITE_SAMPLES 4096
 #define BLOCK_MAX_WRITE_EVENTS 50000
 #define BLOCK_MAX_WRITE_SPIKES 50000
 
+/** Longest time the thread sleeps without being notified of new data */
+#define MAX_IDLE_WAIT_MS 50
+
+/** Data queue usage above which continuous data is diverted to the overflow file */
+#define OVERFLOW_THRESHOLD 0.5f
+
 class RecordNode;
 
+namespace tf
+{
+	class Executor;
+	class Taskflow;
+}
+
 /**
 *
 *	A thread inside the RecordNode that allows continuous data, spikes,
@@ -70,25 +85,98 @@ public:
 	/** Sets whether the first block is being written */
 	void setFirstBlockFlag(bool state);
 
+	/** Wakes the thread after new data or events have been added to the queues */
+	void notifyDataAvailable();
+
 	/** Force all open files to close */
 	void forceCloseFiles();
     
     /** Updates the Record Engine for this thread*/
     void setEngine(RecordEngine* engine);
 
+	/** Enables writing each recorded stream on its own worker thread (if the engine supports it) */
+	void setParallelWrites(bool state);
+
+	/** Sets the trigger windows to record in pre-trigger mode, or nullptr to record everything */
+	void setRecordTrigger(RecordTrigger* trigger);
+
+	/** Sets the scratch directory for the overflow file, or File() to never divert data to disk */
+	void setOverflowDirectory(const File& directory);
+
+	/** Returns the number of bytes waiting in the overflow file */
+	int64 getOverflowPendingBytes() const;
+
+	/** Returns the largest number of bytes held by the overflow file in the current recording */
+	int64 getOverflowPeakBytes() const;
+
+	/** Returns the highest data queue usage in the current recording */
+	float getDataQueueHighWaterMark() const;
+
+	/** Returns true once after the record engine reports a write error */
+	bool getAndClearWriteError();
+
 	RecordNode *recordNode;
 	//int64 samplesWritten;
 
 private:
 
+	/** Returns true if any of the queues (or the overflow file) has something to write */
+	bool hasDataToWrite() const;
+
 	/** Writes continuous data with an array of synchronized timestamps */
 	void writeData(const AudioBuffer<float>& dataBuffer,
-		const SynchronizedTimestampBuffer& timestampBuffer,
 		int maxSamples,
 		int maxEvents,
 		int maxSpikes,
 		bool lastBlock = false);
 
+	/** Writes the data read from the DataQueue for a single recorded channel,
+		using the given scratch space for its synchronized timestamps */
+	void writeContinuousChannel(int chan,
+		const AudioBuffer<float>& dataBuffer,
+		double* timestamps);
+
+	/** Writes the data read from the DataQueue for all recorded channels of a stream,
+		falling back to one channel at a time if the channels' read windows differ */
+	void writeContinuousStream(int stream,
+		const AudioBuffer<float>& dataBuffer);
+
+	/** Writes one event to the record engine */
+	void writeEvent(const EventPacket& event);
+
+	/** Deserializes one spike and writes it to the record engine */
+	void writeSpike(int spikeIndex, const SpikeChannel* chan, const uint8* data);
+
+	/** In pre-trigger mode, narrows each channel's read window down to the samples inside a trigger window,
+		and leaves the pre-trigger history in the DataQueue */
+	void selectTriggeredSamples(int maxSamples);
+
+	/** In pre-trigger mode, writes or discards the events that were waiting for a trigger decision */
+	void writePendingEvents(bool lastBlock);
+
+	/** Returns true if continuous data should go through the overflow file */
+	bool shouldUseOverflow() const;
+
+	/** Moves everything in the DataQueue to the overflow file; returns false if the file can't be used and holds no data.
+		After a write error, the rest of the read stays in the queue and spilling is turned off for this recording. */
+	bool spillToOverflow(const AudioBuffer<float>& dataBuffer);
+
+	/** Appends the current read of a range of channels to the overflow file, in records of at most BLOCK_MAX_WRITE_SAMPLES.
+		Returns false if a write fails, leaving the samples that weren't written in the queue. */
+	bool spillChannels(int stream, int firstChannel, int numChannels, const AudioBuffer<float>& dataBuffer);
+
+	/** Passes the oldest records of the overflow file to the record engine */
+	void writeOverflowData(bool lastBlock);
+
+	/** Publishes the overflow file's size for getOverflowPendingBytes() and getOverflowPeakBytes() */
+	void updateOverflowUsage();
+
+	/** Logs any events or spikes dropped by the event queues since the last call */
+	void reportDroppedEvents();
+
+	/** Finds the channels of each recorded stream, and creates one write task per stream if parallel writes are possible */
+	void createWriteTasks(const AudioBuffer<float>& dataBuffer);
+
 	RecordEngine* m_engine;
 	Array<int> m_channelArray;
 	Array<int> m_timestampBufferChannelArray;
@@ -97,6 +185,56 @@ private:
 	EventMsgQueue* m_eventQueue;
 	SpikeMsgQueue *m_spikeQueue;
 
+	std::vector<EventView> m_events;
+	std::vector<EventView> m_spikes;
+
+	/** An event or spike copied out of its queue while the pre-trigger mode decides whether to keep it */
+	struct PendingEvent
+	{
+		PendingEvent(const EventView& view, int stream_) :
+			data(view.getRawData(), view.getRawDataSize()),
+			sampleNumber(view.getTimestamp()),
+			extra(view.getExtra()),
+			stream(stream_)
+		{}
+
+		MemoryBlock data;
+		int64 sampleNumber;
+		int extra;
+		int stream;
+	};
+
+	RecordTrigger* m_trigger;
+
+	File m_overflowDirectory;
+	std::unique_ptr<OverflowFile> m_overflow;
+	AudioBuffer<float> m_overflowData;
+	HeapBlock<double> m_overflowTimestamps;
+	Array<int64> m_overflowSampleNumbers;
+	Array<int64> m_overflowRecordSampleNumbers;
+	int64 m_overflowBytes;
+	std::atomic<int64> m_overflowPendingBytes;
+	std::atomic<int64> m_overflowPeakBytes;
+	std::atomic<bool> m_writeError;
+	bool m_writeErrorReported;
+	OwnedArray<PendingEvent> m_pendingEvents;
+	OwnedArray<PendingEvent> m_pendingSpikes;
+	int64 m_droppedEvents;
+	int64 m_droppedSpikes;
+
+	Array<CircularBufferIndexes> m_dataBufferIdxs;
+	SynchronizedTimestampBuffer m_timestamps;
+	Array<int64> m_sampleNumbers;
+	Array<const float*> m_channelPointers;
+	Array<int> m_readOffsets;
+
+	Array<Range<int>> m_streamChannelRanges;
+	std::unique_ptr<tf::Executor> m_executor;
+	std::unique_ptr<tf::Taskflow> m_writeTasks;
+	bool m_parallelWrites;
+
+	FillLevelNotifier m_dataNotifier;
+
 	std::atomic<bool> m_receivedFirstBlock;
 	std::atomic<bool> m_cleanExit;
 
@@ -0,0 +1,209 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "RecordTrigger.h"
+
+/** Maximum number of triggers waiting to be picked up by the record thread */
+#define MAX_PENDING_TRIGGERS 256
+
+RecordTrigger::RecordTrigger() :
+	m_mainStream(0)
+{}
+
+RecordTrigger::~RecordTrigger()
+{}
+
+void RecordTrigger::configure(const Array<uint16>& streamIds,
+	const Array<float>& sampleRates,
+	const Array<int>& channelStreams,
+	int mainStream,
+	float preTriggerSeconds,
+	float postTriggerSeconds)
+{
+	m_streams.clear();
+	m_mainStream = jmax(0, mainStream);
+
+	for (int i = 0; i < streamIds.size(); ++i)
+	{
+		TriggerStream* stream = new TriggerStream();
+		stream->streamId = streamIds[i];
+		stream->sampleRate = sampleRates[i];
+		stream->hasContinuousData = channelStreams.contains(i);
+		stream->preTriggerSamples = int64(std::ceil(preTriggerSeconds * sampleRates[i]));
+		stream->postTriggerSamples = int64(std::ceil(postTriggerSeconds * sampleRates[i]));
+		stream->latestSampleNumber = 0;
+		stream->resolvedBefore = 0;
+		stream->dataPosition = 0;
+		m_streams.add(stream);
+	}
+
+	m_triggerFifo = std::make_unique<AbstractFifo>(MAX_PENDING_TRIGGERS);
+	m_triggerSamples.calloc(MAX_PENDING_TRIGGERS * jmax(1, streamIds.size()));
+}
+
+int RecordTrigger::getMaxPreTriggerSamples() const
+{
+	int64 maxSamples = 0;
+
+	for (auto stream : m_streams)
+	{
+		if (stream->hasContinuousData)
+			maxSamples = jmax(maxSamples, stream->preTriggerSamples);
+	}
+
+	return int(maxSamples);
+}
+
+void RecordTrigger::setLatestSampleNumber(int stream, int64 sampleNumber)
+{
+	m_streams[stream]->latestSampleNumber.store(sampleNumber);
+}
+
+void RecordTrigger::addTrigger(const Array<int64>& sampleNumbers)
+{
+	int start1, size1, start2, size2;
+	m_triggerFifo->prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 == 0)
+		return;
+
+	int64* dest = m_triggerSamples + start1 * m_streams.size();
+
+	for (int i = 0; i < m_streams.size(); ++i)
+		dest[i] = sampleNumbers[i];
+
+	m_triggerFifo->finishedWrite(1);
+}
+
+void RecordTrigger::updateLatestSampleNumbers()
+{
+	for (auto stream : m_streams)
+	{
+		/* Any trigger that has not been added yet will be mapped to at least this sample number,
+		   so its window cannot reach further back than one pre-trigger window */
+		int64 resolvedBefore = stream->latestSampleNumber.load() - stream->preTriggerSamples;
+
+		stream->resolvedBefore = jmax(stream->resolvedBefore, resolvedBefore);
+	}
+}
+
+void RecordTrigger::updateWindows()
+{
+	int start1, size1, start2, size2;
+	int numTriggers = m_triggerFifo->getNumReady();
+	m_triggerFifo->prepareToRead(numTriggers, start1, size1, start2, size2);
+
+	for (int t = 0; t < size1 + size2; ++t)
+	{
+		int index = (t < size1) ? start1 + t : start2 + t - size1;
+		const int64* sampleNumbers = m_triggerSamples + index * m_streams.size();
+
+		for (int i = 0; i < m_streams.size(); ++i)
+		{
+			TriggerStream* stream = m_streams[i];
+			Range<int64> window(sampleNumbers[i] - stream->preTriggerSamples, sampleNumbers[i] + stream->postTriggerSamples);
+
+			if (stream->windows.size() > 0 && window.getStart() <= stream->windows.getLast().getEnd())
+			{
+				Range<int64>& last = stream->windows.getReference(stream->windows.size() - 1);
+				last.setEnd(jmax(last.getEnd(), window.getEnd()));
+			}
+			else
+			{
+				stream->windows.add(window);
+			}
+		}
+	}
+
+	m_triggerFifo->finishedRead(size1 + size2);
+
+	/* Windows are kept for an extra second, in case events arrive slightly late */
+	for (auto stream : m_streams)
+	{
+		int64 retireBefore = stream->resolvedBefore - int64(stream->sampleRate);
+
+		if (stream->hasContinuousData)
+			retireBefore = jmin(retireBefore, stream->dataPosition);
+
+		while (stream->windows.size() > 0 && stream->windows.getFirst().getEnd() < retireBefore)
+			stream->windows.remove(0);
+	}
+}
+
+int RecordTrigger::selectSamples(int streamIndex, int64 firstSample, int numSamples, int maxWrite, int& skip, int& write)
+{
+	TriggerStream* stream = m_streams[streamIndex];
+
+	skip = 0;
+	write = 0;
+
+	for (auto window : stream->windows)
+	{
+		if (window.getEnd() <= firstSample)
+			continue;
+
+		if (window.getStart() < firstSample + numSamples)
+		{
+			skip = int(jmax(int64(0), window.getStart() - firstSample));
+			write = int(jmin(int64(numSamples), window.getEnd() - firstSample)) - skip;
+			write = jmin(write, maxWrite);
+		}
+
+		break;
+	}
+
+	/* Outside of a window, everything older than the pre-trigger window is discarded */
+	if (write == 0)
+		skip = int(jmax(int64(0), numSamples - stream->preTriggerSamples));
+
+	stream->dataPosition = firstSample + skip + write;
+
+	return skip + write;
+}
+
+RecordTrigger::EventAction RecordTrigger::getEventAction(int streamIndex, int64 sampleNumber) const
+{
+	const TriggerStream* stream = m_streams[streamIndex];
+
+	for (auto window : stream->windows)
+	{
+		if (window.contains(sampleNumber))
+			return WRITE_EVENT;
+	}
+
+	if (sampleNumber < stream->resolvedBefore)
+		return DISCARD_EVENT;
+
+	return DEFER_EVENT;
+}
+
+int RecordTrigger::getStreamIndex(uint16 streamId) const
+{
+	for (int i = 0; i < m_streams.size(); ++i)
+	{
+		if (m_streams[i]->streamId == streamId)
+			return i;
+	}
+
+	return m_mainStream;
+}
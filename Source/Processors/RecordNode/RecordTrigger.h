@@ -0,0 +1,130 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef RECORDTRIGGER_H_INCLUDED
+#define RECORDTRIGGER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../../Utils/Utils.h"
+
+#include <atomic>
+
+/**
+	Keeps track of the recording windows of the pre-trigger recording mode.
+
+	While this mode is active, the RecordNode keeps the last few seconds of
+	every stream in its DataQueue and only writes data that falls inside a
+	window around a trigger: from preTriggerSeconds before the trigger until
+	postTriggerSeconds after it. Overlapping windows are merged.
+
+	Triggers are added from the audio thread, with their sample number in
+	every stream. All other methods, except configure(), are called by the
+	RecordThread.
+*/
+class RecordTrigger
+{
+public:
+
+	/** Constructor */
+	RecordTrigger();
+
+	/** Destructor */
+	~RecordTrigger();
+
+	/// -----------  NOT THREAD SAFE  -------------- //
+
+	/** Sets the sample rate of each stream, the stream index of each recorded channel,
+		the index of the stream used for events that don't belong to any stream,
+		and the length of the windows around each trigger */
+	void configure(const Array<uint16>& streamIds,
+		const Array<float>& sampleRates,
+		const Array<int>& channelStreams,
+		int mainStream,
+		float preTriggerSeconds,
+		float postTriggerSeconds);
+
+	/** Returns the longest pre-trigger window of all streams, in samples */
+	int getMaxPreTriggerSamples() const;
+
+	/// -----------  AUDIO THREAD  -------------- //
+
+	/** Sets the number of the last sample of a stream that has been sent to the record queues */
+	void setLatestSampleNumber(int stream, int64 sampleNumber);
+
+	/** Adds a trigger, given its sample number in each stream */
+	void addTrigger(const Array<int64>& sampleNumbers);
+
+	/// -----------  RECORD THREAD  -------------- //
+
+	/** Takes a snapshot of the latest sample numbers; must be called before reading the queues */
+	void updateLatestSampleNumbers();
+
+	/** Turns new triggers into recording windows; must be called after reading the queues */
+	void updateWindows();
+
+	/** Decides what to do with numSamples samples of a stream, starting at firstSample:
+		the first skip samples are discarded, the next write samples (at most maxWrite) are written,
+		and the remaining ones are kept in the queue. Returns skip + write. */
+	int selectSamples(int stream, int64 firstSample, int numSamples, int maxWrite, int& skip, int& write);
+
+	enum EventAction
+	{
+		WRITE_EVENT,
+		DISCARD_EVENT,
+		DEFER_EVENT
+	};
+
+	/** Returns whether an event at a given sample number should be written, discarded, or kept until a later decision */
+	EventAction getEventAction(int stream, int64 sampleNumber) const;
+
+	/** Returns the index of a stream from its ID, or the main stream index if no stream matches */
+	int getStreamIndex(uint16 streamId) const;
+
+private:
+
+	struct TriggerStream
+	{
+		uint16 streamId;
+		float sampleRate;
+		bool hasContinuousData;
+
+		int64 preTriggerSamples;
+		int64 postTriggerSamples;
+
+		std::atomic<int64> latestSampleNumber; // written by the audio thread
+
+		int64 resolvedBefore; // events before this sample number are written or discarded
+		int64 dataPosition; // first sample still in the queue
+		Array<Range<int64>> windows;
+	};
+
+	OwnedArray<TriggerStream> m_streams;
+	int m_mainStream;
+
+	std::unique_ptr<AbstractFifo> m_triggerFifo;
+	HeapBlock<int64> m_triggerSamples;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordTrigger);
+};
+
+#endif  // RECORDTRIGGER_H_INCLUDED
@@ -32,6 +32,69 @@
 #include "../Events/Event.h"
 #include "../Settings/DataStream.h"
 
+#if JUCE_USE_SSE_INTRINSICS
+ #include <immintrin.h>
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+ #include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+ #include <intrin.h>
+#endif
+
+/* Number of event codes compared at once when looking for TTL changes */
+#define TTL_SCAN_BLOCK 8
+
+/* Number of TTL edges collected before their events are added */
+#define TTL_EDGE_BATCH_SIZE 1024
+
+namespace
+{
+    /* Returns true if any of the TTL_SCAN_BLOCK words starting at codes differs from
+       the word before it (codes[-1] must be valid) */
+    inline bool blockHasTTLChange (const uint64* codes)
+    {
+#if JUCE_USE_SSE_INTRINSICS
+        __m128i diff = _mm_setzero_si128();
+
+        for (int i = 0; i < TTL_SCAN_BLOCK; i += 2)
+        {
+            __m128i current = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (codes + i));
+            __m128i previous = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (codes + i - 1));
+            diff = _mm_or_si128 (diff, _mm_xor_si128 (current, previous));
+        }
+
+        return _mm_movemask_epi8 (_mm_cmpeq_epi8 (diff, _mm_setzero_si128())) != 0xFFFF;
+#elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+        uint64x2_t diff = vdupq_n_u64 (0);
+
+        for (int i = 0; i < TTL_SCAN_BLOCK; i += 2)
+            diff = vorrq_u64 (diff, veorq_u64 (vld1q_u64 (codes + i), vld1q_u64 (codes + i - 1)));
+
+        return (vgetq_lane_u64 (diff, 0) | vgetq_lane_u64 (diff, 1)) != 0;
+#else
+        uint64 diff = 0;
+
+        for (int i = 0; i < TTL_SCAN_BLOCK; ++i)
+            diff |= codes[i] ^ codes[i - 1];
+
+        return diff != 0;
+#endif
+    }
+
+    /* Returns the index of the lowest set bit (value must not be 0) */
+    inline int lowestSetBit (uint64 value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64 (&index, value);
+        return (int) index;
+#else
+        return __builtin_ctzll (value);
+#endif
+    }
+}
+
 SourceNode::SourceNode (const String& name_, DataThreadCreator dataThreadCreator)
     : GenericProcessor      (name_)
 {
@@ -97,6 +160,8 @@ void SourceNode::resizeBuffers()
 			eventStates.add(0);
 		}
 	}
+
+	ttlEdges.malloc(TTL_EDGE_BATCH_SIZE);
 }
 
 void SourceNode::initialize(bool signalChainIsLoading)
@@ -292,12 +357,33 @@ void SourceNode::handleBroadcastMessage(String msg)
     dataThread->handleBroadcastMessage(msg);
 }
 
+void SourceNode::parameterValueChanged(Parameter* param)
+{
+    if (dataThread != nullptr)
+        dataThread->parameterValueChanged(param);
+}
+
 
 void SourceNode::broadcastDataThreadMessage(String msg)
 {
     broadcastMessage(msg);
 }
 
+void SourceNode::addTTLEdges(int streamIdx, int numEdges)
+{
+	for (int i = 0; i < numEdges; i++)
+	{
+		const TTLEdge& edge = ttlEdges[i];
+
+		addTTLEvent(eventChannels[streamIdx],
+			sampleNumber + edge.sample,
+			edge.line,
+			edge.state,
+			edge.word,
+			edge.sample);
+	}
+}
+
 void SourceNode::process(AudioBuffer<float>& buffer)
 {
 	int copiedChannels = 0;
@@ -328,35 +414,61 @@ void SourceNode::process(AudioBuffer<float>& buffer)
 
 		if (eventChannels[streamIdx])
 		{
-            int maxTTLBits = eventChannels[streamIdx]->getMaxTTLBits();
+            const int maxTTLBits = eventChannels[streamIdx]->getMaxTTLBits();
+            const uint64 lineMask = maxTTLBits >= 64 ? ~uint64(0) : (uint64(1) << maxTTLBits) - 1;
+
+            const uint64* codes = static_cast<uint64*>(eventCodeBuffers[streamIdx]->getData());
 
 			uint64 lastCode = eventStates[streamIdx];
+            uint64 changedLines = 0;
+            int numEdges = 0;
 
-			for (int sample = 0; sample < nSamples; ++sample)
+			int sample = 0;
+
+			while (sample < nSamples)
 			{
-				uint64 currentCode = *(static_cast<uint64*>(eventCodeBuffers[streamIdx]->getData()) + sample);
+				//Skip whole blocks in which the TTL word never changes
+				if (sample > 0 && sample + TTL_SCAN_BLOCK <= nSamples && ! blockHasTTLChange(codes + sample))
+				{
+					sample += TTL_SCAN_BLOCK;
+					continue;
+				}
+
+				const uint64 currentCode = codes[sample];
+
+				//Record an edge for each line that has changed
+				uint64 changed = (currentCode ^ lastCode) & lineMask;
+				changedLines |= changed;
 
-				//If there has been no change to the TTL word, avoid doing anything at all here
-				if (lastCode != currentCode)
+				while (changed != 0)
 				{
-					//Create a TTL event for each bit that has changed
-					for (uint8 c = 0; c < maxTTLBits; ++c)
+					if (numEdges == TTL_EDGE_BATCH_SIZE)
 					{
-						if (((currentCode >> c) & 0x01) != ((lastCode >> c) & 0x01))
-						{
-							TTLEventPtr event = TTLEvent::createTTLEvent(eventChannels[streamIdx],
-                                sampleNumber + sample,
-                                c,
-                                (currentCode >> c) & 0x01,
-                                currentCode);
-
-							addEvent(event, sample);
-						}
+						addTTLEdges(streamIdx, numEdges);
+						numEdges = 0;
 					}
 
-                    lastCode = currentCode;
+					const int line = lowestSetBit(changed);
+					changed &= changed - 1;
+
+					ttlEdges[numEdges++] = { sample, uint8(line), ((currentCode >> line) & 1) != 0, currentCode };
 				}
+
+				lastCode = currentCode;
+				++sample;
 			}
+
+			addTTLEdges(streamIdx, numEdges);
+
+			//The TTL monitors only need the final state of each line
+			while (changedLines != 0)
+			{
+				const int line = lowestSetBit(changedLines);
+				changedLines &= changedLines - 1;
+
+				getEditor()->setTTLState(dataStreams[streamIdx]->getStreamId(), line, ((lastCode >> line) & 1) != 0);
+			}
+
 			eventStates.set(streamIdx, lastCode);
 		}
 	}
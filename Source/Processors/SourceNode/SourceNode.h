@@ -68,6 +68,9 @@ public:
     /* Gets the default sample rate*/
     float getDefaultSampleRate() const override;
 
+    /* Passes parameter changes on to the DataThread*/
+    void parameterValueChanged(Parameter* param) override;
+
     /* Allows the DataThread to update the signal chain*/
     void requestSignalChainUpdate();
 
@@ -106,6 +109,18 @@ private:
     /* Updates the size of the DataBuffers*/
     void resizeBuffers();
 
+    /* A change of one TTL line, found while scanning a block of event codes*/
+    struct TTLEdge
+    {
+        int sample;
+        uint8 line;
+        bool state;
+        uint64 word;
+    };
+
+    /* Adds the events for a batch of TTL edges of one stream*/
+    void addTTLEdges(int streamIdx, int numEdges);
+
     /* Interval (in ms) for checking for the data source*/
     int sourceCheckInterval = 2000;
 
@@ -123,6 +138,8 @@ private:
 	Array<uint64> eventStates;
 	Array<EventChannel*> ttlChannels;
 
+    HeapBlock<TTLEdge> ttlEdges;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceNode);
 };
 
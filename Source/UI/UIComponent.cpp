@@ -37,6 +37,8 @@
 #include "../Audio/AudioComponent.h"
 #include "../MainWindow.h"
 #include "../AutoUpdater.h"
+#include "../Utils/TraceRecorder.h"
+#include "../Utils/RealtimeSafetyChecker.h"
 
 	UIComponent::UIComponent(MainWindow* mainWindow_, ProcessorGraph* pgraph, AudioComponent* audio_)
 : mainWindow(mainWindow_), processorGraph(pgraph), audio(audio_), messageCenterIsCollapsed(true)
@@ -434,6 +436,12 @@ PopupMenu UIComponent::getMenuForIndex(int menuIndex, const String& menuName)
 		menu.addCommandItem(commandManager, reloadOnStartup);
 		menu.addSeparator();
 		menu.addCommandItem(commandManager, toggleHttpServer);
+		menu.addCommandItem(commandManager, toggleParallelRendering);
+		menu.addCommandItem(commandManager, toggleParallelStreams);
+		menu.addSeparator();
+		menu.addCommandItem(commandManager, toggleTracing);
+		menu.addCommandItem(commandManager, saveTrace);
+		menu.addCommandItem(commandManager, toggleRealtimeChecks);
 		menu.addSeparator();
 		menu.addCommandItem(commandManager, openDefaultConfigWindow);
 		menu.addSeparator();
@@ -517,6 +525,11 @@ void UIComponent::getAllCommands(Array <CommandID>& commands)
 		toggleProcessorList,
 		toggleSignalChain,
 		toggleHttpServer,
+		toggleTracing,
+		saveTrace,
+		toggleRealtimeChecks,
+		toggleParallelRendering,
+		toggleParallelStreams,
 		toggleFileInfo,
 		setClockModeDefault,
 		setClockModeHHMMSS,
@@ -575,6 +588,33 @@ void UIComponent::getCommandInfo(CommandID commandID, ApplicationCommandInfo& re
 			result.setTicked(mainWindow->shouldEnableHttpServer);
 			break;
 
+		case toggleTracing:
+			result.setInfo("Record Trace", "Record processing spans from all threads for export as a Chrome trace.", "General", 0);
+			result.setTicked(TraceRecorder::isEnabled());
+			break;
+
+		case saveTrace:
+			result.setInfo("Save Trace...", "Save the recorded spans as Chrome trace-event JSON.", "General", 0);
+			break;
+
+		case toggleRealtimeChecks:
+			result.setInfo("Check Real-Time Safety", "Log allocations and locks made inside processBlock() when acquisition stops.", "General", 0);
+			result.setActive(!acquisitionStarted && RealtimeSafetyChecker::isSupported());
+			result.setTicked(RealtimeSafetyChecker::isEnabled());
+			break;
+
+		case toggleParallelRendering:
+			result.setInfo("Parallel Rendering", "Process independent branches of the signal chain on separate threads.", "General", 0);
+			result.setActive(!acquisitionStarted);
+			result.setTicked(processorGraph->isParallelRenderingEnabled());
+			break;
+
+		case toggleParallelStreams:
+			result.setInfo("Parallel Stream Processing", "Process the data streams of supported plugins on separate threads.", "General", 0);
+			result.setActive(!acquisitionStarted);
+			result.setTicked(GenericProcessor::isParallelStreamProcessingEnabled());
+			break;
+
 		case undo:
 			result.setInfo("Undo", "Undo the last action.", "General", 0);
 			result.addDefaultKeypress('Z', ModifierKeys::commandModifier);
@@ -805,6 +845,44 @@ bool UIComponent::perform(const InvocationInfo& info)
 			}
 			break;
 
+		case toggleTracing:
+			TraceRecorder::setEnabled(!TraceRecorder::isEnabled());
+			break;
+
+		case toggleRealtimeChecks:
+			RealtimeSafetyChecker::setEnabled(!RealtimeSafetyChecker::isEnabled());
+			break;
+
+		case toggleParallelRendering:
+			processorGraph->setParallelRendering(!processorGraph->isParallelRenderingEnabled());
+			break;
+
+		case toggleParallelStreams:
+			GenericProcessor::setParallelStreamProcessingEnabled(!GenericProcessor::isParallelStreamProcessingEnabled());
+			break;
+
+		case saveTrace:
+			{
+				FileChooser fc("Choose the file name...",
+						CoreServices::getDefaultUserSaveDirectory().getChildFile("trace.json"),
+						"*.json",
+						true);
+
+				if (fc.browseForFileToSave(true))
+				{
+					Result result = TraceRecorder::writeChromeTrace(fc.getResult());
+
+					if (result.failed())
+						sendActionMessage(result.getErrorMessage());
+				}
+				else
+				{
+					sendActionMessage("No file chosen.");
+				}
+
+				break;
+			}
+
         case undo:
             {
                 getEditorViewport()->undo();
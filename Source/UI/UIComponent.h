@@ -205,6 +205,11 @@ private:
         setClockModeDefault     = 0x2111,
 		setClockModeHHMMSS      = 0x2112,
         toggleHttpServer        = 0x4001,
+        toggleTracing           = 0x4002,
+        saveTrace               = 0x4003,
+        toggleRealtimeChecks    = 0x4004,
+        toggleParallelRendering = 0x4005,
+        toggleParallelStreams   = 0x4006,
         showHelp				= 0x2011,
         checkForUpdates         = 0x2022,
         resizeWindow            = 0x2012,
@@ -0,0 +1,76 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "FillLevelNotifier.h"
+
+FillLevelNotifier::FillLevelNotifier()
+    : numWaiters (0),
+      waitingThread (nullptr)
+{
+}
+
+FillLevelNotifier::~FillLevelNotifier()
+{
+    jassert (numWaiters.load() == 0);
+}
+
+void FillLevelNotifier::notify()
+{
+    // orders the caller's buffer update before the check, pairing with the increment in beginWait()
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+
+    if (numWaiters.load (std::memory_order_relaxed) > 0)
+        event.signal();
+}
+
+void FillLevelNotifier::beginWait()
+{
+    jassert (numWaiters.load() == 0);
+
+    waitingThread = Thread::getCurrentThread();
+
+    if (waitingThread != nullptr)
+        waitingThread->addListener (this);
+
+    numWaiters.fetch_add (1);
+}
+
+void FillLevelNotifier::endWait()
+{
+    numWaiters.fetch_sub (1);
+
+    if (waitingThread != nullptr)
+        waitingThread->removeListener (this);
+
+    waitingThread = nullptr;
+}
+
+bool FillLevelNotifier::shouldStopWaiting() const
+{
+    return waitingThread != nullptr && waitingThread->threadShouldExit();
+}
+
+void FillLevelNotifier::exitSignalSent()
+{
+    event.signal();
+}
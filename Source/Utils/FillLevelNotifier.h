@@ -0,0 +1,110 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __FILLLEVELNOTIFIER_H_8E51C0B4__
+#define __FILLLEVELNOTIFIER_H_8E51C0B4__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../Processors/PluginManager/OpenEphysPlugin.h"
+
+#include <atomic>
+
+/**
+    Lets a thread sleep until a buffer it shares with another thread reaches the
+    fill level it needs, instead of polling.
+
+    The waiting thread calls waitUntil() with a condition on the buffer (e.g. "at least
+    N samples free"). The other side calls notify() after every read or write; when
+    nobody is waiting, notify() is just an atomic load, so it can be called from the
+    audio thread once per block.
+
+    A wait also ends when the waiting thread is asked to exit, so stopping a thread
+    never has to wait for the timeout.
+
+    Only one thread may wait on a notifier at a time.
+*/
+class PLUGIN_API FillLevelNotifier : private Thread::Listener
+{
+public:
+
+    /** Constructor */
+    FillLevelNotifier();
+
+    /** Destructor */
+    ~FillLevelNotifier();
+
+    /** Wakes the waiting thread, if any, so it can re-check its condition */
+    void notify();
+
+    /** Blocks until condition() returns true, the calling thread is asked to exit,
+        or timeoutMs milliseconds have passed. Returns the last value of condition(). */
+    template <typename Condition>
+    bool waitUntil (Condition condition, int timeoutMs)
+    {
+        if (condition())
+            return true;
+
+        beginWait();
+
+        const uint32 start = Time::getMillisecondCounter();
+        bool ready;
+
+        while (! (ready = condition()) && ! shouldStopWaiting())
+        {
+            const int remaining = timeoutMs - int (Time::getMillisecondCounter() - start);
+
+            if (remaining <= 0)
+                break;
+
+            event.wait (remaining);
+        }
+
+        endWait();
+
+        return ready;
+    }
+
+private:
+
+    /** Registers the calling thread as the waiter */
+    void beginWait();
+
+    /** Unregisters the waiter */
+    void endWait();
+
+    /** Returns true if the waiting thread has been asked to exit */
+    bool shouldStopWaiting() const;
+
+    /** Wakes the waiter when its thread is asked to exit */
+    void exitSignalSent() override;
+
+    WaitableEvent event;
+
+    std::atomic<int> numWaiters;
+
+    Thread* waitingThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FillLevelNotifier);
+};
+
+#endif  // __FILLLEVELNOTIFIER_H_8E51C0B4__
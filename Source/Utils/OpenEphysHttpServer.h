@@ -33,10 +33,13 @@
 
 #include "../MainWindow.h"
 #include "../AccessClass.h"
+#include "../Audio/AudioComponent.h"
 #include "../UI/ProcessorList.h"
 #include "../UI/EditorViewport.h"
 
 #include "Utils.h"
+#include "TraceRecorder.h"
+#include "RealtimeSafetyChecker.h"
 
 using json = nlohmann::json;
 
@@ -74,6 +77,14 @@ using json = nlohmann::json;
  * - PUT /api/recording/<processor_id> :
  *          used to set the options for a given Record Node
  * 
+ * - GET /api/audio :
+ *          returns a JSON string with the device driving acquisition ("device_type"),
+ *          its sample rate, and its block size in samples and microseconds
+ * 
+ * - PUT /api/audio :
+ *          changes the device driving acquisition while it is stopped, e.g.:
+ *          {"device_type" : "Internal Clock", "buffer_size" : 256} or {"buffer_duration_us" : 1000}
+ * 
  * - GET /api/processors :
  * - GET /api/processors/<processor_id>
  * - GET /api/processors/<processor_id>/parameters
@@ -88,6 +99,22 @@ using json = nlohmann::json;
  * - PUT /api/processors/delete
  * - PUT /api/window
  *
+ * - GET /api/trace :
+ *          returns the spans recorded so far as Chrome trace-event JSON
+ *          (open in chrome://tracing or https://ui.perfetto.dev)
+ *
+ * - PUT /api/trace :
+ *          starts or stops tracing, and optionally discards recorded spans, e.g.:
+ *          {"enabled" : true, "clear" : true}
+ *
+ * - GET /api/realtime_safety :
+ *          returns the allocations and mutex locks recorded inside processBlock(), with counts
+ *          and sample backtraces for each processor, stream and violation type
+ *
+ * - PUT /api/realtime_safety :
+ *          starts or stops real-time safety checks, and optionally discards recorded violations, e.g.:
+ *          {"enabled" : true, "clear" : true}
+ *
  * All endpoints are JSON endpoints. The PUT endpoint expects two parameters: "channel" (an integer), and "value",
  * which should have a type matching the type of the parameter.
  */
@@ -286,6 +313,55 @@ public:
                 res.set_content(ret.dump(), "application/json");
             });
         
+        svr_->Get("/api/audio", [this](const httplib::Request&, httplib::Response& res) {
+            json ret;
+            const MessageManagerLock mml;
+            audio_info_to_json(&ret);
+            res.set_content(ret.dump(), "application/json");
+            });
+
+        svr_->Put("/api/audio", [this](const httplib::Request& req, httplib::Response& res) {
+            
+            json request_json;
+
+            LOGD("Received PUT request at /api/audio with content: ", req.body);
+
+            try
+            {
+                request_json = json::parse(req.body);
+            }
+            catch (json::exception& e)
+            {
+                LOGD("Could not parse input.");
+                res.set_content(e.what(), "text/plain");
+                res.status = 400;
+                return;
+            }
+
+            std::string device_type = request_json.value("device_type", std::string());
+            double sample_rate = request_json.value("sample_rate", 0.0);
+            int buffer_size = request_json.value("buffer_size", 0);
+            double buffer_duration_us = request_json.value("buffer_duration_us", 0.0);
+
+            const MessageManagerLock mml;
+
+            String error = AccessClass::getAudioComponent()->setDevice(String(device_type),
+                                                                         sample_rate,
+                                                                         buffer_size,
+                                                                         buffer_duration_us);
+
+            if (error.isNotEmpty())
+            {
+                res.set_content(error.toStdString(), "text/plain");
+                res.status = 400;
+                return;
+            }
+
+            json ret;
+            audio_info_to_json(&ret);
+            res.set_content(ret.dump(), "application/json");
+            });
+
         svr_->Put("/api/message", [this](const httplib::Request& req, httplib::Response& res) {
             std::string message_str;
             LOGD("Received PUT request");
@@ -880,6 +956,76 @@ public:
             AccessClass::getEditorViewport()->redo();
 
             });
+
+        svr_->Get("/api/trace", [this](const httplib::Request&, httplib::Response& res) {
+            res.set_content(TraceRecorder::exportChromeTrace().toStdString(), "application/json");
+            });
+
+        svr_->Put("/api/trace", [this](const httplib::Request& req, httplib::Response& res) {
+            json request_json;
+
+            LOGD("Received PUT request at /api/trace with content: ", req.body);
+
+            try
+            {
+                request_json = json::parse(req.body);
+            }
+            catch (json::exception& e)
+            {
+                LOGD("Could not parse input.");
+                res.set_content(e.what(), "text/plain");
+                res.status = 400;
+                return;
+            }
+
+            if (request_json.value("clear", false))
+                TraceRecorder::clear();
+
+            bool enabled = request_json.value("enabled", TraceRecorder::isEnabled());
+
+            if (enabled != TraceRecorder::isEnabled())
+                TraceRecorder::setEnabled(enabled);
+
+            json ret;
+            ret["enabled"] = TraceRecorder::isEnabled();
+            res.set_content(ret.dump(), "application/json");
+            });
+
+        svr_->Get("/api/realtime_safety", [this](const httplib::Request&, httplib::Response& res) {
+            json ret;
+            realtime_safety_to_json(&ret);
+            res.set_content(ret.dump(), "application/json");
+            });
+
+        svr_->Put("/api/realtime_safety", [this](const httplib::Request& req, httplib::Response& res) {
+            json request_json;
+
+            LOGD("Received PUT request at /api/realtime_safety with content: ", req.body);
+
+            try
+            {
+                request_json = json::parse(req.body);
+            }
+            catch (json::exception& e)
+            {
+                LOGD("Could not parse input.");
+                res.set_content(e.what(), "text/plain");
+                res.status = 400;
+                return;
+            }
+
+            if (request_json.value("clear", false))
+                RealtimeSafetyChecker::clear();
+
+            bool enabled = request_json.value("enabled", RealtimeSafetyChecker::isEnabled());
+
+            if (enabled != RealtimeSafetyChecker::isEnabled())
+                RealtimeSafetyChecker::setEnabled(enabled);
+
+            json ret;
+            realtime_safety_to_json(&ret);
+            res.set_content(ret.dump(), "application/json");
+            });
                    
         LOGC("Beginning HTTP server on port ", PORT);
         svr_->listen("0.0.0.0", PORT);
@@ -984,6 +1130,19 @@ private:
         (*ret)["is_synchronized"] = CoreServices::RecordNode::isSynchronized(nodeId);
     }
 
+    inline static void audio_info_to_json(json* ret)
+    {
+        AudioComponent* audio = AccessClass::getAudioComponent();
+
+        (*ret)["device_type"] = audio->getDeviceType().toStdString();
+
+        (*ret)["sample_rate"] = audio->getSampleRate();
+
+        (*ret)["buffer_size"] = audio->getBufferSize();
+
+        (*ret)["buffer_duration_us"] = audio->getBufferSize() * 1.0e6 / audio->getSampleRate();
+    }
+
     inline static void status_to_json(const ProcessorGraph* graph, json* ret) 
     {
         if (CoreServices::getRecordingStatus()) {
@@ -1033,6 +1192,48 @@ private:
     
     }
 
+    inline static void realtime_safety_to_json(json* ret)
+    {
+        (*ret)["supported"] = RealtimeSafetyChecker::isSupported();
+        (*ret)["enabled"] = RealtimeSafetyChecker::isEnabled();
+
+        std::vector<json> violations_json;
+
+        for (auto& violation : RealtimeSafetyChecker::getViolations())
+        {
+            json violation_json;
+            violation_json["processor_id"] = violation.nodeId;
+            violation_json["stream_id"] = violation.streamId;
+            violation_json["type"] = RealtimeSafetyChecker::getTypeName(violation.type).toStdString();
+            violation_json["count"] = violation.count;
+
+            std::vector<std::string> backtraces;
+
+            for (auto& backtrace : violation.backtraces)
+                backtraces.push_back(backtrace.toStdString());
+
+            violation_json["backtraces"] = backtraces;
+            violations_json.push_back(violation_json);
+        }
+
+        (*ret)["violations"] = violations_json;
+    }
+
+    inline static void process_timing_to_json(GenericProcessor* processor, json* timing_json)
+    {
+        GenericProcessor::ProcessTimingStats stats = processor->getProcessTimingStats();
+
+        (*timing_json)["block_count"] = stats.numBlocks;
+        (*timing_json)["mean_ms"] = stats.meanMs;
+        (*timing_json)["p50_ms"] = stats.p50Ms;
+        (*timing_json)["p99_ms"] = stats.p99Ms;
+        (*timing_json)["max_ms"] = stats.maxMs;
+        (*timing_json)["budget_ms"] = stats.budgetMs;
+        (*timing_json)["mean_budget_share"] = stats.meanBudgetShare;
+        (*timing_json)["p99_budget_share"] = stats.p99BudgetShare;
+        (*timing_json)["overrun_count"] = stats.numOverruns;
+    }
+
     inline static void processor_to_json(GenericProcessor* processor, json* processor_json)
     {
         (*processor_json)["id"] = processor->getNodeId();
@@ -1053,6 +1254,10 @@ private:
         
         (*processor_json)["streams"] = streams_json;
 
+        json timing_json;
+        process_timing_to_json(processor, &timing_json);
+        (*processor_json)["timing"] = timing_json;
+
         if (processor->getSourceNode() == nullptr) {
             (*processor_json)["predecessor"] = json::value_t::null;
         }
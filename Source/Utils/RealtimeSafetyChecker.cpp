@@ -0,0 +1,393 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "RealtimeSafetyChecker.h"
+#include "Utils.h"
+
+#include <atomic>
+#include <algorithm>
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #define OE_REALTIME_SAFETY_HOOKS 1
+ #include <execinfo.h>
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <cxxabi.h>
+ #include <cerrno>
+
+ /* Read from inside malloc, so they must never need dynamic TLS allocation */
+ #define OE_HOOK_THREAD_LOCAL thread_local __attribute__ ((tls_model ("initial-exec")))
+#else
+ #define OE_REALTIME_SAFETY_HOOKS 0
+ #define OE_HOOK_THREAD_LOCAL thread_local
+#endif
+
+namespace
+{
+    std::atomic<bool> checkingEnabled (false);
+
+    /* Processor and stream the calling thread is working on (-1 outside a RealtimeSafetyScope) */
+    OE_HOOK_THREAD_LOCAL int scopeNodeId = -1;
+    OE_HOOK_THREAD_LOCAL int scopeStreamId = -1;
+
+    /* Set while a violation is being recorded, so that the recording itself isn't reported */
+    OE_HOOK_THREAD_LOCAL bool isInsideHook = false;
+
+    /* Number of frames at the top of each backtrace that belong to the hooks */
+    const int NUM_HOOK_FRAMES = 2;
+
+    const int MAX_RECORDS = 512;
+
+    /** Violations of one type by one processor and stream; lives in static storage,
+        so recording a violation never allocates */
+    struct ViolationRecord
+    {
+        std::atomic<uint64> key;
+        std::atomic<int64> count;
+        std::atomic<int> numBacktraces;
+        std::atomic<bool> backtraceReady[RealtimeSafetyChecker::MAX_BACKTRACES];
+        void* frames[RealtimeSafetyChecker::MAX_BACKTRACES][RealtimeSafetyChecker::MAX_FRAMES];
+        int numFrames[RealtimeSafetyChecker::MAX_BACKTRACES];
+    };
+
+    ViolationRecord records[MAX_RECORDS];
+
+    /* Violations that didn't fit into the records table */
+    std::atomic<int64> numDroppedViolations (0);
+
+    uint64 makeKey (int nodeId, int streamId, RealtimeSafetyChecker::ViolationType type)
+    {
+        return (uint64 (uint32 (nodeId)) << 32) | (uint64 (uint16 (streamId)) << 8) | uint64 (type + 1);
+    }
+
+    ViolationRecord* findRecord (uint64 key)
+    {
+        const int start = int ((key ^ (key >> 29)) % MAX_RECORDS);
+
+        for (int probe = 0; probe < MAX_RECORDS; probe++)
+        {
+            ViolationRecord& record = records[(start + probe) % MAX_RECORDS];
+
+            uint64 existing = record.key.load (std::memory_order_acquire);
+
+            if (existing == 0 && record.key.compare_exchange_strong (existing, key))
+                return &record;
+
+            if (existing == key)
+                return &record;
+        }
+
+        return nullptr;
+    }
+
+    void recordViolation (RealtimeSafetyChecker::ViolationType type)
+    {
+        isInsideHook = true;
+
+        ViolationRecord* record = findRecord (makeKey (scopeNodeId, scopeStreamId, type));
+
+        if (record == nullptr)
+        {
+            numDroppedViolations.fetch_add (1, std::memory_order_relaxed);
+        }
+        else
+        {
+            record->count.fetch_add (1, std::memory_order_relaxed);
+
+#if OE_REALTIME_SAFETY_HOOKS
+            if (record->numBacktraces.load (std::memory_order_relaxed) < RealtimeSafetyChecker::MAX_BACKTRACES)
+            {
+                const int slot = record->numBacktraces.fetch_add (1);
+
+                if (slot < RealtimeSafetyChecker::MAX_BACKTRACES)
+                {
+                    record->numFrames[slot] = backtrace (record->frames[slot], RealtimeSafetyChecker::MAX_FRAMES);
+                    record->backtraceReady[slot].store (true, std::memory_order_release);
+                }
+            }
+#endif
+        }
+
+        isInsideHook = false;
+    }
+
+    inline bool shouldRecordViolation()
+    {
+        return scopeNodeId >= 0 && ! isInsideHook;
+    }
+
+    String symbolizeBacktrace (void* const* frames, int numFrames)
+    {
+        StringArray lines;
+
+#if OE_REALTIME_SAFETY_HOOKS
+        if (char** symbols = backtrace_symbols (frames, numFrames))
+        {
+            for (int i = NUM_HOOK_FRAMES; i < numFrames; i++)
+            {
+                String line (symbols[i]);
+
+                // demangle "binary(_ZSymbol+0x12) [0x...]"
+                const String mangled = line.fromFirstOccurrenceOf ("(", false, false)
+                                           .upToFirstOccurrenceOf ("+", false, false);
+
+                if (mangled.isNotEmpty())
+                {
+                    int status = 0;
+
+                    if (char* demangled = abi::__cxa_demangle (mangled.toRawUTF8(), nullptr, nullptr, &status))
+                    {
+                        line = line.replace (mangled, demangled);
+                        free (demangled);
+                    }
+                }
+
+                lines.add ("    " + line);
+            }
+
+            free (symbols);
+        }
+#endif
+
+        return lines.joinIntoString ("\n");
+    }
+}
+
+#if OE_REALTIME_SAFETY_HOOKS
+
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+
+    __attribute__ ((visibility ("default"))) void* malloc (size_t size)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        return __libc_malloc (size);
+    }
+
+    __attribute__ ((visibility ("default"))) void* calloc (size_t numElements, size_t elementSize)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        return __libc_calloc (numElements, elementSize);
+    }
+
+    __attribute__ ((visibility ("default"))) void* realloc (void* ptr, size_t size)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        return __libc_realloc (ptr, size);
+    }
+
+    __attribute__ ((visibility ("default"))) void* memalign (size_t alignment, size_t size)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        return __libc_memalign (alignment, size);
+    }
+
+    __attribute__ ((visibility ("default"))) void* aligned_alloc (size_t alignment, size_t size)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        return __libc_memalign (alignment, size);
+    }
+
+    __attribute__ ((visibility ("default"))) int posix_memalign (void** result, size_t alignment, size_t size)
+    {
+        if (shouldRecordViolation())
+            recordViolation (RealtimeSafetyChecker::ALLOCATION);
+
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof (void*) != 0)
+            return EINVAL;
+
+        void* ptr = __libc_memalign (alignment, size);
+
+        if (ptr == nullptr)
+            return ENOMEM;
+
+        *result = ptr;
+        return 0;
+    }
+}
+
+namespace
+{
+    typedef int (*MutexLockFunction) (pthread_mutex_t*);
+
+    /* Resolved on first use; not a function-local static, since its guard may itself lock a mutex */
+    std::atomic<MutexLockFunction> realMutexLock (nullptr);
+
+    MutexLockFunction getRealMutexLock()
+    {
+        MutexLockFunction function = realMutexLock.load (std::memory_order_acquire);
+
+        if (function == nullptr)
+        {
+            function = (MutexLockFunction) dlsym (RTLD_NEXT, "pthread_mutex_lock");
+            realMutexLock.store (function, std::memory_order_release);
+        }
+
+        return function;
+    }
+}
+
+extern "C" __attribute__ ((visibility ("default"))) int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    if (shouldRecordViolation())
+        recordViolation (RealtimeSafetyChecker::MUTEX_LOCK);
+
+    return getRealMutexLock() (mutex);
+}
+
+#endif
+
+void RealtimeSafetyChecker::setEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled && ! isSupported())
+    {
+        LOGC ("Real-time safety checks are not supported on this platform");
+        return;
+    }
+
+#if OE_REALTIME_SAFETY_HOOKS
+    if (shouldBeEnabled)
+    {
+        // the first backtrace() call loads libgcc, which allocates; do it here rather than on the audio thread
+        void* frames[1];
+        backtrace (frames, 1);
+
+        getRealMutexLock();
+    }
+#endif
+
+    checkingEnabled = shouldBeEnabled;
+
+    LOGC ("Real-time safety checks ", shouldBeEnabled ? "enabled" : "disabled");
+}
+
+bool RealtimeSafetyChecker::isEnabled()
+{
+    return checkingEnabled.load (std::memory_order_relaxed);
+}
+
+bool RealtimeSafetyChecker::isSupported()
+{
+    return OE_REALTIME_SAFETY_HOOKS != 0;
+}
+
+void RealtimeSafetyChecker::clear()
+{
+    for (auto& record : records)
+    {
+        record.count = 0;
+
+        for (auto& ready : record.backtraceReady)
+            ready = false;
+
+        record.numBacktraces = 0;
+        record.key = 0;
+    }
+
+    numDroppedViolations = 0;
+}
+
+Array<RealtimeSafetyChecker::Violation> RealtimeSafetyChecker::getViolations()
+{
+    Array<Violation> violations;
+
+    for (auto& record : records)
+    {
+        const uint64 key = record.key.load (std::memory_order_acquire);
+
+        if (key == 0)
+            continue;
+
+        Violation violation;
+        violation.nodeId = int (uint32 (key >> 32));
+        violation.streamId = int ((key >> 8) & 0xffff) == 0xffff ? -1 : int ((key >> 8) & 0xffff);
+        violation.type = ViolationType (int (key & 0xff) - 1);
+        violation.count = record.count.load();
+
+        const int numBacktraces = jmin (record.numBacktraces.load(), int (MAX_BACKTRACES));
+
+        for (int i = 0; i < numBacktraces; i++)
+        {
+            if (record.backtraceReady[i].load (std::memory_order_acquire))
+                violation.backtraces.add (symbolizeBacktrace (record.frames[i], record.numFrames[i]));
+        }
+
+        violations.add (violation);
+    }
+
+    std::sort (violations.begin(), violations.end(), [] (const Violation& a, const Violation& b)
+    {
+        if (a.nodeId != b.nodeId)
+            return a.nodeId < b.nodeId;
+
+        if (a.streamId != b.streamId)
+            return a.streamId < b.streamId;
+
+        return a.type < b.type;
+    });
+
+    if (const int64 numDropped = numDroppedViolations.load())
+        LOGC ("Real-time safety checker: ", numDropped, " violations were not recorded (table full)");
+
+    return violations;
+}
+
+String RealtimeSafetyChecker::getTypeName (ViolationType type)
+{
+    return type == ALLOCATION ? "allocation" : "mutex lock";
+}
+
+RealtimeSafetyScope::RealtimeSafetyScope (int nodeId, int streamId)
+    : isActive (checkingEnabled.load (std::memory_order_relaxed)),
+      previousNodeId (scopeNodeId),
+      previousStreamId (scopeStreamId)
+{
+    if (isActive)
+    {
+        scopeNodeId = nodeId;
+        scopeStreamId = streamId;
+    }
+}
+
+RealtimeSafetyScope::~RealtimeSafetyScope()
+{
+    if (isActive)
+    {
+        scopeNodeId = previousNodeId;
+        scopeStreamId = previousStreamId;
+    }
+}
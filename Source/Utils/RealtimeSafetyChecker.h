@@ -0,0 +1,116 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __REALTIMESAFETYCHECKER_H_A3F0D61B__
+#define __REALTIMESAFETYCHECKER_H_A3F0D61B__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../Processors/PluginManager/OpenEphysPlugin.h"
+
+/**
+    Diagnostic mode that catches heap allocations and mutex locks made while a
+    processor is inside processBlock(), where they can stall the audio thread.
+
+    Each violation is counted per processor, data stream and type, and the first
+    few occurrences of each keep a backtrace, so the offending call can be found
+    without a debugger. The stream is the one whose processStream() call or event
+    handler is running, or -1 for the rest of process().
+
+    Allocations are caught by wrapping malloc, calloc, realloc, memalign,
+    aligned_alloc and posix_memalign (valloc and pvalloc are not wrapped), and
+    locks by wrapping pthread_mutex_lock, which covers CriticalSection,
+    std::mutex and anything built on them. This is only possible on Linux (glibc); on other
+    platforms isSupported() returns false and no violations are recorded.
+
+    Checking is off by default. While it is off, the wrappers cost one
+    thread-local load per call.
+*/
+class PLUGIN_API RealtimeSafetyChecker
+{
+public:
+
+    enum ViolationType
+    {
+        ALLOCATION = 0,
+        MUTEX_LOCK = 1
+    };
+
+    /** Counts and sample backtraces for one processor, stream and violation type */
+    struct Violation
+    {
+        int nodeId;
+        int streamId;
+        ViolationType type;
+        int64 count;
+        StringArray backtraces;
+    };
+
+    /** Starts or stops checking */
+    static void setEnabled (bool shouldBeEnabled);
+
+    /** Returns true if checking is active */
+    static bool isEnabled();
+
+    /** Returns true if allocations and locks can be intercepted on this platform */
+    static bool isSupported();
+
+    /** Discards all recorded violations */
+    static void clear();
+
+    /** Returns all violations recorded since the last clear(), with symbolized backtraces */
+    static Array<Violation> getViolations();
+
+    /** Returns a readable name for a violation type */
+    static String getTypeName (ViolationType type);
+
+    /** Number of backtraces kept for each processor, stream and violation type */
+    static const int MAX_BACKTRACES = 3;
+
+    /** Number of frames kept for each backtrace */
+    static const int MAX_FRAMES = 24;
+};
+
+/**
+    Marks the calling thread as running a processor's real-time code for the
+    lifetime of this object. Scopes can be nested; the innermost one wins.
+*/
+class PLUGIN_API RealtimeSafetyScope
+{
+public:
+
+    /** Enters the scope, if checking is enabled */
+    RealtimeSafetyScope (int nodeId, int streamId = -1);
+
+    /** Restores the previous scope */
+    ~RealtimeSafetyScope();
+
+private:
+
+    bool isActive;
+    int previousNodeId;
+    int previousStreamId;
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeSafetyScope);
+};
+
+#endif  // __REALTIMESAFETYCHECKER_H_A3F0D61B__
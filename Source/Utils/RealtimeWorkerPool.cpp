@@ -0,0 +1,182 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "RealtimeWorkerPool.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC
+ #include <dispatch/dispatch.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+/** Counting semaphore that wakes the workers; posting it never takes a lock */
+class RealtimeWorkerPool::Semaphore
+{
+public:
+#if JUCE_WINDOWS
+    Semaphore() : handle (CreateSemaphore (nullptr, 0, 0x7fffffff, nullptr)) {}
+    ~Semaphore() { CloseHandle (handle); }
+
+    void signal() { ReleaseSemaphore (handle, 1, nullptr); }
+    void wait() { WaitForSingleObject (handle, INFINITE); }
+
+private:
+    HANDLE handle;
+#elif JUCE_MAC
+    Semaphore() : handle (dispatch_semaphore_create (0)) {}
+    ~Semaphore() { dispatch_release (handle); }
+
+    void signal() { dispatch_semaphore_signal (handle); }
+    void wait() { dispatch_semaphore_wait (handle, DISPATCH_TIME_FOREVER); }
+
+private:
+    dispatch_semaphore_t handle;
+#else
+    Semaphore() { sem_init (&handle, 0, 0); }
+    ~Semaphore() { sem_destroy (&handle); }
+
+    void signal() { sem_post (&handle); }
+    void wait() { while (sem_wait (&handle) != 0 && errno == EINTR) {} }
+
+private:
+    sem_t handle;
+#endif
+};
+
+class RealtimeWorkerPool::Worker : public Thread
+{
+public:
+    Worker (const String& name, RealtimeWorkerPool& pool_)
+        : Thread (name), pool (pool_) {}
+
+    void run() override
+    {
+        for (;;)
+        {
+            pool.wakeUp->wait();
+
+            if (threadShouldExit())
+                return;
+
+            while (pool.runNextTask())
+                ;
+        }
+    }
+
+private:
+    RealtimeWorkerPool& pool;
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool (const String& name, int numWorkers)
+    : wakeUp (std::make_unique<Semaphore>())
+{
+    for (int i = 0; i < numWorkers; i++)
+    {
+        Worker* worker = workers.add (new Worker (name + " " + String (i + 1), *this));
+        worker->startThread (Thread::realtimeAudioPriority);
+    }
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (int i = 0; i < workers.size(); i++)
+        wakeUp->signal();
+
+    for (auto* worker : workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+}
+
+void RealtimeWorkerPool::run (Job& job, int numTasks)
+{
+    jassert (numTasks < 0x10000);
+
+    if (workers.isEmpty() || numTasks < 2)
+    {
+        for (int i = 0; i < numTasks; i++)
+            job.runTask (i);
+
+        return;
+    }
+
+    currentJob = &job;
+    unfinishedTasks.store (numTasks, std::memory_order_relaxed);
+
+    const uint64 generation = (claimState.load (std::memory_order_relaxed) >> 32) + 1;
+    claimState.store ((generation << 32) | ((uint64) numTasks << 16), std::memory_order_release);
+
+    for (int i = jmin (workers.size(), numTasks - 1); --i >= 0;)
+        wakeUp->signal();
+
+    while (runNextTask())
+        ;
+
+    // the tasks still running are on workers that are already awake, so this won't spin for long
+    while (unfinishedTasks.load (std::memory_order_acquire) > 0)
+        Thread::yield();
+
+    currentJob = nullptr;
+}
+
+bool RealtimeWorkerPool::tryRun (Job& job, int numTasks)
+{
+    if (busy.exchange (true, std::memory_order_acquire))
+        return false;
+
+    run (job, numTasks);
+
+    busy.store (false, std::memory_order_release);
+    return true;
+}
+
+bool RealtimeWorkerPool::runNextTask()
+{
+    uint64 state = claimState.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const int numTasks = (int) ((state >> 16) & 0xffff);
+        const int index = (int) (state & 0xffff);
+
+        if (index >= numTasks)
+            return false;
+
+        // the generation in the upper bits makes a claim on a finished run fail
+        if (claimState.compare_exchange_weak (state, state + 1, std::memory_order_acquire))
+        {
+            currentJob->runTask (index);
+            unfinishedTasks.fetch_sub (1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+}
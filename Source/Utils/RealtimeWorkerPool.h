@@ -0,0 +1,99 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __REALTIMEWORKERPOOL_H_5C2E8A91__
+#define __REALTIMEWORKERPOOL_H_5C2E8A91__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../Processors/PluginManager/OpenEphysPlugin.h"
+
+#include <atomic>
+
+/**
+    A fork/join pool for splitting work across threads from inside an audio callback.
+
+    The worker threads are created once, in the constructor, and sleep on a semaphore
+    between runs. run() hands out tasks through a single atomic counter, takes part
+    in the work itself and spins until the last task has finished, so it never
+    allocates or takes a lock. Construct and destroy the pool on the message thread.
+*/
+class PLUGIN_API RealtimeWorkerPool
+{
+public:
+
+    /** Work that is split into tasks numbered from 0 */
+    class Job
+    {
+    public:
+        virtual ~Job() {}
+
+        /** Called once for every task index, on the caller or on a worker thread */
+        virtual void runTask (int index) = 0;
+    };
+
+    /** Starts numWorkers threads at real-time audio priority */
+    RealtimeWorkerPool (const String& name, int numWorkers);
+
+    /** Stops the worker threads */
+    ~RealtimeWorkerPool();
+
+    /** Returns the number of worker threads (not counting the thread that calls run()) */
+    int getNumWorkers() const { return workers.size(); }
+
+    /** Runs all tasks of a job and returns once they have finished.
+
+        Tasks are claimed in index order, so a task may wait for a task with a lower
+        index without risking deadlock. Only one thread may call run() at a time,
+        and numTasks must be less than 65536.
+    */
+    void run (Job& job, int numTasks);
+
+    /** Like run(), but returns false without running anything if another thread is
+        already inside run() or tryRun(). Lets several callers share one pool. */
+    bool tryRun (Job& job, int numTasks);
+
+private:
+
+    class Worker;
+    class Semaphore;
+
+    /** Claims and runs one task of the current job; returns false if none are left */
+    bool runNextTask();
+
+    OwnedArray<Worker> workers;
+    std::unique_ptr<Semaphore> wakeUp;
+
+    Job* currentJob = nullptr;
+
+    /** Run generation (upper 32 bits), task count (next 16) and next unclaimed task (lower 16) */
+    std::atomic<uint64> claimState { 0 };
+
+    std::atomic<int> unfinishedTasks { 0 };
+
+    /** Set while a thread is inside tryRun() */
+    std::atomic<bool> busy { false };
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeWorkerPool);
+};
+
+#endif  // __REALTIMEWORKERPOOL_H_5C2E8A91__
@@ -0,0 +1,247 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "TraceRecorder.h"
+#include "Utils.h"
+
+#include <atomic>
+
+namespace
+{
+    /** One recorded span */
+    struct TraceEvent
+    {
+        const char* name;
+        int64 detail;
+        int64 startTicks;
+        int64 endTicks;
+    };
+
+    /** Ring buffer of spans written by a single thread */
+    struct ThreadTraceBuffer
+    {
+        ThreadTraceBuffer() : events (TraceRecorder::EVENTS_PER_THREAD),
+                              writeIndex (0),
+                              firstIndex (0),
+                              inUse (true)
+        {
+        }
+
+        String threadName;
+        HeapBlock<TraceEvent> events;
+
+        /** Index of the next span to be written; only the owning thread increments it */
+        std::atomic<uint64> writeIndex;
+
+        /** Spans before this index have been cleared */
+        std::atomic<uint64> firstIndex;
+
+        /** False once the owning thread has exited, so that another thread can take over the buffer */
+        std::atomic<bool> inUse;
+    };
+
+    std::atomic<bool> tracingEnabled (false);
+
+    CriticalSection& getBufferLock()
+    {
+        static CriticalSection lock;
+        return lock;
+    }
+
+    /** Buffers are never deleted, since a thread may still hold a pointer to its own */
+    OwnedArray<ThreadTraceBuffer>& getBuffers()
+    {
+        static OwnedArray<ThreadTraceBuffer> buffers;
+        return buffers;
+    }
+
+    String getCurrentThreadName()
+    {
+        if (Thread* thread = Thread::getCurrentThread())
+            return thread->getThreadName();
+
+        if (MessageManager::existsAndIsCurrentThread())
+            return "Message thread";
+
+        return "Thread " + String::toHexString ((pointer_sized_int) Thread::getCurrentThreadId());
+    }
+
+    /** Releases a thread's buffer when the thread exits */
+    struct ThreadTraceBufferHandle
+    {
+        ~ThreadTraceBufferHandle()
+        {
+            if (buffer != nullptr)
+                buffer->inUse = false;
+        }
+
+        ThreadTraceBuffer* buffer = nullptr;
+    };
+
+    ThreadTraceBuffer* getBufferForCurrentThread()
+    {
+        static thread_local ThreadTraceBufferHandle handle;
+
+        if (handle.buffer == nullptr)
+        {
+            const ScopedLock lock (getBufferLock());
+
+            for (auto buffer : getBuffers())
+            {
+                if (! buffer->inUse)
+                {
+                    buffer->firstIndex = buffer->writeIndex.load();
+                    buffer->inUse = true;
+                    handle.buffer = buffer;
+                    break;
+                }
+            }
+
+            if (handle.buffer == nullptr)
+                handle.buffer = getBuffers().add (new ThreadTraceBuffer());
+
+            handle.buffer->threadName = getCurrentThreadName();
+        }
+
+        return handle.buffer;
+    }
+}
+
+void TraceRecorder::setEnabled (bool shouldBeEnabled)
+{
+    tracingEnabled = shouldBeEnabled;
+
+    LOGC ("Tracing ", shouldBeEnabled ? "enabled" : "disabled");
+}
+
+bool TraceRecorder::isEnabled()
+{
+    return tracingEnabled.load (std::memory_order_relaxed);
+}
+
+void TraceRecorder::clear()
+{
+    const ScopedLock lock (getBufferLock());
+
+    for (auto buffer : getBuffers())
+        buffer->firstIndex = buffer->writeIndex.load();
+}
+
+void TraceRecorder::recordSpan (const char* name, int64 detail, int64 startTicks, int64 endTicks)
+{
+    ThreadTraceBuffer* buffer = getBufferForCurrentThread();
+
+    const uint64 index = buffer->writeIndex.load (std::memory_order_relaxed);
+
+    TraceEvent& event = buffer->events[index % EVENTS_PER_THREAD];
+    event.name = name;
+    event.detail = detail;
+    event.startTicks = startTicks;
+    event.endTicks = endTicks;
+
+    buffer->writeIndex.store (index + 1, std::memory_order_release);
+}
+
+String TraceRecorder::exportChromeTrace()
+{
+    const ScopedLock lock (getBufferLock());
+
+    const double microsecondsPerTick = 1.0e6 / double (Time::getHighResolutionTicksPerSecond());
+
+    struct ThreadEvents
+    {
+        String threadName;
+        Array<TraceEvent> events;
+    };
+
+    OwnedArray<ThreadEvents> threads;
+    int64 originTicks = std::numeric_limits<int64>::max();
+
+    for (auto buffer : getBuffers())
+    {
+        auto thread = threads.add (new ThreadEvents());
+        thread->threadName = buffer->threadName;
+
+        const uint64 end = buffer->writeIndex.load (std::memory_order_acquire);
+        uint64 start = jmax (buffer->firstIndex.load(), end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0);
+
+        for (uint64 i = start; i < end; i++)
+            thread->events.add (buffer->events[i % EVENTS_PER_THREAD]);
+
+        // drop any spans the owning thread overwrote while they were being copied
+        const uint64 endAfterCopy = buffer->writeIndex.load (std::memory_order_acquire);
+        const uint64 firstIntact = endAfterCopy + 1 > EVENTS_PER_THREAD ? endAfterCopy + 1 - EVENTS_PER_THREAD : 0;
+
+        if (firstIntact > start)
+            thread->events.removeRange (0, int (jmin (firstIntact, end) - start));
+
+        for (auto& event : thread->events)
+            originTicks = jmin (originTicks, event.startTicks);
+    }
+
+    MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool isFirst = true;
+
+    for (int tid = 0; tid < threads.size(); tid++)
+    {
+        auto thread = threads[tid];
+
+        if (thread->events.size() == 0)
+            continue;
+
+        json << (isFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":" << JSON::toString (thread->threadName) << "}}";
+
+        isFirst = false;
+
+        for (auto& event : thread->events)
+        {
+            String name (event.name);
+
+            if (event.detail >= 0)
+                name << " (" << String (event.detail) << ")";
+
+            json << ",\n{\"name\":" << JSON::toString (name)
+                 << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                 << ",\"ts\":" << String (double (event.startTicks - originTicks) * microsecondsPerTick, 3)
+                 << ",\"dur\":" << String (double (event.endTicks - event.startTicks) * microsecondsPerTick, 3)
+                 << "}";
+        }
+    }
+
+    json << "\n]}\n";
+
+    return json.toString();
+}
+
+Result TraceRecorder::writeChromeTrace (const File& file)
+{
+    if (! file.replaceWithText (exportChromeTrace()))
+        return Result::fail ("Could not write trace to " + file.getFullPathName());
+
+    LOGC ("Wrote trace to ", file.getFullPathName());
+
+    return Result::ok();
+}
@@ -0,0 +1,107 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2022 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __TRACERECORDER_H_5C2E91A7__
+#define __TRACERECORDER_H_5C2E91A7__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+#include "../Processors/PluginManager/OpenEphysPlugin.h"
+
+/**
+    Records timed spans from any thread and exports them as Chrome trace-event JSON,
+    which can be opened in chrome://tracing or https://ui.perfetto.dev to see how the
+    audio, record, data and message threads interleave.
+
+    Tracing is off by default, and a TraceSpan then costs a single atomic load. While it
+    is on, each thread writes its spans into its own ring buffer, which holds the most
+    recent EVENTS_PER_THREAD spans; recording a span takes no locks and does not allocate,
+    except for the first span recorded on each thread.
+
+    Span names must be string literals (or otherwise outlive the recorder).
+*/
+class PLUGIN_API TraceRecorder
+{
+public:
+
+    /** Starts or stops recording spans */
+    static void setEnabled (bool shouldBeEnabled);
+
+    /** Returns true if spans are being recorded */
+    static bool isEnabled();
+
+    /** Discards all spans recorded so far */
+    static void clear();
+
+    /** Adds a finished span to the calling thread's buffer. Usually called by TraceSpan.
+        The detail value (e.g. a processor ID) is appended to the name if it is not negative. */
+    static void recordSpan (const char* name, int64 detail, int64 startTicks, int64 endTicks);
+
+    /** Returns all recorded spans as Chrome trace-event JSON */
+    static String exportChromeTrace();
+
+    /** Writes exportChromeTrace() to a file */
+    static Result writeChromeTrace (const File& file);
+
+    /** Number of spans kept for each thread */
+    static const int EVENTS_PER_THREAD = 16384;
+};
+
+/**
+    Records the lifetime of this object as a span, if tracing is enabled
+    when it is created:
+
+        void FileReader::readAndFillBufferCache (...)
+        {
+            TraceSpan span ("FileReader::readAndFillBufferCache");
+            ...
+        }
+*/
+class PLUGIN_API TraceSpan
+{
+public:
+
+    /** Starts the span */
+    explicit TraceSpan (const char* name, int64 detail = -1)
+        : name (name),
+          detail (detail),
+          startTicks (TraceRecorder::isEnabled() ? Time::getHighResolutionTicks() : 0)
+    {
+    }
+
+    /** Ends the span */
+    ~TraceSpan()
+    {
+        if (startTicks != 0)
+            TraceRecorder::recordSpan (name, detail, startTicks, Time::getHighResolutionTicks());
+    }
+
+private:
+
+    const char* name;
+    int64 detail;
+    int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE (TraceSpan);
+};
+
+#endif  // __TRACERECORDER_H_5C2E91A7__